@@ -3,6 +3,9 @@
 
 #include "Dialogue.h"
 #include "DialogueContext.h"
+#include "DialogueStats.h"
+#include "DialoguePlugin.h"
+#include "UObject/UObjectHash.h"
 
 void FDialogueNode::SetContextClass(UDialogue* Outer, TSubclassOf<UDialogueNodeContext> NewClass)
 {
@@ -17,6 +20,13 @@ void FDialogueNode::SetContextClass(UDialogue* Outer, TSubclassOf<UDialogueNodeC
 	}	
 }
 
+void FDialogueNode::SetContextStruct(const UScriptStruct* NewStruct)
+{
+	if (ContextStruct.GetScriptStruct() != NewStruct)
+	{
+		ContextStruct.InitializeAs(NewStruct);
+	}
+}
 
 void FDialogueNode::FixContext()
 {
@@ -26,18 +36,312 @@ void FDialogueNode::FixContext()
 	}
 }
 
+bool FDialogueJump::Resolve(UDialogue*& OutDialogue, int32& OutNodeId) const
+{
+	OutDialogue = nullptr;
+	OutNodeId = INDEX_NONE;
+
+	if (Dialogue.IsNull())
+	{
+		return false;
+	}
+
+	UDialogue* Target = Dialogue.Get();
+	if (!Target)
+	{
+		// Reached before prefetch finished, completes pending async request
+		UE_LOG(LogDialogue, Verbose, TEXT("Jump target %s was not prefetched"), *Dialogue.ToString());
+		Target = Dialogue.LoadSynchronous();
+	}
+
+	const int32 NodeId = Target ? Target->GetEntryId(Entry) : INDEX_NONE;
+	if (NodeId < 0 || !Target->HasNode(NodeId))
+	{
+		UE_LOG(LogDialogue, Warning, TEXT("Jump target %s has no entry %s"), *Dialogue.ToString(), *Entry.ToString());
+		return false;
+	}
+
+	OutDialogue = Target;
+	OutNodeId = NodeId;
+	return true;
+}
+
+/*--------------------------------------------
+ 	FDialogueNodeTable
+ *--------------------------------------------*/
+
+void FDialogueNodeTable::Build(const TMap<int32, FDialogueNode>& NodeMap)
+{
+	Reset();
+
+	// Sorted ids keep cooked output deterministic
+	TArray<int32> NodeIds;
+	NodeMap.GenerateKeyArray(NodeIds);
+	NodeIds.Sort();
+
+	const int32 MaxId = NodeIds.Num() > 0 ? NodeIds.Last() : INDEX_NONE;
+	IdToIndex.Init(INDEX_NONE, MaxId + 1);
+	Nodes.Reserve(NodeIds.Num());
+	Conditions.Reserve(NodeIds.Num());
+	ParticipantSlots.Reserve(NodeIds.Num());
+	ChildOffsets.Reserve(NodeIds.Num() + 1);
+
+	int32 ChildNum = 0;
+	for (int32 NodeId : NodeIds)
+	{
+		if (NodeId < 0)
+		{
+			continue;
+		}
+		const FDialogueNode& Node = NodeMap.FindChecked(NodeId);
+		IdToIndex[NodeId] = Nodes.Add(Node);
+		FDialogueConditionProgram& Condition = Conditions.AddDefaulted_GetRef();
+		Condition.Compile(Node.Condition, Node.ConditionStructs, Node.SharedConditions);
+		for (FName Key : Condition.BlackboardKeys)
+		{
+			BlackboardKeys.AddUnique(Key);
+		}
+		ParticipantSlots.Add(Node.Participant.Name.IsNone() ? INDEX_NONE : ParticipantKeys.AddUnique(Node.Participant.Name));
+		ChildNum += Node.Children.Num();
+
+		// Compiled condition owns the only copy
+		Nodes.Last().ConditionStructs.Empty();
+		Nodes.Last().SharedConditions.Empty();
+	}
+
+	// Same struct context on every node is packed into one allocation
+	const UScriptStruct* ContextStruct = Nodes.Num() > 0 ? Nodes[0].ContextStruct.GetScriptStruct() : nullptr;
+	if (ContextStruct && !Nodes.ContainsByPredicate([ContextStruct](const FDialogueNode& Node) { return Node.ContextStruct.GetScriptStruct() != ContextStruct; }))
+	{
+		ContextStructs.Init(ContextStruct, Nodes.Num());
+		for (int32 Index = 0; Index < Nodes.Num(); Index++)
+		{
+			ContextStructs.CopyFrom(Index, Nodes[Index].ContextStruct);
+			Nodes[Index].ContextStruct.Reset();
+		}
+	}
+
+	for (int32 Index = 0; Index < Nodes.Num(); Index++)
+	{
+		const FDialogueNodeContextStruct* ContextStructPtr = GetContextStruct(Index);
+		if ((Nodes[Index].Context && Nodes[Index].Context->HasExecutorState()) || (ContextStructPtr && ContextStructPtr->HasExecutorState()))
+		{
+			StatefulContextIndices.Add(Index);
+		}
+	}
+
+	ChildIndices.Reserve(ChildNum);
+	for (int32 Index = 0; Index < Nodes.Num(); Index++)
+	{
+		FDialogueNode& Node = Nodes[Index];
+
+		ChildOffsets.Add(ChildIndices.Num());
+		for (int32 ChildId : Node.Children)
+		{
+			const int32 ChildIndex = FindIndex(ChildId);
+			if (ChildIndex != INDEX_NONE)
+			{
+				ChildIndices.Add(ChildIndex);
+			}
+		}
+		Node.Children.Empty();
+	}
+	ChildOffsets.Add(ChildIndices.Num());
+
+	static uint32 NextRevision = 0;
+	Revision = ++NextRevision;
+}
+
+void FDialogueNodeTable::Reset()
+{
+	Nodes.Empty();
+	Conditions.Empty();
+	BlackboardKeys.Empty();
+	ContextStructs.Reset();
+	StatefulContextIndices.Empty();
+	ParticipantKeys.Empty();
+	ParticipantSlots.Empty();
+	ChildOffsets.Empty();
+	ChildIndices.Empty();
+	IdToIndex.Empty();
+}
+
+bool FDialogueNodeTable::CanEnterNode(int32 Index, int32 FromNodeId, UObject* WorldContext, FDialogueConditionCache* Cache) const
+{
+	const FDialogueNode& Node = Nodes[Index];
+	if (Node.Context)
+	{
+		DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_Dialogue_ContextCallback, "ContextCanEnterNode", Node.Context->GetOuter(), Node.NodeID);
+		if (!Node.Context->CanEnterNode(WorldContext, FromNodeId))
+		{
+			return false;
+		}
+	}
+	if (const FDialogueNodeContextStruct* ContextStruct = GetContextStruct(Index))
+	{
+		DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_Dialogue_ContextCallback, "ContextCanEnterNode", nullptr, Node.NodeID);
+		if (!ContextStruct->CanEnterNode(WorldContext, Node.NodeID, FromNodeId))
+		{
+			return false;
+		}
+	}
+	return CheckCondition(Index, WorldContext, Cache);
+}
+
+int32 FDialogueNodeTable::FindFirstAvailableChild(int32 Index, UObject* WorldContext, FDialogueConditionCache* Cache) const
+{
+	// Pure results hold for duration of query, shared conditions are checked once for all children
+	FDialogueConditionCache QueryCache;
+	if (!Cache)
+	{
+		Cache = &QueryCache;
+	}
+
+	const int32 FromNodeId = Nodes[Index].NodeID;
+	for (int32 ChildIndex : GetChildIndices(Index))
+	{
+		if (CanEnterNode(ChildIndex, FromNodeId, WorldContext, Cache))
+		{
+			return ChildIndex;
+		}
+	}
+	return INDEX_NONE;
+}
+
+FDialogueNode FDialogueNodeTable::MakeNode(int32 Index) const
+{
+	FDialogueNode Node = Nodes[Index];
+	GetChildrenIds(Index, Node.Children);
+	if (!ContextStructs.IsEmpty())
+	{
+		ContextStructs.CopyTo(Index, Node.ContextStruct);
+	}
+	Node.ConditionStructs = Conditions[Index].StructLeaves;
+	Node.SharedConditions = Conditions[Index].SharedLeaves;
+	return Node;
+}
+
+void FDialogueNodeTable::GetChildrenIds(int32 Index, TArray<int32>& OutIds) const
+{
+	TArrayView<const int32> Children = GetChildIndices(Index);
+
+	OutIds.Empty(Children.Num());
+	for (int32 ChildIndex : Children)
+	{
+		OutIds.Add(Nodes[ChildIndex].NodeID);
+	}
+}
+
+
+
+FDialogueNodeView FDialogueNodeHandle::GetView() const
+{
+	return Dialogue ? Dialogue->FindNodeView(NodeId) : FDialogueNodeView();
+}
+
+
+
+/*--------------------------------------------
+ 	UDialogue
+ *--------------------------------------------*/
+
 UDialogue::UDialogue()
 {
-	Nodes.Add(0, FDialogueNode());
+	TMap<int32, FDialogueNode> DefaultNodes;
+	DefaultNodes.Add(0, FDialogueNode());
+
+#if WITH_EDITORONLY_DATA
+	Nodes = DefaultNodes;
+#endif // WITH_EDITORONLY_DATA
+
+	NodeTable.Build(DefaultNodes);
 	EntryPoints.Add(NAME_None, 0);
 
 	bUniformContext = true;
+	NodeContextStruct = nullptr;
+}
+
+void UDialogue::Serialize(FArchive& Ar)
+{
+	Super::Serialize(Ar);
+
+	// Node map is stripped from cooked packages, runtime table is stored instead
+	if (Ar.IsFilterEditorOnly())
+	{
+#if WITH_EDITORONLY_DATA
+		if (Ar.IsSaving())
+		{
+			CompileNodes();
+		}
+#endif // WITH_EDITORONLY_DATA
+
+		FDialogueNodeTable::StaticStruct()->SerializeItem(Ar, &NodeTable, nullptr);
+	}
+}
+
+void UDialogue::PostLoad()
+{
+	Super::PostLoad();
+
+#if WITH_EDITORONLY_DATA
+	if (!GetOutermost()->HasAnyPackageFlags(PKG_FilterEditorOnly))
+	{
+		CompileNodes();
+	}
+#endif // WITH_EDITORONLY_DATA
+}
+
+bool UDialogue::CanBeClusterRoot() const
+{
+	// Uncooked dialogue rebuilds node table and subobjects on edit
+	return GetOutermost()->HasAnyPackageFlags(PKG_FilterEditorOnly) && ValidateCluster();
+}
+
+bool UDialogue::ValidateCluster() const
+{
+	TArray<UObject*> ClusterObjects;
+	GetObjectsWithOuter(this, ClusterObjects, true);
+	ClusterObjects.Add(const_cast<UDialogue*>(this));
+
+	// Same references GC would collect, including ones of struct contexts and conditions
+	TArray<UObject*> References;
+	FReferenceFinder ReferenceFinder(References, nullptr, false, true);
+	for (UObject* Object : ClusterObjects)
+	{
+		ReferenceFinder.FindReferences(Object);
+	}
+
+	for (UObject* Reference : References)
+	{
+		if (Reference && !Reference->IsIn(this) && (Reference->HasAnyFlags(RF_Transient) || Reference->GetOutermost() == GetTransientPackage()))
+		{
+			UE_LOG(LogDialogue, Log, TEXT("%s is not clustered: references runtime object %s"), *GetName(), *Reference->GetFullName());
+			return false;
+		}
+	}
+	return true;
 }
 
 #if WITH_EDITOR
 void UDialogue::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
 {
 	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	CompileNodes();
+}
+
+void UDialogue::PostEditUndo()
+{
+	Super::PostEditUndo();
+
+	CompileNodes();
+}
+
+void UDialogue::PostDuplicate(bool bDuplicateForPIE)
+{
+	Super::PostDuplicate(bDuplicateForPIE);
+
+	CompileNodes();
 }
 
 void UDialogue::FixNode(FDialogueNode& Node)
@@ -45,87 +349,171 @@ void UDialogue::FixNode(FDialogueNode& Node)
 	if (bUniformContext)
 	{
 		Node.SetContextClass(this, NodeContextClass);
+		Node.SetContextStruct(NodeContextStruct);
 	}
 }
 #endif //WITH_EDITOR
 
+#if WITH_EDITORONLY_DATA
+void UDialogue::CompileNodes()
+{
+	NodeTable.Build(Nodes);
+	FormatPlans.Empty();
+}
+#endif // WITH_EDITORONLY_DATA
+
 
 bool UDialogue::HasNode(int32 NodeId) const
 {
-	return Nodes.Contains(NodeId);
+	return GetNodeTable().FindIndex(NodeId) != INDEX_NONE;
 }
 
 FDialogueNode UDialogue::GetNode(int32 NodeId) const
 {
-	return Nodes.FindRef(NodeId);
+	const FDialogueNodeTable& Table = GetNodeTable();
+	const int32 Index = Table.FindIndex(NodeId);
+	return Index != INDEX_NONE ? Table.MakeNode(Index) : FDialogueNode();
+}
+
+TSharedRef<FDialogueFormatPlan> UDialogue::FindOrAddFormatPlan(int32 NodeId, const FText& Text) const
+{
+	static const int32 MaxPlansPerNode = 4;
+
+	// Pending compile drops cached plans, must happen before plans are referenced
+	const FDialogueNodeTable& Table = GetNodeTable();
+
+	auto& NodePlans = FormatPlans.FindOrAdd(NodeId);
+	for (int32 Index = 0; Index < NodePlans.Num(); Index++)
+	{
+		if (NodePlans[Index]->IsBuiltFor(Text))
+		{
+			return NodePlans[Index];
+		}
+	}
+
+	if (NodePlans.Num() >= MaxPlansPerNode)
+	{
+		NodePlans.RemoveAt(0, 1, false);
+	}
+	TSharedRef<FDialogueFormatPlan> Plan = MakeShared<FDialogueFormatPlan>(Text);
+	for (FDialogueFormatArgument& Argument : Plan->Arguments)
+	{
+		Argument.ParticipantSlot = Table.FindParticipantSlot(Argument.TargetName);
+	}
+	return NodePlans.Add_GetRef(Plan);
+}
+
+FDialogueNodeHandle UDialogue::GetNodeHandle(int32 NodeId) const
+{
+	return FDialogueNodeHandle(const_cast<UDialogue*>(this), HasNode(NodeId) ? NodeId : INDEX_NONE);
 }
 
 FText UDialogue::GetNodeText(int32 NodeId) const
 {
-	return Nodes.FindRef(NodeId).Text;
+	const FDialogueNode* NodePtr = GetNodeTable().FindNode(NodeId);
+	return NodePtr ? NodePtr->Text : FText::GetEmpty();
 }
 
 UDialogueNodeContext* UDialogue::GetNodeContext(int32 NodeId) const
 {
-	return Nodes.FindRef(NodeId).Context;
+	const FDialogueNode* NodePtr = GetNodeTable().FindNode(NodeId);
+	return NodePtr ? NodePtr->Context : nullptr;
 }
 
 bool UDialogue::IsNodeEmpty(int32 NodeId) const
 {
-	const FDialogueNode* NodePtr = Nodes.Find(NodeId);
+	const FDialogueNode* NodePtr = GetNodeTable().FindNode(NodeId);
 	
 	return (NodePtr == nullptr) || NodePtr->IsEmpty();
 }
 
 bool UDialogue::HasChildren(int32 NodeId) const
 {
-	const FDialogueNode* NodePtr = Nodes.Find(NodeId);
-	return NodePtr && NodePtr->Children.Num() > 0;
+	return GetChildrenNum(NodeId) > 0;
 }
 
 int32 UDialogue::GetChildrenNum(int32 NodeId) const
 {
-	const FDialogueNode* NodePtr = Nodes.Find(NodeId);
-	return NodePtr ? NodePtr->Children.Num() : 0;
+	const FDialogueNodeTable& Table = GetNodeTable();
+	const int32 Index = Table.FindIndex(NodeId);
+	return Index != INDEX_NONE ? Table.GetChildNum(Index) : 0;
 }
 
 FDialogueNode UDialogue::GetChildNode(int32 NodeId, int32 ChildIndex) const
 {
-	const FDialogueNode* NodePtr = Nodes.Find(NodeId);
-	return (NodePtr && NodePtr->Children.IsValidIndex(ChildIndex)) ? GetNode(NodePtr->Children[ChildIndex]) : FDialogueNode();
+	const FDialogueNodeTable& Table = GetNodeTable();
+	const int32 Index = Table.FindIndex(NodeId);
+	if (Index != INDEX_NONE)
+	{
+		TArrayView<const int32> Children = Table.GetChildIndices(Index);
+		if (Children.IsValidIndex(ChildIndex))
+		{
+			return Table.MakeNode(Children[ChildIndex]);
+		}
+	}
+	return FDialogueNode();
 }
 
 int32 UDialogue::GetChildId(int32 NodeId, int32 ChildIndex) const
 {
-	const FDialogueNode* NodePtr = Nodes.Find(NodeId);
-	return (NodePtr && NodePtr->Children.IsValidIndex(ChildIndex)) ? NodePtr->Children[ChildIndex] : INDEX_NONE;
+	const FDialogueNodeTable& Table = GetNodeTable();
+	const int32 Index = Table.FindIndex(NodeId);
+	if (Index != INDEX_NONE)
+	{
+		TArrayView<const int32> Children = Table.GetChildIndices(Index);
+		if (Children.IsValidIndex(ChildIndex))
+		{
+			return Table.Nodes[Children[ChildIndex]].NodeID;
+		}
+	}
+	return INDEX_NONE;
 }
 
 TArray<FDialogueNode> UDialogue::GetChildrenNodes(int32 NodeId) const
 {
+	const FDialogueNodeTable& Table = GetNodeTable();
 	TArray<FDialogueNode> Arr;
 
-	const FDialogueNode* NodePtr = Nodes.Find(NodeId);
-	if (NodePtr)
-	{		
-		Arr.Empty(NodePtr->Children.Num());
-		for (int32 ChildId : NodePtr->Children)
+	const int32 Index = Table.FindIndex(NodeId);
+	if (Index != INDEX_NONE)
+	{
+		TArrayView<const int32> Children = Table.GetChildIndices(Index);
+		Arr.Empty(Children.Num());
+		for (int32 ChildIndex : Children)
 		{
-			Arr.Add(GetNode(ChildId));
+			Arr.Add(Table.MakeNode(ChildIndex));
 		}
 	}
 
 	return Arr;
 }
 
+TArray<FDialogueNodeHandle> UDialogue::GetChildrenHandles(int32 NodeId) const
+{
+	TArray<FDialogueNodeHandle> Arr;
+
+	FDialogueNodeView View = FindNodeView(NodeId);
+	Arr.Empty(View.GetChildrenNum());
+	for (FDialogueNodeView Child : View.GetChildren())
+	{
+		Arr.Emplace(const_cast<UDialogue*>(this), Child.GetNodeId());
+	}
+
+	return Arr;
+}
+
 TArray<int32> UDialogue::GetChildrenIds(int32 NodeId) const
 {
-	const FDialogueNode* NodePtr = Nodes.Find(NodeId);
-	if (NodePtr)
+	const FDialogueNodeTable& Table = GetNodeTable();
+	TArray<int32> Arr;
+
+	const int32 Index = Table.FindIndex(NodeId);
+	if (Index != INDEX_NONE)
 	{
-		return NodePtr->Children;
+		Table.GetChildrenIds(Index, Arr);
 	}
-	return TArray<int32>();
+
+	return Arr;
 }
 
 bool UDialogue::HasEntry(FName EntryName) const
@@ -145,6 +533,11 @@ FDialogueNode UDialogue::GetEntryNode(FName EntryName) const
 	return GetNode(GetEntryId(EntryName));
 }
 
+FDialogueNodeHandle UDialogue::GetEntryHandle(FName EntryName) const
+{
+	return GetNodeHandle(GetEntryId(EntryName));
+}
+
 TArray<FName> UDialogue::GetEntries() const
 {
 	TArray<FName> Arr;
@@ -181,12 +574,16 @@ FDialogueEditorStruct::FDialogueEditorStruct()
 FDialogueEditorStruct::FDialogueEditorStruct(UDialogue* InDialogue, bool bInitializeIdCreation /*= true*/)
 {
 	Dialogue = InDialogue;
+#if WITH_EDITORONLY_DATA
 	if (bInitializeIdCreation)
 	{
 		InitializeIdCreation();
 	}
+#endif // WITH_EDITORONLY_DATA
 }
 
+#if WITH_EDITORONLY_DATA
+
 void FDialogueEditorStruct::InitializeIdCreation()
 {
 	LastID = 0;
@@ -196,7 +593,8 @@ void FDialogueEditorStruct::InitializeIdCreation()
 	{
 		for (const auto& Pair : Dialogue->Nodes)
 		{
-			LastID = FMath::Max(Pair.Key, LastID);
+			// Next id after largest one in use
+			LastID = FMath::Max(Pair.Key + 1, LastID);
 		}
 
 		for (int32 Index = 0; Index < LastID; Index++)
@@ -241,6 +639,7 @@ int32 FDialogueEditorStruct::AddNewNode(FDialogueNode Node)
 	Node.FixContext();
 
 	Dialogue->Nodes.Add(NewID, Node);
+	Dialogue->CompileNodes();
 	return NewID;
 }
 
@@ -254,6 +653,7 @@ void FDialogueEditorStruct::RemoveNode(int32 NodeID)
 		if (RemovedNum > 0)
 		{
 			FreeId.Add(NodeID);
+			Dialogue->CompileNodes();
 		}
 	}
 }
@@ -277,6 +677,7 @@ void FDialogueEditorStruct::SetNode(int32 NodeID, FDialogueNode Node)
 		{
 			Node.FixContext();
 			*NodePtr = Node;
+			Dialogue->CompileNodes();
 		}
 	}
 }
@@ -297,6 +698,7 @@ void FDialogueEditorStruct::ResetDialogue()
 		// Default dialogue nodes must be present
 		Dialogue->Nodes.Add(0, FDialogueNode());
 		Dialogue->EntryPoints.Add(NAME_None, 0);
+		Dialogue->CompileNodes();
 	}
 }
 
@@ -323,7 +725,9 @@ void FDialogueEditorStruct::SetNodes(const TMap<int32, FDialogueNode>& NewNodeMa
 			Participants.Add(NodePair.Value.Participant);
 		}
 		Dialogue->Participants = Participants.Array();
+		Dialogue->CompileNodes();
 
 		bIdCreationInitialized = false;
 	}
 }
+#endif // WITH_EDITORONLY_DATA
@@ -0,0 +1,550 @@
+#include "DialogueBlackboard.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Engine/GameInstance.h"
+
+
+/*--------------------------------------------
+ 	FDialogueFact
+ *--------------------------------------------*/
+
+FDialogueFact FDialogueFact::MakeBool(bool bValue)
+{
+	FDialogueFact Fact;
+	Fact.Type = EDialogueFactType::Bool;
+	Fact.bBoolValue = bValue;
+	return Fact;
+}
+
+FDialogueFact FDialogueFact::MakeInt(int32 Value)
+{
+	FDialogueFact Fact;
+	Fact.Type = EDialogueFactType::Int;
+	Fact.IntValue = Value;
+	return Fact;
+}
+
+FDialogueFact FDialogueFact::MakeFloat(float Value)
+{
+	FDialogueFact Fact;
+	Fact.Type = EDialogueFactType::Float;
+	Fact.FloatValue = Value;
+	return Fact;
+}
+
+FDialogueFact FDialogueFact::MakeName(FName Value)
+{
+	FDialogueFact Fact;
+	Fact.Type = EDialogueFactType::Name;
+	Fact.NameValue = Value;
+	return Fact;
+}
+
+FDialogueFact FDialogueFact::MakeDefault(EDialogueFactType Type)
+{
+	switch (Type)
+	{
+	case EDialogueFactType::Bool:	return MakeBool(false);
+	case EDialogueFactType::Int:	return MakeInt(0);
+	case EDialogueFactType::Float:	return MakeFloat(0.0f);
+	case EDialogueFactType::Name:	return MakeName(NAME_None);
+	default:						return FDialogueFact();
+	}
+}
+
+bool FDialogueFact::GetNumber(double& OutNumber) const
+{
+	switch (Type)
+	{
+	case EDialogueFactType::Int:
+		OutNumber = IntValue;
+		return true;
+	case EDialogueFactType::Float:
+		OutNumber = FloatValue;
+		return true;
+	default:
+		return false;
+	}
+}
+
+FString FDialogueFact::ToString() const
+{
+	switch (Type)
+	{
+	case EDialogueFactType::Bool:	return bBoolValue ? TEXT("true") : TEXT("false");
+	case EDialogueFactType::Int:	return FString::FromInt(IntValue);
+	case EDialogueFactType::Float:	return FString::SanitizeFloat(FloatValue);
+	case EDialogueFactType::Name:	return NameValue.ToString();
+	default:						return TEXT("unset");
+	}
+}
+
+bool FDialogueFact::operator==(const FDialogueFact& Other) const
+{
+	if (Type != Other.Type)
+	{
+		return false;
+	}
+
+	switch (Type)
+	{
+	case EDialogueFactType::Bool:	return bBoolValue == Other.bBoolValue;
+	case EDialogueFactType::Int:	return IntValue == Other.IntValue;
+	case EDialogueFactType::Float:	return FloatValue == Other.FloatValue;
+	case EDialogueFactType::Name:	return NameValue == Other.NameValue;
+	default:						return true;
+	}
+}
+
+
+
+/*--------------------------------------------
+ 	FDialogueBlackboard
+ *--------------------------------------------*/
+
+FDialogueBlackboard::FDialogueBlackboard()
+	: NumSlotsUsed(0)
+	, NumFacts(0)
+	, Serial(0)
+	, NextWatcherSerial(1)
+{
+}
+
+int32 FDialogueBlackboard::GetHomeIndex(FName Key) const
+{
+	// FName hash is index based, mixed so neighbouring names don't cluster in table
+	uint32 Hash = GetTypeHash(Key);
+	Hash ^= Hash >> 16;
+	Hash *= 0x85ebca6b;
+	Hash ^= Hash >> 13;
+	Hash *= 0xc2b2ae35;
+	Hash ^= Hash >> 16;
+	return (int32)(Hash & (uint32)(Slots.Num() - 1));
+}
+
+int32 FDialogueBlackboard::FindSlot(FName Key) const
+{
+	if (Slots.Num() == 0 || Key.IsNone())
+	{
+		return INDEX_NONE;
+	}
+
+	// Table is never more than half full, probe always reaches empty slot
+	const int32 Mask = Slots.Num() - 1;
+	for (int32 Index = GetHomeIndex(Key); ; Index = (Index + 1) & Mask)
+	{
+		const FSlot& Slot = Slots[Index];
+		if (Slot.Key == Key)
+		{
+			return Index;
+		}
+		if (Slot.Key.IsNone())
+		{
+			return INDEX_NONE;
+		}
+	}
+}
+
+int32 FDialogueBlackboard::FindOrAddSlot(FName Key)
+{
+	check(!Key.IsNone());
+
+	if ((NumSlotsUsed + 1) * 2 > Slots.Num())
+	{
+		Grow();
+	}
+
+	const int32 Mask = Slots.Num() - 1;
+	int32 Index = GetHomeIndex(Key);
+	while (!Slots[Index].Key.IsNone())
+	{
+		if (Slots[Index].Key == Key)
+		{
+			return Index;
+		}
+		Index = (Index + 1) & Mask;
+	}
+
+	Slots[Index].Key = Key;
+	NumSlotsUsed++;
+	return Index;
+}
+
+void FDialogueBlackboard::Grow()
+{
+	TArray<FSlot> OldSlots = MoveTemp(Slots);
+	Slots.Reset();
+	Slots.SetNum(FMath::Max(16, OldSlots.Num() * 2));
+
+	const int32 Mask = Slots.Num() - 1;
+	for (FSlot& Slot : OldSlots)
+	{
+		if (!Slot.Key.IsNone())
+		{
+			int32 Index = GetHomeIndex(Slot.Key);
+			while (!Slots[Index].Key.IsNone())
+			{
+				Index = (Index + 1) & Mask;
+			}
+			Slots[Index] = MoveTemp(Slot);
+		}
+	}
+}
+
+void FDialogueBlackboard::ReleaseSlotIfUnused(int32 SlotIndex)
+{
+	if (Slots[SlotIndex].Value.IsSet() || Slots[SlotIndex].Watches.Num() > 0)
+	{
+		return;
+	}
+
+	const int32 Mask = Slots.Num() - 1;
+	int32 Hole = SlotIndex;
+	for (int32 Next = (Hole + 1) & Mask; !Slots[Next].Key.IsNone(); Next = (Next + 1) & Mask)
+	{
+		// Entry is moved into hole unless its home lies in cyclic range (Hole, Next]
+		const int32 Home = GetHomeIndex(Slots[Next].Key);
+		const bool bHomeInRange = Hole <= Next ? (Home > Hole && Home <= Next) : (Home > Hole || Home <= Next);
+		if (!bHomeInRange)
+		{
+			Slots[Hole] = MoveTemp(Slots[Next]);
+			Hole = Next;
+		}
+	}
+
+	Slots[Hole] = FSlot();
+	NumSlotsUsed--;
+}
+
+const FDialogueFact* FDialogueBlackboard::Find(FName Key) const
+{
+	const int32 Index = FindSlot(Key);
+	return (Index != INDEX_NONE && Slots[Index].Value.IsSet()) ? &Slots[Index].Value : nullptr;
+}
+
+bool FDialogueBlackboard::GetBool(FName Key, bool bDefault) const
+{
+	const FDialogueFact* Fact = Find(Key);
+	return (Fact && Fact->Type == EDialogueFactType::Bool) ? Fact->bBoolValue : bDefault;
+}
+
+int32 FDialogueBlackboard::GetInt(FName Key, int32 Default) const
+{
+	const FDialogueFact* Fact = Find(Key);
+	return (Fact && Fact->Type == EDialogueFactType::Int) ? Fact->IntValue : Default;
+}
+
+float FDialogueBlackboard::GetFloat(FName Key, float Default) const
+{
+	const FDialogueFact* Fact = Find(Key);
+	return (Fact && Fact->Type == EDialogueFactType::Float) ? Fact->FloatValue : Default;
+}
+
+FName FDialogueBlackboard::GetName(FName Key, FName Default) const
+{
+	const FDialogueFact* Fact = Find(Key);
+	return (Fact && Fact->Type == EDialogueFactType::Name) ? Fact->NameValue : Default;
+}
+
+void FDialogueBlackboard::Set(FName Key, const FDialogueFact& Value)
+{
+	if (Key.IsNone())
+	{
+		return;
+	}
+	if (!Value.IsSet())
+	{
+		Remove(Key);
+		return;
+	}
+
+	const int32 Index = FindOrAddSlot(Key);
+	FDialogueFact& Fact = Slots[Index].Value;
+	if (Fact == Value)
+	{
+		return;
+	}
+	if (!Fact.IsSet())
+	{
+		NumFacts++;
+	}
+	Fact = Value;
+	Serial++;
+
+	// Watchers may change blackboard, slot is not accessed after notify begins
+	const FDialogueFact NewValue = Value;
+	const TArray<FDialogueBlackboardWatchHandle, TInlineAllocator<4>> Watches(Slots[Index].Watches);
+	Notify(Key, NewValue, Watches);
+}
+
+bool FDialogueBlackboard::Remove(FName Key)
+{
+	const int32 Index = FindSlot(Key);
+	if (Index == INDEX_NONE || !Slots[Index].Value.IsSet())
+	{
+		return false;
+	}
+
+	Slots[Index].Value = FDialogueFact();
+	NumFacts--;
+	Serial++;
+
+	const TArray<FDialogueBlackboardWatchHandle, TInlineAllocator<4>> Watches(Slots[Index].Watches);
+	ReleaseSlotIfUnused(Index);
+	Notify(Key, FDialogueFact(), Watches);
+	return true;
+}
+
+void FDialogueBlackboard::Reset()
+{
+	TArray<FName> Keys;
+	ForEachFact([&Keys](FName Key, const FDialogueFact&) { Keys.Add(Key); });
+
+	for (FName Key : Keys)
+	{
+		Remove(Key);
+	}
+}
+
+void FDialogueBlackboard::ForEachFact(TFunctionRef<void(FName, const FDialogueFact&)> Func) const
+{
+	for (const FSlot& Slot : Slots)
+	{
+		if (Slot.Value.IsSet())
+		{
+			Func(Slot.Key, Slot.Value);
+		}
+	}
+}
+
+FDialogueBlackboardWatchHandle FDialogueBlackboard::AddWatcher(TArrayView<const FName> Keys, FOnDialogueFactChanged::FDelegate&& Delegate)
+{
+	FWatcher Watcher;
+	Watcher.Serial = NextWatcherSerial++;
+	Watcher.Delegate = MoveTemp(Delegate);
+	for (FName Key : Keys)
+	{
+		if (!Key.IsNone())
+		{
+			Watcher.Keys.AddUnique(Key);
+		}
+	}
+
+	FDialogueBlackboardWatchHandle Handle;
+	Handle.Serial = Watcher.Serial;
+	Handle.Index = Watchers.Add(MoveTemp(Watcher));
+	for (FName Key : Watchers[Handle.Index].Keys)
+	{
+		Slots[FindOrAddSlot(Key)].Watches.Add(Handle);
+	}
+	return Handle;
+}
+
+void FDialogueBlackboard::RemoveWatcher(FDialogueBlackboardWatchHandle Handle)
+{
+	const FWatcher* Watcher = FindWatcher(Handle);
+	if (!Watcher)
+	{
+		return;
+	}
+
+	for (FName Key : Watcher->Keys)
+	{
+		const int32 SlotIndex = FindSlot(Key);
+		if (SlotIndex != INDEX_NONE)
+		{
+			Slots[SlotIndex].Watches.RemoveSingleSwap(Handle);
+			ReleaseSlotIfUnused(SlotIndex);
+		}
+	}
+	Watchers.RemoveAt(Handle.Index);
+}
+
+const FDialogueBlackboard::FWatcher* FDialogueBlackboard::FindWatcher(FDialogueBlackboardWatchHandle Handle) const
+{
+	return (Watchers.IsValidIndex(Handle.Index) && Watchers[Handle.Index].Serial == Handle.Serial) ? &Watchers[Handle.Index] : nullptr;
+}
+
+void FDialogueBlackboard::Notify(FName Key, const FDialogueFact& Value, TArrayView<const FDialogueBlackboardWatchHandle> Watches)
+{
+	for (FDialogueBlackboardWatchHandle Handle : Watches)
+	{
+		// Copy, watcher may remove itself while called. Removed watcher's slot may already hold new one
+		if (const FWatcher* Watcher = FindWatcher(Handle))
+		{
+			FOnDialogueFactChanged::FDelegate Delegate = Watcher->Delegate;
+			Delegate.ExecuteIfBound(Key, Value);
+		}
+	}
+}
+
+
+
+/*--------------------------------------------
+ 	UDialogueBlackboardSubsystem
+ *--------------------------------------------*/
+
+void UDialogueBlackboardSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Blackboard.OnFactChanged.AddUObject(this, &UDialogueBlackboardSubsystem::HandleFactChanged);
+}
+
+void UDialogueBlackboardSubsystem::Deinitialize()
+{
+	Blackboard.OnFactChanged.RemoveAll(this);
+
+	Super::Deinitialize();
+}
+
+UDialogueBlackboardSubsystem* UDialogueBlackboardSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+	UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+	return GameInstance ? GameInstance->GetSubsystem<UDialogueBlackboardSubsystem>() : nullptr;
+}
+
+FDialogueBlackboard* UDialogueBlackboardSubsystem::FindBlackboard(const UObject* WorldContextObject)
+{
+	UDialogueBlackboardSubsystem* Subsystem = Get(WorldContextObject);
+	return Subsystem ? &Subsystem->Blackboard : nullptr;
+}
+
+void UDialogueBlackboardSubsystem::SetBoolFact(FName Key, bool bValue)
+{
+	Blackboard.SetBool(Key, bValue);
+}
+
+void UDialogueBlackboardSubsystem::SetIntFact(FName Key, int32 Value)
+{
+	Blackboard.SetInt(Key, Value);
+}
+
+void UDialogueBlackboardSubsystem::SetFloatFact(FName Key, float Value)
+{
+	Blackboard.SetFloat(Key, Value);
+}
+
+void UDialogueBlackboardSubsystem::SetNameFact(FName Key, FName Value)
+{
+	Blackboard.SetName(Key, Value);
+}
+
+bool UDialogueBlackboardSubsystem::GetBoolFact(FName Key) const
+{
+	return Blackboard.GetBool(Key);
+}
+
+int32 UDialogueBlackboardSubsystem::GetIntFact(FName Key) const
+{
+	return Blackboard.GetInt(Key);
+}
+
+float UDialogueBlackboardSubsystem::GetFloatFact(FName Key) const
+{
+	return Blackboard.GetFloat(Key);
+}
+
+FName UDialogueBlackboardSubsystem::GetNameFact(FName Key) const
+{
+	return Blackboard.GetName(Key);
+}
+
+EDialogueFactType UDialogueBlackboardSubsystem::GetFactType(FName Key) const
+{
+	const FDialogueFact* Fact = Blackboard.Find(Key);
+	return Fact ? Fact->Type : EDialogueFactType::None;
+}
+
+bool UDialogueBlackboardSubsystem::RemoveFact(FName Key)
+{
+	return Blackboard.Remove(Key);
+}
+
+void UDialogueBlackboardSubsystem::ResetFacts()
+{
+	Blackboard.Reset();
+}
+
+void UDialogueBlackboardSubsystem::HandleFactChanged(FName Key, const FDialogueFact& Value)
+{
+	OnFactChanged.Broadcast(Key);
+}
+
+
+
+/*--------------------------------------------
+ 	FDialogueBlackboardCondition
+ *--------------------------------------------*/
+
+FDialogueFact FDialogueBlackboardCondition::GetValue() const
+{
+	switch (Type)
+	{
+	case EDialogueFactType::Bool:	return FDialogueFact::MakeBool(bBoolValue);
+	case EDialogueFactType::Int:	return FDialogueFact::MakeInt(IntValue);
+	case EDialogueFactType::Float:	return FDialogueFact::MakeFloat(FloatValue);
+	case EDialogueFactType::Name:	return FDialogueFact::MakeName(NameValue);
+	default:						return FDialogueFact();
+	}
+}
+
+FString FDialogueBlackboardCondition::GetConditionDescription() const
+{
+	static const TCHAR* CompareText[] = { TEXT("=="), TEXT("!="), TEXT("<"), TEXT("<="), TEXT(">"), TEXT(">="), TEXT("is set"), TEXT("is not set") };
+
+	if (Compare == EDialogueFactCompare::IsSet || Compare == EDialogueFactCompare::IsNotSet)
+	{
+		return FString::Printf(TEXT("%s %s"), *Key.ToString(), CompareText[(uint8)Compare]);
+	}
+	return FString::Printf(TEXT("%s %s %s"), *Key.ToString(), CompareText[(uint8)Compare], *GetValue().ToString());
+}
+
+bool FDialogueBlackboardCondition::IsConditionMet(UObject* WorldContext) const
+{
+	const FDialogueBlackboard* Blackboard = UDialogueBlackboardSubsystem::FindBlackboard(WorldContext);
+	const FDialogueFact* Fact = Blackboard ? Blackboard->Find(Key) : nullptr;
+
+	if (Compare == EDialogueFactCompare::IsSet)
+	{
+		return Fact != nullptr;
+	}
+	if (Compare == EDialogueFactCompare::IsNotSet)
+	{
+		return Fact == nullptr;
+	}
+
+	const FDialogueFact Current = Fact ? *Fact : FDialogueFact::MakeDefault(Type);
+	const FDialogueFact Value = GetValue();
+
+	double CurrentNumber, ValueNumber;
+	if (Current.GetNumber(CurrentNumber) && Value.GetNumber(ValueNumber))
+	{
+		switch (Compare)
+		{
+		case EDialogueFactCompare::Equal:			return CurrentNumber == ValueNumber;
+		case EDialogueFactCompare::NotEqual:		return CurrentNumber != ValueNumber;
+		case EDialogueFactCompare::Less:			return CurrentNumber < ValueNumber;
+		case EDialogueFactCompare::LessOrEqual:		return CurrentNumber <= ValueNumber;
+		case EDialogueFactCompare::Greater:			return CurrentNumber > ValueNumber;
+		case EDialogueFactCompare::GreaterOrEqual:	return CurrentNumber >= ValueNumber;
+		default:									return false;
+		}
+	}
+
+	switch (Compare)
+	{
+	case EDialogueFactCompare::Equal:		return Current == Value;
+	case EDialogueFactCompare::NotEqual:	return Current != Value;
+	default:								return false;
+	}
+}
+
+void FDialogueBlackboardCondition::GetBlackboardKeys(TArray<FName>& OutKeys) const
+{
+	if (!Key.IsNone())
+	{
+		OutKeys.AddUnique(Key);
+	}
+}
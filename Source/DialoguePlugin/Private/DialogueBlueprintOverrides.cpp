@@ -0,0 +1,38 @@
+#include "DialogueBlueprintOverrides.h"
+#include "UObject/Class.h"
+
+TMap<TPair<FObjectKey, const FName*>, uint32> FDialogueBlueprintOverrides::Masks;
+
+uint32 FDialogueBlueprintOverrides::GetMask(const UClass* Class, const FName* FunctionNames, int32 FunctionNum)
+{
+	// Native classes never dispatch to blueprint events
+	if (!Class || (Class->HasAnyClassFlags(CLASS_Native) && !Class->HasAnyClassFlags(CLASS_CompiledFromBlueprint)))
+	{
+		return 0;
+	}
+
+	const TPair<FObjectKey, const FName*> ClassKey(FObjectKey(Class), FunctionNames);
+	if (const uint32* MaskPtr = Masks.Find(ClassKey))
+	{
+		return *MaskPtr;
+	}
+
+	uint32 Mask = 0;
+	for (int32 Index = 0; Index < FunctionNum; Index++)
+	{
+		const UFunction* Function = Class->FindFunctionByName(FunctionNames[Index]);
+		const UClass* OwnerClass = Function ? Function->GetOwnerClass() : nullptr;
+		if (OwnerClass && !OwnerClass->HasAnyClassFlags(CLASS_Native))
+		{
+			Mask |= 1u << Index;
+		}
+	}
+
+	Masks.Add(ClassKey, Mask);
+	return Mask;
+}
+
+void FDialogueBlueprintOverrides::Invalidate()
+{
+	Masks.Reset();
+}
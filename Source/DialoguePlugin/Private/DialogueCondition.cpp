@@ -3,19 +3,38 @@
 
 #include "DialogueCondition.h"
 #include "Dialogue.h"
+#include "DialogueConditionLibrary.h"
+#include "DialogueBlueprintOverrides.h"
+#include "DialogueStats.h"
+#include "DialogueStructUtils.h"
 
 bool UDialogueCondition::CheckCondition(UObject* WorldContext)
 {
 	bool Result = IsConditionMet(WorldContext);
 
-	if (GetClass()->HasAnyClassFlags(CLASS_CompiledFromBlueprint) || !GetClass()->HasAnyClassFlags(CLASS_Native))
+	if (Result && HasBlueprintCheck())
 	{
-		Result = Result && BP_IsConditionMet(WorldContext);
+		Result = BP_IsConditionMet(WorldContext);
 	}
 
 	return Result;
 }
 
+bool UDialogueCondition::HasBlueprintCheck() const
+{
+	static const FName EventNames[] =
+	{
+		GET_FUNCTION_NAME_CHECKED(UDialogueCondition, BP_IsConditionMet),
+	};
+
+	return FDialogueBlueprintOverrides::GetMask(GetClass(), EventNames) != 0;
+}
+
+bool UDialogueCondition::CanBeInCluster() const
+{
+	return GetClass()->HasAnyClassFlags(CLASS_Native) && Super::CanBeInCluster();
+}
+
 bool UDialogueCondition::BP_IsConditionMet_Implementation(UObject* WorldContext) const
 {
 	return true;
@@ -62,3 +81,412 @@ bool UDialogueCondition_Equality::IsConditionMet(UObject* WorldContext) const
 	bool bResult = (A && A->CheckCondition(WorldContext)) == (B && B->CheckCondition(WorldContext));	
 	return bCheckEqual ? bResult : !bResult;
 }
+
+
+
+
+/*--------------------------------------------
+ 	Struct conditions
+ *--------------------------------------------*/
+
+FDialogueInstancedCondition::FDialogueInstancedCondition(const FDialogueInstancedCondition& Other)
+	: ScriptStruct(nullptr)
+	, Memory(nullptr)
+{
+	*this = Other;
+}
+
+FDialogueInstancedCondition::FDialogueInstancedCondition(FDialogueInstancedCondition&& Other)
+	: ScriptStruct(Other.ScriptStruct)
+	, Memory(Other.Memory)
+{
+	Other.ScriptStruct = nullptr;
+	Other.Memory = nullptr;
+}
+
+FDialogueInstancedCondition& FDialogueInstancedCondition::operator=(const FDialogueInstancedCondition& Other)
+{
+	if (this != &Other)
+	{
+		InitializeAs(Other.ScriptStruct);
+		if (Memory)
+		{
+			ScriptStruct->CopyScriptStruct(Memory, Other.Memory);
+		}
+	}
+	return *this;
+}
+
+FDialogueInstancedCondition& FDialogueInstancedCondition::operator=(FDialogueInstancedCondition&& Other)
+{
+	if (this != &Other)
+	{
+		Reset();
+		Swap(ScriptStruct, Other.ScriptStruct);
+		Swap(Memory, Other.Memory);
+	}
+	return *this;
+}
+
+FDialogueInstancedCondition::~FDialogueInstancedCondition()
+{
+	Reset();
+}
+
+void FDialogueInstancedCondition::InitializeAs(const UScriptStruct* NewStruct)
+{
+	Reset();
+
+	if (DialogueStructUtils::IsValidStruct(NewStruct, FDialogueConditionStruct::StaticStruct()))
+	{
+		ScriptStruct = NewStruct;
+		Memory = DialogueStructUtils::Allocate(ScriptStruct, 1);
+	}
+}
+
+void FDialogueInstancedCondition::Reset()
+{
+	if (Memory)
+	{
+		DialogueStructUtils::Free(ScriptStruct, Memory, 1);
+	}
+	ScriptStruct = nullptr;
+	Memory = nullptr;
+}
+
+bool FDialogueInstancedCondition::Serialize(FArchive& Ar)
+{
+	const UScriptStruct* SerializedStruct = ScriptStruct;
+	DialogueStructUtils::SerializeStructType(Ar, SerializedStruct, FDialogueConditionStruct::StaticStruct());
+
+	if (Ar.IsLoading())
+	{
+		InitializeAs(SerializedStruct);
+	}
+	DialogueStructUtils::SerializeItems(Ar, ScriptStruct, Memory, 1);
+	return true;
+}
+
+bool FDialogueInstancedCondition::Identical(const FDialogueInstancedCondition* Other, uint32 PortFlags) const
+{
+	if (!Other || ScriptStruct != Other->ScriptStruct)
+	{
+		return false;
+	}
+	return Memory == nullptr || ScriptStruct->CompareScriptStruct(Memory, Other->Memory, PortFlags);
+}
+
+void FDialogueInstancedCondition::AddStructReferencedObjects(FReferenceCollector& Collector) const
+{
+	DialogueStructUtils::AddReferencedObjects(Collector, ScriptStruct, Memory, 1);
+}
+
+bool FDialogueInstancedCondition::ExportTextItem(FString& ValueStr, const FDialogueInstancedCondition& DefaultValue, UObject* Parent, int32 PortFlags, UObject* ExportRootScope) const
+{
+	const uint8* DefaultMemory = DefaultValue.ScriptStruct == ScriptStruct ? DefaultValue.Memory : nullptr;
+	DialogueStructUtils::ExportTextItem(ValueStr, ScriptStruct, Memory, DefaultMemory, Parent, PortFlags, ExportRootScope);
+	return true;
+}
+
+bool FDialogueInstancedCondition::ImportTextItem(const TCHAR*& Buffer, int32 PortFlags, UObject* Parent, FOutputDevice* ErrorText)
+{
+	const UScriptStruct* ImportedStruct = nullptr;
+	if (!DialogueStructUtils::ImportStructType(Buffer, ImportedStruct, FDialogueConditionStruct::StaticStruct(), ErrorText))
+	{
+		return false;
+	}
+
+	InitializeAs(ImportedStruct);
+	return DialogueStructUtils::ImportItem(Buffer, ScriptStruct, Memory, Parent, PortFlags, ErrorText);
+}
+
+
+const FDialogueSharedCondition* FDialogueConditionHandle::Resolve() const
+{
+	return Library ? Library->FindCondition(Name) : nullptr;
+}
+
+
+
+/*--------------------------------------------
+ 	FDialogueConditionProgram
+ *--------------------------------------------*/
+
+void FDialogueConditionProgram::Compile(UDialogueCondition* Root, TArrayView<const FDialogueInstancedCondition> Structs, TArrayView<const FDialogueConditionHandle> Shared)
+{
+	Reset();
+
+	// Each term is joined to previous ones by AND
+	TArray<int32, TInlineAllocator<8>> JumpsToPatch;
+	auto BeginTerm = [this, &JumpsToPatch]()
+	{
+		if (Instructions.Num() > 0)
+		{
+			JumpsToPatch.Add(Instructions.Num());
+			Emit(EDialogueConditionOp::JumpIfFalse);
+		}
+	};
+
+	if (Root)
+	{
+		CompileNode(Root);
+	}
+
+	for (const FDialogueInstancedCondition& Struct : Structs)
+	{
+		if (Struct.IsValid())
+		{
+			BeginTerm();
+			Emit(EDialogueConditionOp::CallStruct, StructLeaves.Add(Struct));
+			Struct.Get()->GetBlackboardKeys(BlackboardKeys);
+		}
+	}
+
+	for (const FDialogueConditionHandle& Handle : Shared)
+	{
+		// Same condition twice in one node is checked once
+		if (Handle.IsSet() && !SharedLeaves.Contains(Handle))
+		{
+			BeginTerm();
+			Emit(EDialogueConditionOp::CallShared, SharedLeaves.Add(Handle));
+
+			// Library program is built on its load
+			Handle.Library->ConditionalPostLoad();
+			if (const FDialogueSharedCondition* SharedCondition = Handle.Resolve())
+			{
+				for (FName Key : SharedCondition->Program.BlackboardKeys)
+				{
+					BlackboardKeys.AddUnique(Key);
+				}
+			}
+		}
+	}
+
+	for (int32 JumpIndex : JumpsToPatch)
+	{
+		Instructions[JumpIndex].Arg = Instructions.Num();
+	}
+}
+
+void FDialogueConditionProgram::Reset()
+{
+	Instructions.Empty();
+	Leaves.Empty();
+	StructLeaves.Empty();
+	SharedLeaves.Empty();
+	BlackboardKeys.Empty();
+}
+
+void FDialogueConditionProgram::Emit(EDialogueConditionOp Op, int32 Arg)
+{
+	FDialogueConditionInstruction& Instruction = Instructions.AddDefaulted_GetRef();
+	Instruction.Op = Op;
+	Instruction.Arg = Arg;
+}
+
+void FDialogueConditionProgram::CompileNode(UDialogueCondition* Condition)
+{
+	if (!Condition)
+	{
+		// Invalid object defaults to false
+		Emit(EDialogueConditionOp::False);
+		return;
+	}
+
+	// Exact class match, subclasses may override IsConditionMet
+	UClass* Class = Condition->GetClass();
+	if (Class == UDialogueCondition_AND::StaticClass())
+	{
+		CompileJunction(CastChecked<UDialogueCondition_AND>(Condition)->Conditions, EDialogueConditionOp::JumpIfFalse, EDialogueConditionOp::True);
+	}
+	else if (Class == UDialogueCondition_OR::StaticClass())
+	{
+		CompileJunction(CastChecked<UDialogueCondition_OR>(Condition)->Conditions, EDialogueConditionOp::JumpIfTrue, EDialogueConditionOp::False);
+	}
+	else if (Class == UDialogueCondition_Equality::StaticClass())
+	{
+		UDialogueCondition_Equality* Equality = CastChecked<UDialogueCondition_Equality>(Condition);
+		CompileNode(Equality->A);
+		Emit(EDialogueConditionOp::Push);
+		CompileNode(Equality->B);
+		Emit(Equality->bCheckEqual ? EDialogueConditionOp::Equal : EDialogueConditionOp::NotEqual);
+	}
+	else
+	{
+		const bool bHasBlueprintCheck = Class->HasAnyClassFlags(CLASS_CompiledFromBlueprint) || !Class->HasAnyClassFlags(CLASS_Native);
+		Emit(bHasBlueprintCheck ? EDialogueConditionOp::CallBlueprint : EDialogueConditionOp::CallNative, Leaves.Add(Condition));
+		Condition->GetBlackboardKeys(BlackboardKeys);
+	}
+}
+
+void FDialogueConditionProgram::CompileJunction(const TArray<UDialogueCondition*>& Conditions, EDialogueConditionOp JumpOp, EDialogueConditionOp EmptyOp)
+{
+	// Invalid nested conditions are skipped
+	TArray<UDialogueCondition*, TInlineAllocator<8>> ValidConditions;
+	for (UDialogueCondition* Condition : Conditions)
+	{
+		if (Condition)
+		{
+			ValidConditions.Add(Condition);
+		}
+	}
+
+	if (ValidConditions.Num() == 0)
+	{
+		Emit(EmptyOp);
+		return;
+	}
+
+	TArray<int32, TInlineAllocator<8>> JumpsToPatch;
+	for (int32 Index = 0; Index < ValidConditions.Num(); Index++)
+	{
+		CompileNode(ValidConditions[Index]);
+		if (Index < ValidConditions.Num() - 1)
+		{
+			JumpsToPatch.Add(Instructions.Num());
+			Emit(JumpOp);
+		}
+	}
+
+	for (int32 JumpIndex : JumpsToPatch)
+	{
+		Instructions[JumpIndex].Arg = Instructions.Num();
+	}
+}
+
+bool FDialogueConditionProgram::CallLeaf(const UDialogueCondition* Leaf, bool bCallBlueprint, UObject* WorldContext, FDialogueConditionCache* Cache)
+{
+	if (!Leaf)
+	{
+		return false;
+	}
+
+	const bool bUseCache = Cache && Leaf->IsPure();
+	if (bUseCache)
+	{
+		if (const bool* CachedResult = Cache->Find(Leaf))
+		{
+			return *CachedResult;
+		}
+	}
+
+	DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_Dialogue_Condition, "Condition", Leaf->GetClass(), INDEX_NONE);
+	const bool bResult = Leaf->IsConditionMet(WorldContext) && (!bCallBlueprint || !Leaf->HasBlueprintCheck() || Leaf->BP_IsConditionMet(WorldContext));
+
+	if (bUseCache)
+	{
+		Cache->Add(Leaf, bResult);
+	}
+	return bResult;
+}
+
+bool FDialogueConditionProgram::CallStruct(const FDialogueInstancedCondition& Leaf, UObject* WorldContext, FDialogueConditionCache* Cache)
+{
+	const FDialogueConditionStruct* Condition = Leaf.Get();
+	if (!Condition)
+	{
+		return false;
+	}
+
+	const bool bUseCache = Cache && Condition->bPure;
+	if (bUseCache)
+	{
+		if (const bool* CachedResult = Cache->Find(Condition))
+		{
+			return *CachedResult;
+		}
+	}
+
+	DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_Dialogue_Condition, "Condition", Leaf.GetScriptStruct(), INDEX_NONE);
+	const bool bResult = Condition->IsConditionMet(WorldContext);
+
+	if (bUseCache)
+	{
+		Cache->Add(Condition, bResult);
+	}
+	return bResult;
+}
+
+bool FDialogueConditionProgram::CallShared(const FDialogueConditionHandle& Leaf, UObject* WorldContext, FDialogueConditionCache* Cache)
+{
+	// Missing condition defaults to false, same as invalid object
+	const FDialogueSharedCondition* Condition = Leaf.Resolve();
+	if (!Condition)
+	{
+		return false;
+	}
+
+	// Library entry is the key, so all nodes referencing it share one result
+	const bool bUseCache = Cache && Condition->bPure;
+	if (bUseCache)
+	{
+		if (const bool* CachedResult = Cache->Find(Condition))
+		{
+			return *CachedResult;
+		}
+	}
+
+	const bool bResult = Condition->Program.Execute(WorldContext, Cache);
+
+	if (bUseCache)
+	{
+		Cache->Add(Condition, bResult);
+	}
+	return bResult;
+}
+
+bool FDialogueConditionProgram::Execute(UObject* WorldContext, FDialogueConditionCache* Cache) const
+{
+	bool bResult = true;
+	TArray<bool, TInlineAllocator<8>> Stack;
+
+	const int32 Num = Instructions.Num();
+	for (int32 Index = 0; Index < Num; Index++)
+	{
+		const FDialogueConditionInstruction& Instruction = Instructions[Index];
+		switch (Instruction.Op)
+		{
+		case EDialogueConditionOp::True:
+			bResult = true;
+			break;
+		case EDialogueConditionOp::False:
+			bResult = false;
+			break;
+		case EDialogueConditionOp::CallNative:
+			bResult = CallLeaf(Leaves[Instruction.Arg], false, WorldContext, Cache);
+			break;
+		case EDialogueConditionOp::CallBlueprint:
+			bResult = CallLeaf(Leaves[Instruction.Arg], true, WorldContext, Cache);
+			break;
+		case EDialogueConditionOp::CallStruct:
+			bResult = CallStruct(StructLeaves[Instruction.Arg], WorldContext, Cache);
+			break;
+		case EDialogueConditionOp::CallShared:
+			bResult = CallShared(SharedLeaves[Instruction.Arg], WorldContext, Cache);
+			break;
+		case EDialogueConditionOp::JumpIfFalse:
+			if (!bResult)
+			{
+				Index = Instruction.Arg - 1;
+			}
+			break;
+		case EDialogueConditionOp::JumpIfTrue:
+			if (bResult)
+			{
+				Index = Instruction.Arg - 1;
+			}
+			break;
+		case EDialogueConditionOp::Push:
+			Stack.Push(bResult);
+			break;
+		case EDialogueConditionOp::Equal:
+			bResult = Stack.Pop(false) == bResult;
+			break;
+		case EDialogueConditionOp::NotEqual:
+			bResult = Stack.Pop(false) != bResult;
+			break;
+		}
+	}
+
+	return bResult;
+}
@@ -0,0 +1,54 @@
+#include "DialogueConditionLibrary.h"
+#include "DialoguePlugin.h"
+
+
+void UDialogueConditionLibrary::PostLoad()
+{
+	Super::PostLoad();
+
+	Compile();
+}
+
+#if WITH_EDITOR
+void UDialogueConditionLibrary::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	Compile();
+}
+#endif //WITH_EDITOR
+
+void UDialogueConditionLibrary::Compile()
+{
+	NameToIndex.Reset();
+
+	for (int32 Index = 0; Index < Conditions.Num(); Index++)
+	{
+		FDialogueSharedCondition& SharedCondition = Conditions[Index];
+		SharedCondition.Program.Compile(SharedCondition.Condition, SharedCondition.ConditionStructs);
+
+		if (SharedCondition.Name.IsNone())
+		{
+			continue;
+		}
+		if (NameToIndex.Contains(SharedCondition.Name))
+		{
+			UE_LOG(LogDialogue, Warning, TEXT("%s: duplicate condition name %s, only first one is used"), *GetName(), *SharedCondition.Name.ToString());
+			continue;
+		}
+		NameToIndex.Add(SharedCondition.Name, Index);
+	}
+}
+
+const FDialogueSharedCondition* UDialogueConditionLibrary::FindCondition(FName Name) const
+{
+	const int32* Index = NameToIndex.Find(Name);
+	return Index ? &Conditions[*Index] : nullptr;
+}
+
+TArray<FName> UDialogueConditionLibrary::GetConditionNames() const
+{
+	TArray<FName> Names;
+	NameToIndex.GenerateKeyArray(Names);
+	return Names;
+}
@@ -3,6 +3,12 @@
 
 #include "DialogueContext.h"
 #include "Dialogue.h"
+#include "DialogueStructUtils.h"
+
+bool UDialogueNodeContext::CanBeInCluster() const
+{
+	return GetClass()->HasAnyClassFlags(CLASS_Native) && Super::CanBeInCluster();
+}
 
 int32 UDialogueNodeContext::GetNodeId() const
 {
@@ -13,3 +19,221 @@ UDialogue* UDialogueNodeContext::GetDialogue() const
 {
 	return Cast<UDialogue>(GetOuter());
 }
+
+
+
+/*--------------------------------------------
+ 	Struct contexts
+ *--------------------------------------------*/
+
+FDialogueInstancedContext::FDialogueInstancedContext(const FDialogueInstancedContext& Other)
+	: ScriptStruct(nullptr)
+	, Memory(nullptr)
+{
+	*this = Other;
+}
+
+FDialogueInstancedContext::FDialogueInstancedContext(FDialogueInstancedContext&& Other)
+	: ScriptStruct(Other.ScriptStruct)
+	, Memory(Other.Memory)
+{
+	Other.ScriptStruct = nullptr;
+	Other.Memory = nullptr;
+}
+
+FDialogueInstancedContext& FDialogueInstancedContext::operator=(const FDialogueInstancedContext& Other)
+{
+	if (this != &Other)
+	{
+		InitializeAs(Other.ScriptStruct);
+		if (Memory)
+		{
+			ScriptStruct->CopyScriptStruct(Memory, Other.Memory);
+		}
+	}
+	return *this;
+}
+
+FDialogueInstancedContext& FDialogueInstancedContext::operator=(FDialogueInstancedContext&& Other)
+{
+	if (this != &Other)
+	{
+		Reset();
+		Swap(ScriptStruct, Other.ScriptStruct);
+		Swap(Memory, Other.Memory);
+	}
+	return *this;
+}
+
+FDialogueInstancedContext::~FDialogueInstancedContext()
+{
+	Reset();
+}
+
+void FDialogueInstancedContext::InitializeAs(const UScriptStruct* NewStruct)
+{
+	Reset();
+
+	if (DialogueStructUtils::IsValidStruct(NewStruct, FDialogueNodeContextStruct::StaticStruct()))
+	{
+		ScriptStruct = NewStruct;
+		Memory = DialogueStructUtils::Allocate(ScriptStruct, 1);
+	}
+}
+
+void FDialogueInstancedContext::Reset()
+{
+	if (Memory)
+	{
+		DialogueStructUtils::Free(ScriptStruct, Memory, 1);
+	}
+	ScriptStruct = nullptr;
+	Memory = nullptr;
+}
+
+bool FDialogueInstancedContext::Serialize(FArchive& Ar)
+{
+	const UScriptStruct* SerializedStruct = ScriptStruct;
+	DialogueStructUtils::SerializeStructType(Ar, SerializedStruct, FDialogueNodeContextStruct::StaticStruct());
+
+	if (Ar.IsLoading())
+	{
+		InitializeAs(SerializedStruct);
+	}
+	DialogueStructUtils::SerializeItems(Ar, ScriptStruct, Memory, 1);
+	return true;
+}
+
+bool FDialogueInstancedContext::Identical(const FDialogueInstancedContext* Other, uint32 PortFlags) const
+{
+	if (!Other || ScriptStruct != Other->ScriptStruct)
+	{
+		return false;
+	}
+	return Memory == nullptr || ScriptStruct->CompareScriptStruct(Memory, Other->Memory, PortFlags);
+}
+
+void FDialogueInstancedContext::AddStructReferencedObjects(FReferenceCollector& Collector) const
+{
+	DialogueStructUtils::AddReferencedObjects(Collector, ScriptStruct, Memory, 1);
+}
+
+bool FDialogueInstancedContext::ExportTextItem(FString& ValueStr, const FDialogueInstancedContext& DefaultValue, UObject* Parent, int32 PortFlags, UObject* ExportRootScope) const
+{
+	const uint8* DefaultMemory = DefaultValue.ScriptStruct == ScriptStruct ? DefaultValue.Memory : nullptr;
+	DialogueStructUtils::ExportTextItem(ValueStr, ScriptStruct, Memory, DefaultMemory, Parent, PortFlags, ExportRootScope);
+	return true;
+}
+
+bool FDialogueInstancedContext::ImportTextItem(const TCHAR*& Buffer, int32 PortFlags, UObject* Parent, FOutputDevice* ErrorText)
+{
+	const UScriptStruct* ImportedStruct = nullptr;
+	if (!DialogueStructUtils::ImportStructType(Buffer, ImportedStruct, FDialogueNodeContextStruct::StaticStruct(), ErrorText))
+	{
+		return false;
+	}
+
+	InitializeAs(ImportedStruct);
+	return DialogueStructUtils::ImportItem(Buffer, ScriptStruct, Memory, Parent, PortFlags, ErrorText);
+}
+
+
+FDialogueContextArray::FDialogueContextArray(const FDialogueContextArray& Other)
+	: ScriptStruct(nullptr)
+	, Memory(nullptr)
+	, Num(0)
+{
+	*this = Other;
+}
+
+FDialogueContextArray& FDialogueContextArray::operator=(const FDialogueContextArray& Other)
+{
+	if (this != &Other)
+	{
+		Init(Other.ScriptStruct, Other.Num);
+		if (Memory)
+		{
+			ScriptStruct->CopyScriptStruct(Memory, Other.Memory, Num);
+		}
+	}
+	return *this;
+}
+
+FDialogueContextArray::~FDialogueContextArray()
+{
+	Reset();
+}
+
+void FDialogueContextArray::Init(const UScriptStruct* NewStruct, int32 NewNum)
+{
+	Reset();
+
+	if (NewNum > 0 && DialogueStructUtils::IsValidStruct(NewStruct, FDialogueNodeContextStruct::StaticStruct()))
+	{
+		ScriptStruct = NewStruct;
+		Num = NewNum;
+		Memory = DialogueStructUtils::Allocate(ScriptStruct, Num);
+	}
+}
+
+void FDialogueContextArray::Reset()
+{
+	if (Memory)
+	{
+		DialogueStructUtils::Free(ScriptStruct, Memory, Num);
+	}
+	ScriptStruct = nullptr;
+	Memory = nullptr;
+	Num = 0;
+}
+
+void FDialogueContextArray::CopyFrom(int32 Index, const FDialogueInstancedContext& Instance)
+{
+	check(Index >= 0 && Index < Num && Instance.GetScriptStruct() == ScriptStruct);
+	ScriptStruct->CopyScriptStruct(Memory + Index * ScriptStruct->GetStructureSize(), Instance.GetMemory());
+}
+
+void FDialogueContextArray::CopyTo(int32 Index, FDialogueInstancedContext& Instance) const
+{
+	check(Index >= 0 && Index < Num);
+	Instance.InitializeAs(ScriptStruct);
+	ScriptStruct->CopyScriptStruct(Instance.GetMutableMemory(), Memory + Index * ScriptStruct->GetStructureSize());
+}
+
+bool FDialogueContextArray::Serialize(FArchive& Ar)
+{
+	const UScriptStruct* SerializedStruct = ScriptStruct;
+	int32 SerializedNum = Num;
+	DialogueStructUtils::SerializeStructType(Ar, SerializedStruct, FDialogueNodeContextStruct::StaticStruct());
+	Ar << SerializedNum;
+
+	if (Ar.IsLoading())
+	{
+		Init(SerializedStruct, SerializedNum);
+	}
+	DialogueStructUtils::SerializeItems(Ar, ScriptStruct, Memory, Num);
+	return true;
+}
+
+bool FDialogueContextArray::Identical(const FDialogueContextArray* Other, uint32 PortFlags) const
+{
+	if (!Other || ScriptStruct != Other->ScriptStruct || Num != Other->Num)
+	{
+		return false;
+	}
+
+	const int32 Stride = ScriptStruct ? ScriptStruct->GetStructureSize() : 0;
+	for (int32 Index = 0; Index < Num; Index++)
+	{
+		if (!ScriptStruct->CompareScriptStruct(Memory + Index * Stride, Other->Memory + Index * Stride, PortFlags))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void FDialogueContextArray::AddStructReferencedObjects(FReferenceCollector& Collector) const
+{
+	DialogueStructUtils::AddReferencedObjects(Collector, ScriptStruct, Memory, Num);
+}
@@ -2,4 +2,21 @@
 
 
 #include "DialogueEvent.h"
+#include "DialogueBlueprintOverrides.h"
 
+
+bool UDialogueEvent::CanBeInCluster() const
+{
+	return GetClass()->HasAnyClassFlags(CLASS_Native) && Super::CanBeInCluster();
+}
+
+bool UDialogueEvent::HasBlueprintEvent(EBlueprintEvent Event) const
+{
+	static const FName EventNames[] =
+	{
+		GET_FUNCTION_NAME_CHECKED(UDialogueEvent, BP_CanExecute),
+		GET_FUNCTION_NAME_CHECKED(UDialogueEvent, BP_ExecuteEvent),
+	};
+
+	return (FDialogueBlueprintOverrides::GetMask(GetClass(), EventNames) & (1u << Event)) != 0;
+}
@@ -8,6 +8,15 @@
 #include "DialogueContext.h"
 #include "DialogueParticipantInterface.h"
 #include "DialogueEvent.h"
+#include "DialogueSubsystem.h"
+#include "DialogueTrace.h"
+#include "DialogueStats.h"
+#include "DialogueBlueprintOverrides.h"
+#include "DialogueRecording.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+#include "Net/UnrealNetwork.h"
+#include "GameFramework/Actor.h"
 
 #if WITH_EDITOR
 #include <Logging/MessageLog.h>
@@ -17,11 +26,26 @@
 
 #define LOCTEXT_NAMESPACE "DialogueExecutor"
 
+#if WITH_EDITOR
+static TAutoConsoleVariable<int32> CVarExecutionLogCapacity(
+	TEXT("dialogue.ExecutionLogCapacity"),
+	4096,
+	TEXT("Maximum number of steps kept in executor debugger log. Applied when log is cleared"),
+	ECVF_Default);
+#endif // WITH_EDITOR
+
 UDialogueExecutorBase::FOnExecutorCreated UDialogueExecutorBase::OnExecutorCreated;
 
 UDialogueExecutorBase::UDialogueExecutorBase()
 {
 	Dialogue = nullptr;
+	bCacheConditions = false;
+	PrefetchDepth = 1;
+	ResolvedParticipantsRevision = 0;
+
+	ReplayConditionIndex = 0;
+	ReplayConditionMismatchNum = 0;
+	ReplayConditionEnd = INDEX_NONE;
 }
 
 class UWorld* UDialogueExecutorBase::GetWorld() const
@@ -29,6 +53,32 @@ class UWorld* UDialogueExecutorBase::GetWorld() const
 	return (bWasCreated && GetOuter()) ? GetOuter()->GetWorld() : nullptr;
 }
 
+void UDialogueExecutorBase::BeginDestroy()
+{
+	if (UDialogueBlackboardSubsystem* Blackboard = WatchedBlackboard.Get())
+	{
+		Blackboard->GetBlackboard().RemoveWatcher(BlackboardWatch);
+	}
+	WatchedBlackboard.Reset();
+	BlackboardWatch.Reset();
+
+	Super::BeginDestroy();
+}
+
+void UDialogueExecutorBase::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(UDialogueExecutorBase, Dialogue);
+}
+
+void UDialogueExecutorBase::OnRep_Dialogue()
+{
+	RefreshParticipantSlots();
+	InvalidateConditionCache();
+	UpdateBlackboardWatch();
+}
+
 
 void UDialogueExecutorBase::Initialize()
 {
@@ -63,6 +113,10 @@ void UDialogueExecutorBase::SetDialogue(UDialogue* NewDialogue)
 	if (NewDialogue != Dialogue)
 	{
 		Dialogue = NewDialogue;
+		RefreshParticipantSlots();
+		ReleasePrefetchedAssets();
+		InvalidateConditionCache();
+		UpdateBlackboardWatch();
 		DIALOGUE_LOG_CLEAR();
 	}		
 }
@@ -81,9 +135,10 @@ UObject* UDialogueExecutorBase::GetNodeParticipant(int32 NodeId) const
 {
 	if (Dialogue)
 	{
-		if (const FDialogueNode* Node = Dialogue->GetNodeMap().Find(NodeId))
+		const int32 NodeIndex = Dialogue->GetNodeTable().FindIndex(NodeId);
+		if (NodeIndex != INDEX_NONE)
 		{
-			return ResolveParticipant(Node->Participant);
+			return ResolveNodeParticipant(NodeIndex);
 		}
 	}
 	return nullptr;
@@ -99,7 +154,25 @@ void UDialogueExecutorBase::SetParticipant(FName Name, UObject* InParticipant, b
 	UObject*& Participant = Participants.FindOrAdd(Name, nullptr);
 	if (Participant == nullptr || bOverrideExisting)
 	{
-		Participant = InParticipant;
+		if (Participant != InParticipant)
+		{
+			Participant = InParticipant;
+
+			if (Dialogue && ResolvedParticipantsRevision == Dialogue->GetNodeTable().Revision)
+			{
+				const int32 Slot = Dialogue->GetNodeTable().FindParticipantSlot(Name);
+				if (ResolvedParticipants.IsValidIndex(Slot))
+				{
+					ResolvedParticipants[Slot] = ResolveParticipant(FDialogueParticipant(Name));
+				}
+			}
+			else
+			{
+				RefreshParticipantSlots();
+			}
+
+			InvalidateConditionCache();
+		}
 	}
 }
 
@@ -122,13 +195,105 @@ void UDialogueExecutorBase::GetParticipantsOfClass(TSubclassOf<UObject> Class, T
 	}
 }
 
+void UDialogueExecutorBase::RefreshParticipantSlots()
+{
+	ResolvedParticipants.Reset();
+	ResolvedParticipantsRevision = 0;
+
+	if (Dialogue)
+	{
+		const FDialogueNodeTable& NodeTable = Dialogue->GetNodeTable();
+
+		ResolvedParticipants.Reserve(NodeTable.ParticipantKeys.Num());
+		for (FName Key : NodeTable.ParticipantKeys)
+		{
+			ResolvedParticipants.Add(ResolveParticipant(FDialogueParticipant(Key)));
+		}
+		ResolvedParticipantsRevision = NodeTable.Revision;
+	}
+}
+
+UObject* UDialogueExecutorBase::ResolveNodeParticipant(int32 NodeIndex) const
+{
+	const FDialogueNodeTable& NodeTable = Dialogue->GetNodeTable();
+
+	const int32 Slot = NodeTable.GetParticipantSlot(NodeIndex);
+	if (HasParticipantSlot(Slot))
+	{
+		return ResolvedParticipants[Slot];
+	}
+
+	return ResolveParticipant(NodeTable.Nodes[NodeIndex].Participant);
+}
+
+bool UDialogueExecutorBase::IsNodeAudioReady(int32 NodeId) const
+{
+	const FDialogueNode* Node = Dialogue ? Dialogue->GetNodeTable().FindNode(NodeId) : nullptr;
+	return Node == nullptr || FDialoguePrefetcher::IsNodeAudioReady(*Node);
+}
+
+void UDialogueExecutorBase::ReleasePrefetchedAssets()
+{
+	Prefetcher.Reset();
+}
+
+void UDialogueExecutorBase::InvalidateConditionCache()
+{
+	ConditionCache.Invalidate();
+}
+
+void UDialogueExecutorBase::UpdateBlackboardWatch()
+{
+	if (UDialogueBlackboardSubsystem* Blackboard = WatchedBlackboard.Get())
+	{
+		Blackboard->GetBlackboard().RemoveWatcher(BlackboardWatch);
+	}
+	WatchedBlackboard.Reset();
+	BlackboardWatch.Reset();
+
+	// World is known only after executor was created
+	const TArray<FName>* Keys = Dialogue ? &Dialogue->GetNodeTable().BlackboardKeys : nullptr;
+	UDialogueBlackboardSubsystem* Blackboard = (Keys && Keys->Num() > 0) ? UDialogueBlackboardSubsystem::Get(this) : nullptr;
+	if (Blackboard)
+	{
+		BlackboardWatch = Blackboard->GetBlackboard().AddWatcher(*Keys, FOnDialogueFactChanged::FDelegate::CreateUObject(this, &UDialogueExecutorBase::HandleBlackboardFactChanged));
+		WatchedBlackboard = Blackboard;
+	}
+}
+
+void UDialogueExecutorBase::HandleBlackboardFactChanged(FName Key, const FDialogueFact& Value)
+{
+	// Cache has no per key index, all memoized results are dropped
+	InvalidateConditionCache();
+
+	OnConditionsChangedNative.Broadcast(*this, Key);
+	OnConditionsChanged.Broadcast(Key);
+}
+
 bool UDialogueExecutorBase::CheckNodeCondition(int32 NodeId)
 {
+	DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_Dialogue_CheckNodeCondition, "CheckNodeCondition", Dialogue, NodeId);
+
 	if (Dialogue)
 	{
-		const FDialogueNode* Node = Dialogue->GetNodeMap().Find(NodeId);
+		const FDialogueNodeTable& NodeTable = Dialogue->GetNodeTable();
+
+		const int32 NodeIndex = NodeTable.FindIndex(NodeId);
+		if (NodeIndex == INDEX_NONE)
+		{
+			return false;
+		}
 
-		bool bCanEnter = Node->Condition == nullptr || Node->Condition->CheckCondition(this);
+		RecordQuery(NodeId, EDialogueRecordedQuery::Node);
+
+		DIALOGUE_TRACE_TIMER(ConditionTimer);
+		bool bCanEnter;
+		if (!ConsumeReplayCondition(NodeId, bCanEnter))
+		{
+			bCanEnter = NodeTable.CheckCondition(NodeIndex, this, bCacheConditions ? &ConditionCache : nullptr);
+		}
+		RecordCondition(NodeId, bCanEnter);
+		DIALOGUE_TRACE_CONDITION(NodeId, bCanEnter, ConditionTimer);
 		DIALOGUE_LOG_ADD(FDialogueExecutionStep(NodeId, bCanEnter ? FDialogueExecutionStep::EntryAllowed : FDialogueExecutionStep::EntryDenied));
 
 		return bCanEnter;
@@ -137,24 +302,95 @@ bool UDialogueExecutorBase::CheckNodeCondition(int32 NodeId)
 	return false;
 }
 
+void UDialogueExecutorBase::SetRecording(TSharedPtr<FDialogueExecutionRecording> InRecording)
+{
+	Recording = InRecording;
+}
+
+void UDialogueExecutorBase::SetReplaySource(TSharedPtr<const FDialogueExecutionRecording> InReplaySource)
+{
+	ReplaySource = InReplaySource;
+	ReplayConditionIndex = 0;
+	ReplayConditionMismatchNum = 0;
+	ReplayConditionEnd = INDEX_NONE;
+}
+
+void UDialogueExecutorBase::SetReplayConditionRange(int32 Begin, int32 End)
+{
+	ReplayConditionIndex = Begin;
+	ReplayConditionEnd = End;
+}
+
+bool UDialogueExecutorBase::ConsumeReplayCondition(int32 NodeId, bool& bOutResult)
+{
+	if (!ReplaySource.IsValid())
+	{
+		return false;
+	}
+
+	const TArray<FDialogueRecordedCondition>& Conditions = ReplaySource->Conditions;
+	const int32 EndIndex = ReplayConditionEnd != INDEX_NONE ? FMath::Min(ReplayConditionEnd, Conditions.Num()) : Conditions.Num();
+	if (ReplayConditionIndex < EndIndex && Conditions[ReplayConditionIndex].NodeId == NodeId)
+	{
+		bOutResult = Conditions[ReplayConditionIndex].bResult;
+		ReplayConditionIndex++;
+		return true;
+	}
+
+	ReplayConditionMismatchNum++;
+	return false;
+}
+
+void UDialogueExecutorBase::RecordCondition(int32 NodeId, bool bResult)
+{
+	if (Recording.IsValid())
+	{
+		Recording->Conditions.Emplace(NodeId, bResult);
+	}
+}
+
+void UDialogueExecutorBase::RecordQuery(int32 NodeId, EDialogueRecordedQuery Type)
+{
+	if (Recording.IsValid())
+	{
+		Recording->Queries.Emplace(NodeId, Type);
+	}
+}
+
 TArray<int32> UDialogueExecutorBase::FindAvailableNextNodes(int32 NodeId, bool bStopOnFirst)
 {
+	DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_Dialogue_FindAvailableNextNodes, "FindAvailableNextNodes", Dialogue, NodeId);
+
 	TArray<int32> AvailableChildren;
 
 	if (Dialogue)
 	{
-		const TMap<int32, FDialogueNode>& NodeMap = Dialogue->GetNodeMap();
+		const FDialogueNodeTable& NodeTable = Dialogue->GetNodeTable();
 
-		TArray<int32> Children = Dialogue->GetChildrenIds(NodeId);		
-		for (int32 ChildId : Children)
+		const int32 NodeIndex = NodeTable.FindIndex(NodeId);
+		if (NodeIndex == INDEX_NONE)
 		{
-			const FDialogueNode* Child = NodeMap.Find(ChildId);
+			return AvailableChildren;
+		}
+
+		RecordQuery(NodeId, bStopOnFirst ? EDialogueRecordedQuery::FirstChild : EDialogueRecordedQuery::AllChildren);
 
-			bool bCanEnterChild = 
-				Child &&
-				(Child->Context == nullptr || Child->Context->CanEnterNode(this, NodeId)) &&
-				(Child->Condition == nullptr || Child->Condition->CheckCondition(this));
+		// Without executor cache pure results are still shared within this query
+		FDialogueConditionCache QueryCache;
+		FDialogueConditionCache* Cache = bCacheConditions ? &ConditionCache : &QueryCache;
+
+		for (int32 ChildIndex : NodeTable.GetChildIndices(NodeIndex))
+		{
+			const int32 ChildId = NodeTable.Nodes[ChildIndex].NodeID;
 
+			DIALOGUE_TRACE_TIMER(ConditionTimer);
+			bool bCanEnterChild;
+			if (!ConsumeReplayCondition(ChildId, bCanEnterChild))
+			{
+				bCanEnterChild = NodeTable.CanEnterNode(ChildIndex, NodeId, this, Cache);
+			}
+			RecordCondition(ChildId, bCanEnterChild);
+			DIALOGUE_TRACE_CONDITION(ChildId, bCanEnterChild, ConditionTimer);
 
 			DIALOGUE_LOG_ADD(FDialogueExecutionStep(ChildId, bCanEnterChild ? FDialogueExecutionStep::EntryAllowed : FDialogueExecutionStep::EntryDenied));
 			if (bCanEnterChild)
@@ -163,7 +399,7 @@ TArray<int32> UDialogueExecutorBase::FindAvailableNextNodes(int32 NodeId, bool b
 
 				if (bStopOnFirst)
 				{
-					break;;
+					break;
 				}
 			}
 		}
@@ -192,6 +428,7 @@ bool UDialogueExecutorBase::MoveToNode(int32 FromNodeId, int32 ToNodeId, int32&
 	}
 	bTransitionInProgress = true;
 
+	DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_Dialogue_MoveToNode, "MoveToNode", Dialogue, ToNodeId);
 	
 	if (Dialogue)
 	{
@@ -223,9 +460,11 @@ bool UDialogueExecutorBase::MoveToNode(int32 FromNodeId, int32 ToNodeId, int32&
 
 void UDialogueExecutorBase::ExecuteNodeEvents(int32 NodeId)
 {
+	DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_Dialogue_ExecuteNodeEvents, "ExecuteNodeEvents", Dialogue, NodeId);
+
 	if (Dialogue)
 	{
-		const FDialogueNode* Node = Dialogue->GetNodeMap().Find(NodeId);
+		const FDialogueNode* Node = Dialogue->GetNodeTable().FindNode(NodeId);
 		if (Node)
 		{
 			for (UDialogueEvent* Event : Node->Events)
@@ -243,110 +482,66 @@ void UDialogueExecutorBase::ExecuteNodeEvents(int32 NodeId)
 
 void UDialogueExecutorBase::FormatText(FText InText, int32 NodeId, FText& OutText)
 {
-	FTextFormat Format(InText);
-
-	TArray<FString> ArgumentNames;
-	Format.GetFormatArgumentNames(ArgumentNames);
-
-	FFormatNamedArguments NamedArguments;
-		
+	DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_Dialogue_FormatText, "FormatText", Dialogue, NodeId);
 
 	const FDialogueNode* Node = nullptr;
 	UObject* Participant = nullptr;
 	UDialogueNodeContext* Context = nullptr;
 	if (Dialogue)
 	{
-		Node = Dialogue->GetNodeMap().Find(NodeId);
-		Participant = Node ? ResolveParticipant(Node->Participant) : nullptr;
+		const int32 NodeIndex = Dialogue->GetNodeTable().FindIndex(NodeId);
+		Node = NodeIndex != INDEX_NONE ? &Dialogue->GetNodeTable().Nodes[NodeIndex] : nullptr;
+		Participant = Node ? ResolveNodeParticipant(NodeIndex) : nullptr;
 		Context = Node ? Node->Context : nullptr;
 	}
 
+	// Shared ref keeps plan alive if formatting functions format other texts
+	TSharedRef<FDialogueFormatPlan> Plan = Dialogue ? Dialogue->FindOrAddFormatPlan(NodeId, InText) : MakeShared<FDialogueFormatPlan>(InText);
 
-	struct FPropertyTypeChecker
-	{
-		enum class EType : uint8
-		{
-			None,
-			FString,
-			FText,
-			FName,
-			Float,
-			Integer
-		};	
-
-		EType Type = EType::None;
-
-		void SetType(FProperty* Property)
-		{
-			FString CPPType = Property->GetCPPType();
-			if (CPPType.Equals(TEXT("FString")))
-			{
-				Type = EType::FString;
-			}
-			else if (CPPType.Equals(TEXT("FText")))
-			{
-				Type = EType::FText;
-			}
-			else if (CPPType.Equals(TEXT("FName")))
-			{
-				Type = EType::FName;
-			}
-			else if (CPPType.Equals(TEXT("float")))
-			{
-				Type = EType::Float;
-			}
-			else if (CPPType.Equals(TEXT("int32")))
-			{
-				Type = EType::Integer;
-			}
-			else
-			{
-				Type = EType::None;
-			}
-		}
-	};	
-	
-
-	for (const FString& ArgumentName : ArgumentNames)
+#if WITH_EDITOR
+	if (!Plan->bErrorsReported)
 	{
-		FString TargetPart;
-		FString FuncNamePart;
-		if (!ArgumentName.Split(TEXT("."), &TargetPart, &FuncNamePart))
+		Plan->bErrorsReported = true;
+		for (const FString& ArgumentName : Plan->InvalidArguments)
 		{
-#if WITH_EDITOR
 			FMessageLog("PIE").Error()
 				->AddToken(FTextToken::Create(LOCTEXT("Executor", "Executor:")))
 				->AddToken(FUObjectToken::Create(this))
 				->AddToken(FTextToken::Create(FText::FormatOrdered(LOCTEXT("FormatError_InvalidArg", " Invalid argument {0}. Argument must be in format {TargetName.FunctionName}"), FText::FromString(ArgumentName))));
-			
-#endif // WITH_EDITOR
-			continue;
 		}
-		FName TargetName = *TargetPart;
+	}
+#endif // WITH_EDITOR
+
+	FFormatNamedArguments NamedArguments;
+	NamedArguments.Reserve(Plan->Arguments.Num());
 
+	for (FDialogueFormatArgument& Argument : Plan->Arguments)
+	{
 		UObject* TargetObject = nullptr;		
 
-		if (TargetName == FName(TEXT("Executor")))
+		switch (Argument.Target)
 		{
+		case EDialogueFormatTarget::Executor:
 			TargetObject = this;
-		}
-		else if (TargetName == FName(TEXT("Dialogue")))
-		{
+			break;
+		case EDialogueFormatTarget::Dialogue:
 			TargetObject = Dialogue;
-		}
-		else if (TargetName == FName(TEXT("Participant")))
-		{
+			break;
+		case EDialogueFormatTarget::Participant:
 			TargetObject = Participant;
-		}
-		else if (TargetName == FName(TEXT("Context")))
-		{	
+			break;
+		case EDialogueFormatTarget::Context:
 			TargetObject = Context;
+			break;
+		case EDialogueFormatTarget::ParticipantKey:
+		default:
+			break;
 		}
 
 		//Fallback to participant in map
 		if (TargetObject == nullptr)
 		{
-			TargetObject = Participants.FindRef(TargetName);
+			TargetObject = HasParticipantSlot(Argument.ParticipantSlot) ? ResolvedParticipants[Argument.ParticipantSlot] : Participants.FindRef(Argument.TargetName);
 		}
 
 		if (!TargetObject)
@@ -355,133 +550,140 @@ void UDialogueExecutorBase::FormatText(FText InText, int32 NodeId, FText& OutTex
 			FMessageLog("PIE").Error()
 				->AddToken(FTextToken::Create(LOCTEXT("Executor", "Executor:")))
 				->AddToken(FUObjectToken::Create(this))
-				->AddToken(FTextToken::Create(FText::FormatOrdered(LOCTEXT("FormatError_NoTarget", " Target '{0}' not found"), FText::FromString(ArgumentName))))
+				->AddToken(FTextToken::Create(FText::FormatOrdered(LOCTEXT("FormatError_NoTarget", " Target '{0}' not found"), FText::FromString(Argument.Name))))
 				->AddToken(FTextToken::Create(LOCTEXT("FormatError_AllowedTargets", "Allowed targets: Executor, Dialogue, Participant, Context and all ParticipantKeys")));
 			
 #endif // WITH_EDITOR
 			continue;
 		}
-			
-		UFunction* Func = TargetObject->FindFunction(FName(*FuncNamePart));
-		if (!Func)
-		{
-#if WITH_EDITOR
-			FMessageLog("PIE").Error()
-				->AddToken(FTextToken::Create(LOCTEXT("Executor", "Executor:")))
-				->AddToken(FUObjectToken::Create(this))
-				->AddToken(FTextToken::Create(FText::FormatOrdered(LOCTEXT("FormatError_NoFunction", " Function '{0}' not found in "), FText::FromString(FuncNamePart))))
-				->AddToken(FUObjectToken::Create(TargetObject));
-#endif // WITH_EDITOR
-			continue;
-		}
-
-		FPropertyTypeChecker ReturnType;
 
-		bool bHasInputArguments = false;		
-		int32 ReturnArguments = 0;
-		for (TFieldIterator<FProperty> It(Func); It; ++It)
+		UClass* TargetClass = TargetObject->GetClass();
+		FDialogueFormatBinding* BindingPtr = Argument.FindBinding(TargetClass);
+		if (BindingPtr == nullptr || (BindingPtr->ReturnType != EDialogueFormatReturn::None && !BindingPtr->Function.IsValid()))
 		{
-			FProperty* Prop = *It;
-			if (Prop->HasAnyPropertyFlags(CPF_Parm) && !Prop->HasAnyPropertyFlags(CPF_OutParm))
+			if (BindingPtr)
 			{
-				bHasInputArguments = true;
-				break;
+				// Function was garbage collected, class was recompiled
+				Argument.Bindings.RemoveAtSwap(BindingPtr - Argument.Bindings.GetData());
 			}
-			else if (Prop->HasAllPropertyFlags(CPF_Parm | CPF_OutParm))
+
+			bool bHasInputArguments = false;
+			int32 ReturnArguments = 0;
+			FDialogueFormatBinding& Binding = Argument.Bindings.Add_GetRef(FDialogueFormatPlan::MakeBinding(TargetClass, Argument.FunctionName, bHasInputArguments, ReturnArguments));
+			BindingPtr = &Binding;
+
+#if WITH_EDITOR
+			UFunction* Func = Binding.Function.Get();
+			if (!Func)
 			{
-				ReturnArguments++;
-				ReturnType.SetType(Prop);
+				FMessageLog("PIE").Error()
+					->AddToken(FTextToken::Create(LOCTEXT("Executor", "Executor:")))
+					->AddToken(FUObjectToken::Create(this))
+					->AddToken(FTextToken::Create(FText::FormatOrdered(LOCTEXT("FormatError_NoFunction", " Function '{0}' not found in "), FText::FromName(Argument.FunctionName))))
+					->AddToken(FUObjectToken::Create(TargetObject));
 			}
-		}		
-		
-		bool bFunctionValid = true;
+			else
+			{
+				if (bHasInputArguments)
+				{
+					FMessageLog("PIE").Error()
+						->AddToken(FTextToken::Create(LOCTEXT("Executor", "Executor:")))
+						->AddToken(FUObjectToken::Create(this))
+						->AddToken(FTextToken::Create(LOCTEXT("FormatError_FuncError", " Function")))
+						->AddToken(FUObjectToken::Create(Func))
+						->AddToken(FTextToken::Create(LOCTEXT("FormatError_HasInput", " must have no input")));	
+				}
 
-		if (bHasInputArguments)
-		{
-			bFunctionValid = false;
-#if WITH_EDITOR
-			FMessageLog("PIE").Error()
-				->AddToken(FTextToken::Create(LOCTEXT("Executor", "Executor:")))
-				->AddToken(FUObjectToken::Create(this))
-				->AddToken(FTextToken::Create(LOCTEXT("FormatError_FuncError", " Function")))
-				->AddToken(FUObjectToken::Create(Func))
-				->AddToken(FTextToken::Create(LOCTEXT("FormatError_HasInput", " must have no input")));	
-#endif // WITH_EDITOR
-		}
-		
-		if (ReturnArguments != 1)
-		{
-			bFunctionValid = false;
-#if WITH_EDITOR
-			FMessageLog("PIE").Error()
-				->AddToken(FTextToken::Create(LOCTEXT("Executor", "Executor:")))
-				->AddToken(FUObjectToken::Create(this))
-				->AddToken(FTextToken::Create(LOCTEXT("FormatError_FuncError", " Function")))
-				->AddToken(FUObjectToken::Create(Func))
-				->AddToken(FTextToken::Create(LOCTEXT("FormatError_NoOutput", " must have one output")));
-#endif // WITH_EDITOR
-		}
+				if (ReturnArguments != 1)
+				{
+					FMessageLog("PIE").Error()
+						->AddToken(FTextToken::Create(LOCTEXT("Executor", "Executor:")))
+						->AddToken(FUObjectToken::Create(this))
+						->AddToken(FTextToken::Create(LOCTEXT("FormatError_FuncError", " Function")))
+						->AddToken(FUObjectToken::Create(Func))
+						->AddToken(FTextToken::Create(LOCTEXT("FormatError_NoOutput", " must have one output")));
+				}
 
-		if (ReturnType.Type == FPropertyTypeChecker::EType::None)
-		{
-			bFunctionValid = false;
-#if WITH_EDITOR
-			FMessageLog("PIE").Error()
-				->AddToken(FTextToken::Create(LOCTEXT("Executor", "Executor:")))
-				->AddToken(FUObjectToken::Create(this))
-				->AddToken(FTextToken::Create(LOCTEXT("FormatError_FuncError", " Function")))
-				->AddToken(FUObjectToken::Create(Func))
-				->AddToken(FTextToken::Create(LOCTEXT("FormatError_WrongOutput", " has unrecognized output.")))
-				->AddToken(FTextToken::Create(LOCTEXT("FormatError_AllowedTypes", "Allowed types: Text, String, Name, Int32, Float")));
+				if (Binding.ReturnType == EDialogueFormatReturn::None)
+				{
+					FMessageLog("PIE").Error()
+						->AddToken(FTextToken::Create(LOCTEXT("Executor", "Executor:")))
+						->AddToken(FUObjectToken::Create(this))
+						->AddToken(FTextToken::Create(LOCTEXT("FormatError_FuncError", " Function")))
+						->AddToken(FUObjectToken::Create(Func))
+						->AddToken(FTextToken::Create(LOCTEXT("FormatError_WrongOutput", " has unrecognized output.")))
+						->AddToken(FTextToken::Create(LOCTEXT("FormatError_AllowedTypes", "Allowed types: Text, String, Name, Int32, Float")));
+				}
+			}
 #endif // WITH_EDITOR
 		}
 
-		if (!bFunctionValid)
+		if (!BindingPtr->IsValid())
 		{
 			continue;
 		}
+
+		// Binding array may grow during ProcessEvent
+		UFunction* Func = BindingPtr->Function.Get();
+		const EDialogueFormatReturn ReturnType = BindingPtr->ReturnType;
 		
-		switch (ReturnType.Type)
+		switch (ReturnType)
 		{
-		case FPropertyTypeChecker::EType::FString:
+		case EDialogueFormatReturn::String:
 		{
 			FString Value;
 			TargetObject->ProcessEvent(Func, &Value);
-			NamedArguments.Add(ArgumentName, FFormatArgumentValue(FText::FromString(Value)));
+			NamedArguments.Add(Argument.Name, FFormatArgumentValue(FText::FromString(Value)));
 		}
 			break;
-		case FPropertyTypeChecker::EType::FText:
+		case EDialogueFormatReturn::Text:
 		{
 			FText Value;
 			TargetObject->ProcessEvent(Func, &Value);
-			NamedArguments.Add(ArgumentName, FFormatArgumentValue(Value));
+			NamedArguments.Add(Argument.Name, FFormatArgumentValue(Value));
 		}
 			break;
-		case FPropertyTypeChecker::EType::FName:
+		case EDialogueFormatReturn::Name:
 		{
 			FName Value;
 			TargetObject->ProcessEvent(Func, &Value);
-			NamedArguments.Add(ArgumentName, FFormatArgumentValue(FText::FromName(Value)));
+			NamedArguments.Add(Argument.Name, FFormatArgumentValue(FText::FromName(Value)));
 		}
 			break;
-		case FPropertyTypeChecker::EType::Float:
+		case EDialogueFormatReturn::Float:
 		{
 			float Value;
 			TargetObject->ProcessEvent(Func, &Value);
-			NamedArguments.Add(ArgumentName, FFormatArgumentValue(Value));
+			NamedArguments.Add(Argument.Name, FFormatArgumentValue(Value));
 		}
 			break;
-		case FPropertyTypeChecker::EType::Integer:
+		case EDialogueFormatReturn::Integer:
 		{
 			int32 Value;
 			TargetObject->ProcessEvent(Func, &Value);
-			NamedArguments.Add(ArgumentName, FFormatArgumentValue(Value));
+			NamedArguments.Add(Argument.Name, FFormatArgumentValue(Value));
 		}
 			break;
+		case EDialogueFormatReturn::None:
+		default:
+			break;
 		} //Switch end
 	}
 
-	OutText = FText::Format(Format, NamedArguments);
+	OutText = FText::Format(Plan->Format, NamedArguments);
+}
+
+bool UDialogueExecutorBase::HasBlueprintEvent(EBlueprintEvent Event) const
+{
+	static const FName EventNames[] =
+	{
+		GET_FUNCTION_NAME_CHECKED(UDialogueExecutorBase, ReceiveOnInit),
+		GET_FUNCTION_NAME_CHECKED(UDialogueExecutorBase, ReceiveOnReset),
+		GET_FUNCTION_NAME_CHECKED(UDialogueExecutorBase, ReceiveOnNodeLeave),
+		GET_FUNCTION_NAME_CHECKED(UDialogueExecutorBase, ReceiveOnNodeEnter),
+	};
+
+	return (FDialogueBlueprintOverrides::GetMask(GetClass(), EventNames) & (1u << Event)) != 0;
 }
 
 void UDialogueExecutorBase::HandleCreated()
@@ -489,13 +691,54 @@ void UDialogueExecutorBase::HandleCreated()
 	if (!bWasCreated)
 	{
 		bWasCreated = true;
+		UpdateBlackboardWatch();
 		OnExecutorCreated.Broadcast(*this);
 	}
 }
 
+void UDialogueExecutorBase::ResetExecutor()
+{
+	if (HasBlueprintEvent(BPEvent_Reset))
+	{
+		ReceiveOnReset();
+	}
+
+	OnNodeEnter.Clear();
+	OnNodeLeave.Clear();
+	OnNodeExecutionBegin.Clear();
+	OnNodeExecutionEnd.Clear();
+	OnDialogueExecutionStarted.Clear();
+	OnDialogueExecutionFinished.Clear();
+
+	OnNodeEnterNative.Clear();
+	OnNodeLeaveNative.Clear();
+	OnNodeExecutionBeginNative.Clear();
+	OnNodeExecutionEndNative.Clear();
+	OnDialogueExecutionStartedNative.Clear();
+	OnDialogueExecutionFinishedNative.Clear();
+	OnConditionsChanged.Clear();
+	OnConditionsChangedNative.Clear();
+
+	Dialogue = nullptr;
+	Participants.Reset();
+	RefreshParticipantSlots();
+	ReleasePrefetchedAssets();
+	InvalidateConditionCache();
+	UpdateBlackboardWatch();
+
+	Recording.Reset();
+	SetReplaySource(nullptr);
+
+	bWasCreated = false;
+	bWasInitialized = false;
+	bTransitionInProgress = false;
+
+	DIALOGUE_LOG_CLEAR();
+}
+
 void UDialogueExecutorBase::HandleInit()
 {	
-	if (GetClass()->HasAnyClassFlags(CLASS_CompiledFromBlueprint) || !GetClass()->HasAnyClassFlags(CLASS_Native))
+	if (HasBlueprintEvent(BPEvent_Init))
 	{
 		ReceiveOnInit();
 	}
@@ -503,24 +746,39 @@ void UDialogueExecutorBase::HandleInit()
 
 void UDialogueExecutorBase::HandleNodeLeave(int32 NodeId)
 {
+	DIALOGUE_TRACE(NodeLeave, NodeId);
+
 	if (Dialogue)
 	{
-		if (const FDialogueNode* Node = Dialogue->GetNodeMap().Find(NodeId))
+		const int32 NodeIndex = Dialogue->GetNodeTable().FindIndex(NodeId);
+		if (NodeIndex != INDEX_NONE)
 		{
-			UObject* Participant = ResolveParticipant(Node->Participant);
+			const FDialogueNode* Node = &Dialogue->GetNodeTable().Nodes[NodeIndex];
+
+			UObject* Participant = ResolveNodeParticipant(NodeIndex);
 			if (Participant)
 			{
+				DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_Dialogue_ParticipantCallback, "ParticipantOnNodeLeft", Dialogue, NodeId);
 				IDialogueParticipantInterface::Execute_OnNodeLeft(Participant, this, Dialogue, NodeId);
 			}
 
 			if (Node->Context)
 			{
+				DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_Dialogue_ContextCallback, "ContextOnNodeLeft", Dialogue, NodeId);
 				Node->Context->OnNodeLeft(this);
 			}
+
+			if (const FDialogueNodeContextStruct* ContextStruct = Dialogue->GetNodeTable().GetContextStruct(NodeIndex))
+			{
+				DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_Dialogue_ContextCallback, "ContextOnNodeLeft", Dialogue, NodeId);
+				ContextStruct->OnNodeLeft(this, NodeId);
+			}
 		}
 	}
 
-	if (GetClass()->HasAnyClassFlags(CLASS_CompiledFromBlueprint) || !GetClass()->HasAnyClassFlags(CLASS_Native))
+	OnNodeLeaveNative.Broadcast(*this, NodeId);
+
+	if (HasBlueprintEvent(BPEvent_NodeLeave))
 	{
 		ReceiveOnNodeLeave(NodeId);
 	}
@@ -530,24 +788,44 @@ void UDialogueExecutorBase::HandleNodeLeave(int32 NodeId)
 
 void UDialogueExecutorBase::HandleNodeEnter(int32 NodeId)
 {		
+	DIALOGUE_TRACE(NodeEnter, NodeId);
+
 	if (Dialogue)
 	{
-		if (const FDialogueNode* Node = Dialogue->GetNodeMap().Find(NodeId))
+		const int32 NodeIndex = Dialogue->GetNodeTable().FindIndex(NodeId);
+		if (NodeIndex != INDEX_NONE)
 		{
-			UObject* Participant = ResolveParticipant(Node->Participant);
+			const FDialogueNode* Node = &Dialogue->GetNodeTable().Nodes[NodeIndex];
+
+			if (PrefetchDepth > 0)
+			{
+				Prefetcher.Update(Dialogue, NodeIndex, PrefetchDepth);
+			}
+
+			UObject* Participant = ResolveNodeParticipant(NodeIndex);
 			if (Participant)
 			{
+				DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_Dialogue_ParticipantCallback, "ParticipantOnNodeEntered", Dialogue, NodeId);
 				IDialogueParticipantInterface::Execute_OnNodeEntered(Participant, this, Dialogue, NodeId);
 			}
 
 			if (Node->Context)
 			{
+				DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_Dialogue_ContextCallback, "ContextOnNodeEntered", Dialogue, NodeId);
 				Node->Context->OnNodeEntered(this);
 			}
+
+			if (const FDialogueNodeContextStruct* ContextStruct = Dialogue->GetNodeTable().GetContextStruct(NodeIndex))
+			{
+				DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_Dialogue_ContextCallback, "ContextOnNodeEntered", Dialogue, NodeId);
+				ContextStruct->OnNodeEntered(this, NodeId);
+			}
 		}
 	}
 
-	if (GetClass()->HasAnyClassFlags(CLASS_CompiledFromBlueprint) || !GetClass()->HasAnyClassFlags(CLASS_Native))
+	OnNodeEnterNative.Broadcast(*this, NodeId);
+
+	if (HasBlueprintEvent(BPEvent_NodeEnter))
 	{
 		ReceiveOnNodeEnter(NodeId);
 	}
@@ -559,7 +837,13 @@ void UDialogueExecutorBase::HandleNodeEnter(int32 NodeId)
 
 void UDialogueExecutorBase::HandleNodeExecutionBegin(int32 NodeId)
 {
+	DIALOGUE_TRACE(NodeExecutionBegin, NodeId);
+	if (Recording.IsValid())
+	{
+		Recording->NodeSequence.Add(NodeId);
+	}
 	DIALOGUE_LOG_ADD(FDialogueExecutionStep(NodeId, FDialogueExecutionStep::Active));
+	OnNodeExecutionBeginNative.Broadcast(*this, NodeId);
 	OnNodeExecutionBegin.Broadcast(NodeId);
 }
 
@@ -570,21 +854,34 @@ void UDialogueExecutorBase::HandleNodeExecutionEnd(int32 NodeId)
 		return;
 	}
 
-	if (const FDialogueNode* Node = Dialogue->GetNodeMap().Find(NodeId))
+	const int32 NodeIndex = Dialogue->GetNodeTable().FindIndex(NodeId);
+	if (NodeIndex != INDEX_NONE)
 	{
-		UObject* Participant = ResolveParticipant(Node->Participant);
+		const FDialogueNode* Node = &Dialogue->GetNodeTable().Nodes[NodeIndex];
+
+		UObject* Participant = ResolveNodeParticipant(NodeIndex);
 		if (Participant)
 		{
+			DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_Dialogue_ParticipantCallback, "ParticipantOnNodeFinished", Dialogue, NodeId);
 			IDialogueParticipantInterface::Execute_OnNodeFinished(Participant, this, Dialogue, NodeId);
 		}
 
 		if (Node->Context)
 		{
+			DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_Dialogue_ContextCallback, "ContextOnNodeFinished", Dialogue, NodeId);
 			Node->Context->OnNodeFinished(this);
 		}
+
+		if (const FDialogueNodeContextStruct* ContextStruct = Dialogue->GetNodeTable().GetContextStruct(NodeIndex))
+		{
+			DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_Dialogue_ContextCallback, "ContextOnNodeFinished", Dialogue, NodeId);
+			ContextStruct->OnNodeFinished(this, NodeId);
+		}
 	}
 
+	DIALOGUE_TRACE(NodeExecutionEnd, NodeId);
 	DIALOGUE_LOG_ADD(FDialogueExecutionStep(NodeId, FDialogueExecutionStep::Finished));
+	OnNodeExecutionEndNative.Broadcast(*this, NodeId);
 	OnNodeExecutionEnd.Broadcast(NodeId);
 }
 
@@ -598,27 +895,69 @@ void UDialogueExecutorBase::HandleNodeExecutionEnd(int32 NodeId)
 UDialogueExecutor::UDialogueExecutor()
 {
 	CurrentNodeId = -1;
-}
+	bAutoRecording = false;
+	bReplicateExecution = false;
 
+	AppliedPathSerial = 0;
+	AppliedPathStep = INDEX_NONE;
+}
 
-void UDialogueExecutor::SetDialogue(UDialogue* NewDialogue)
+bool UDialogueExecutor::HasExecutorBlueprintEvent(EExecutorBlueprintEvent Event) const
 {
-	if (IsExecutionInProgress())
+	static const FName EventNames[] =
 	{
-#if WITH_EDITOR
-		FMessageLog("PIE").Error()
-			->AddToken(FTextToken::Create(LOCTEXT("Blueprint", "Blueprint:")))
-			->AddToken(GetOuter() ? FUObjectToken::Create(GetOuter()->GetClass(), GetOuter()->GetClass()->GetDisplayNameText()) : FUObjectToken::Create(nullptr))
-			->AddToken(FTextToken::Create(LOCTEXT("Executor", " Executor:")))
-			->AddToken(FUObjectToken::Create(this))
-			->AddToken(FTextToken::Create(LOCTEXT("SetDialogueFailed", " Failed to set new dialogue: Execution in progress")));
-#endif // WITH_EDITOR
-		return;
-	}
-	Super::SetDialogue(NewDialogue);
+		GET_FUNCTION_NAME_CHECKED(UDialogueExecutor, ReceiveDialoueExecutionBegin),
+		GET_FUNCTION_NAME_CHECKED(UDialogueExecutor, ReceiveDialoueExecutionEnd),
+		GET_FUNCTION_NAME_CHECKED(UDialogueExecutor, NodeExecutionBegin),
+		GET_FUNCTION_NAME_CHECKED(UDialogueExecutor, NodeExecutionEnd),
+		GET_FUNCTION_NAME_CHECKED(UDialogueExecutor, NodeExecutionRestored),
+	};
+
+	return (FDialogueBlueprintOverrides::GetMask(GetClass(), EventNames) & (1u << Event)) != 0;
 }
- 
-bool UDialogueExecutor::BeginExecution(FName EntryPoint)
+
+bool UDialogueExecutor::IsSupportedForNetworking() const
+{
+	return bReplicateExecution;
+}
+
+void UDialogueExecutor::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(UDialogueExecutor, ReplicatedPath);
+}
+
+bool UDialogueExecutor::HasReplicationAuthority() const
+{
+	if (!bReplicateExecution)
+	{
+		return false;
+	}
+
+	const AActor* OwnerActor = GetTypedOuter<AActor>();
+	return OwnerActor && OwnerActor->GetIsReplicated() && OwnerActor->HasAuthority();
+}
+
+
+void UDialogueExecutor::SetDialogue(UDialogue* NewDialogue)
+{
+	if (IsExecutionInProgress())
+	{
+#if WITH_EDITOR
+		FMessageLog("PIE").Error()
+			->AddToken(FTextToken::Create(LOCTEXT("Blueprint", "Blueprint:")))
+			->AddToken(GetOuter() ? FUObjectToken::Create(GetOuter()->GetClass(), GetOuter()->GetClass()->GetDisplayNameText()) : FUObjectToken::Create(nullptr))
+			->AddToken(FTextToken::Create(LOCTEXT("Executor", " Executor:")))
+			->AddToken(FUObjectToken::Create(this))
+			->AddToken(FTextToken::Create(LOCTEXT("SetDialogueFailed", " Failed to set new dialogue: Execution in progress")));
+#endif // WITH_EDITOR
+		return;
+	}
+	Super::SetDialogue(NewDialogue);
+}
+ 
+bool UDialogueExecutor::BeginExecution(FName EntryPoint)
 {
 	return BeginExecution_Internal(Dialogue ? Dialogue->GetEntryId(EntryPoint) : INDEX_NONE, EntryPoint);
 }
@@ -676,8 +1015,27 @@ bool UDialogueExecutor::BeginExecution_Internal(int32 NodeId, FName EntryPoint)
 	}
 	
 	CurrentNodeId = NodeId;
+	CurrentEntryPoint = EntryPoint;
+	DIALOGUE_TRACE_EXECUTION_BEGIN(CurrentNodeId, EntryPoint);
+
+	if (!Recording.IsValid() && FDialogueExecutionRecording::IsAutoRecordEnabled())
+	{
+		Recording = MakeShared<FDialogueExecutionRecording>();
+		bAutoRecording = true;
+	}
+	if (Recording.IsValid())
+	{
+		Recording->BeginExecution(*this, CurrentNodeId, EntryPoint);
+	}
 
-	if (GetClass()->HasAnyClassFlags(CLASS_CompiledFromBlueprint) || !GetClass()->HasAnyClassFlags(CLASS_Native))
+	if (HasReplicationAuthority())
+	{
+		ReplicatedPath.Begin(Dialogue, EntryPoint, CurrentNodeId);
+	}
+
+	OnDialogueExecutionStartedNative.Broadcast(*this, CurrentNodeId);
+
+	if (HasExecutorBlueprintEvent(BPEvent_ExecutionBegin))
 	{
 		ReceiveDialoueExecutionBegin(CurrentNodeId, EntryPoint);
 	}
@@ -693,10 +1051,66 @@ void UDialogueExecutor::ExecuteCurrentNode()
 	{
 		return;
 	}
+
+	for (int32 JumpNum = 0; JumpNum < FDialogueJump::MaxChainLength && FollowJump(); JumpNum++)
+	{ }
+
+	if (CurrentNodeId < 0)
+	{
+		return;
+	}
 	bNodeExecutionInProgress = true;
 
 	HandleNodeExecutionBegin(CurrentNodeId);
-	NodeExecutionBegin();
+	if (HasExecutorBlueprintEvent(BPEvent_NodeExecutionBegin))
+	{
+		NodeExecutionBegin();
+	}
+	else
+	{
+		NodeExecutionBegin_Implementation();
+	}
+}
+
+bool UDialogueExecutor::FollowJump()
+{
+	const FDialogueNode* Node = Dialogue ? Dialogue->GetNodeTable().FindNode(CurrentNodeId) : nullptr;
+	if (!Node || !Node->Jump.IsSet())
+	{
+		return false;
+	}
+
+	const FDialogueJump Jump = Node->Jump;
+	UDialogue* TargetDialogue = nullptr;
+	int32 TargetNodeId = INDEX_NONE;
+	if (!Jump.Resolve(TargetDialogue, TargetNodeId))
+	{
+		return false;
+	}
+
+	int32 LeftNodeId;
+	MoveToNode(CurrentNodeId, INDEX_NONE, LeftNodeId);
+
+	// Dialogue is switched mid execution, which public SetDialogue forbids
+	Super::SetDialogue(TargetDialogue);
+	CurrentEntryPoint = Jump.Entry;
+
+	// Node ids of following events refer to new dialogue
+	DIALOGUE_TRACE_DIALOGUE_SWITCH(TargetNodeId, CurrentEntryPoint);
+	if (Recording.IsValid())
+	{
+		Recording->SwitchDialogue(TargetDialogue, TargetNodeId, CurrentEntryPoint);
+	}
+
+	MoveToNode(INDEX_NONE, TargetNodeId, CurrentNodeId);
+
+	if (HasReplicationAuthority())
+	{
+		// Path codes are relative to node table, clients restart at entry of new dialogue
+		ReplicatedPath.Begin(Dialogue, CurrentEntryPoint, CurrentNodeId);
+	}
+
+	return CurrentNodeId >= 0;
 }
 
 void UDialogueExecutor::FinishNodeExecution(int32 NextNodeId)
@@ -720,21 +1134,63 @@ void UDialogueExecutor::FinishNodeExecution(int32 NextNodeId)
 		return;
 	}
 
+	if (Recording.IsValid())
+	{
+		Recording->Choices.Add(NextNodeId);
+		Recording->ChoiceConditionNum.Add(Recording->Conditions.Num());
+		Recording->ChoiceQueryNum.Add(Recording->Queries.Num());
+	}
+
 	bNodeExecutionCleanupInProgress = true;
 	
-	NodeExecutionEnd();
+	if (HasExecutorBlueprintEvent(BPEvent_NodeExecutionEnd))
+	{
+		NodeExecutionEnd();
+	}
+	else
+	{
+		NodeExecutionEnd_Implementation();
+	}
 	HandleNodeExecutionEnd(CurrentNodeId);
 	bNodeExecutionCleanupInProgress = false;
 
 	bNodeExecutionInProgress = false;
 
+	const int32 PreviousNodeId = CurrentNodeId;
 	if (MoveToNode(CurrentNodeId, NextNodeId, CurrentNodeId))
 	{
+		if (HasReplicationAuthority())
+		{
+			ReplicatedPath.AddTransition(Dialogue->GetNodeTable(), PreviousNodeId, CurrentNodeId);
+		}
+
 		ExecuteCurrentNode();
 	}
 	else
 	{
-		if (GetClass()->HasAnyClassFlags(CLASS_CompiledFromBlueprint) || !GetClass()->HasAnyClassFlags(CLASS_Native))
+		if (HasReplicationAuthority())
+		{
+			ReplicatedPath.AddEnd(Dialogue->GetNodeTable(), PreviousNodeId);
+		}
+
+		DIALOGUE_TRACE(ExecutionEnd, CurrentNodeId);
+
+		if (bAutoRecording)
+		{
+			const FString RecordingPath = FDialogueExecutionRecording::MakeAutoRecordPath(*this);
+			if (!Recording.IsValid() || !Recording->SaveToFile(RecordingPath))
+			{
+				UE_LOG(LogDialogue, Warning, TEXT("Failed to save dialogue recording %s"), *RecordingPath);
+			}
+			Recording.Reset();
+			bAutoRecording = false;
+		}
+
+		ReleasePrefetchedAssets();
+
+		OnDialogueExecutionFinishedNative.Broadcast(*this, CurrentNodeId);
+
+		if (HasExecutorBlueprintEvent(BPEvent_ExecutionEnd))
 		{
 			ReceiveDialoueExecutionEnd(CurrentNodeId);
 		}
@@ -742,6 +1198,18 @@ void UDialogueExecutor::FinishNodeExecution(int32 NextNodeId)
 	}
 }
 
+void UDialogueExecutor::QueueFinishNodeExecution(int32 NextNodeId)
+{
+	if (UDialogueSubsystem* Subsystem = UDialogueSubsystem::Get(this))
+	{
+		Subsystem->QueueTransition(this, NextNodeId);
+	}
+	else
+	{
+		FinishNodeExecution(NextNodeId);
+	}
+}
+
 void UDialogueExecutor::StopExecution()
 {
 	if (IsExecutionInProgress())
@@ -760,4 +1228,623 @@ int32 UDialogueExecutor::GetCurrentNodeId() const
 	return CurrentNodeId;
 }
 
+FName UDialogueExecutor::GetCurrentEntryPoint() const
+{
+	return CurrentEntryPoint;
+}
+
+void UDialogueExecutor::ResetExecutor()
+{
+	// Listeners are notified about finish before bindings are cleared
+	StopExecution();
+
+	Super::ResetExecutor();
+
+	CurrentNodeId = -1;
+	CurrentEntryPoint = NAME_None;
+	bNodeExecutionInProgress = false;
+	bNodeExecutionCleanupInProgress = false;
+	bAutoRecording = false;
+}
+
+void UDialogueExecutor::SaveState(TArray<uint8>& OutState)
+{
+	OutState.Reset();
+	FMemoryWriter Writer(OutState);
+	SerializeState(Writer);
+}
+
+bool UDialogueExecutor::RestoreState(const TArray<uint8>& State)
+{
+	FMemoryReader Reader(State);
+	return SerializeState(Reader);
+}
+
+bool UDialogueExecutor::SerializeState(FArchive& Ar)
+{
+	enum { StateVersion = 2 };
+
+	// Participant keys and context blocks are bounded so corrupted data can't cause huge allocations
+	const uint32 MaxParticipantKeys = 256;
+	const uint32 MaxContextStates = 4096;
+	const uint32 MaxContextStateSize = 64 * 1024;
+
+	uint8 Version = StateVersion;
+	Ar << Version;
+	if (Ar.IsLoading() && (Version == 0 || Version > StateVersion))
+	{
+		UE_LOG(LogDialogue, Warning, TEXT("%s: unsupported dialogue state version %d"), *GetName(), Version);
+		Ar.SetError();
+		return false;
+	}
+
+	// Version 1 stored path hash and could only restore into same dialogue
+	// Followed jump changes active dialogue, so its path is stored and resolved on restore
+	FString DialoguePath = Dialogue ? Dialogue->GetPathName() : FString();
+	uint32 SavedDialogueHash = 0;
+	if (Version >= 2)
+	{
+		Ar << DialoguePath;
+	}
+	else
+	{
+		Ar << SavedDialogueHash;
+	}
+
+	// Shifted by one so idle executor is stored as 0
+	uint32 PackedNodeId = (uint32)(CurrentNodeId + 1);
+	Ar.SerializeIntPacked(PackedNodeId);
+
+	FName EntryPoint = CurrentEntryPoint;
+	Ar << EntryPoint;
+
+	TArray<FName> ParticipantKeys;
+	if (!Ar.IsLoading())
+	{
+		Participants.GetKeys(ParticipantKeys);
+	}
+	uint32 KeyNum = ParticipantKeys.Num();
+	Ar.SerializeIntPacked(KeyNum);
+	if (KeyNum > MaxParticipantKeys)
+	{
+		Ar.SetError();
+		return false;
+	}
+	ParticipantKeys.SetNum(KeyNum);
+	for (FName& Key : ParticipantKeys)
+	{
+		Ar << Key;
+	}
+
+	TArray<TPair<int32, TArray<uint8>>> ContextStates;
+	if (!Ar.IsLoading() && Dialogue)
+	{
+		const FDialogueNodeTable& NodeTable = Dialogue->GetNodeTable();
+		for (int32 Index : NodeTable.StatefulContextIndices)
+		{
+			// Object and struct context of node share one state entry
+			const FDialogueNode& Node = NodeTable.Nodes[Index];
+			const FDialogueNodeContextStruct* ContextStruct = NodeTable.GetContextStruct(Index);
+			const bool bObjectState = Node.Context && Node.Context->HasExecutorState();
+			const bool bStructState = ContextStruct && ContextStruct->HasExecutorState();
+			if (bObjectState || bStructState)
+			{
+				TArray<uint8> Bytes;
+				FMemoryWriter ContextWriter(Bytes);
+				if (bObjectState)
+				{
+					Node.Context->SerializeExecutorState(this, ContextWriter);
+				}
+				if (bStructState)
+				{
+					ContextStruct->SerializeExecutorState(this, Node.NodeID, ContextWriter);
+				}
+				if (Bytes.Num() > 0)
+				{
+					ContextStates.Emplace(Node.NodeID, MoveTemp(Bytes));
+				}
+			}
+		}
+	}
+	uint32 ContextNum = ContextStates.Num();
+	Ar.SerializeIntPacked(ContextNum);
+	if (Ar.IsLoading())
+	{
+		if (ContextNum > MaxContextStates)
+		{
+			Ar.SetError();
+			return false;
+		}
+		ContextStates.SetNum(ContextNum);
+	}
+	for (TPair<int32, TArray<uint8>>& ContextState : ContextStates)
+	{
+		uint32 PackedContextNodeId = (uint32)ContextState.Key;
+		uint32 Size = ContextState.Value.Num();
+		Ar.SerializeIntPacked(PackedContextNodeId);
+		Ar.SerializeIntPacked(Size);
+		if (Size > MaxContextStateSize)
+		{
+			Ar.SetError();
+			return false;
+		}
+
+		ContextState.Key = (int32)PackedContextNodeId;
+		ContextState.Value.SetNumUninitialized(Size);
+		Ar.Serialize(ContextState.Value.GetData(), Size);
+	}
+
+	if (!Ar.IsLoading() || Ar.IsError())
+	{
+		return !Ar.IsError();
+	}
+
+	// Whole snapshot is read, validate before applying anything
+	const int32 RestoredNodeId = (int32)PackedNodeId - 1;
+
+	if (bNodeExecutionCleanupInProgress || IsExecutionInProgress())
+	{
+		UE_LOG(LogDialogue, Warning, TEXT("%s: can't restore dialogue state, execution in progress"), *GetName());
+		return false;
+	}
+
+	UDialogue* RestoredDialogue = nullptr;
+	if (Version < 2)
+	{
+		RestoredDialogue = (Dialogue && SavedDialogueHash == FCrc::StrCrc32(*Dialogue->GetPathName())) ? Dialogue : nullptr;
+	}
+	else if (Dialogue && Dialogue->GetPathName() == DialoguePath)
+	{
+		RestoredDialogue = Dialogue;
+	}
+	else if (!DialoguePath.IsEmpty())
+	{
+		// Loaded synchronously like jump target
+		RestoredDialogue = Cast<UDialogue>(FSoftObjectPath(DialoguePath).TryLoad());
+	}
+
+	if (!RestoredDialogue)
+	{
+		UE_LOG(LogDialogue, Warning, TEXT("%s: can't restore dialogue state, dialogue %s of snapshot is not available"), *GetName(), *DialoguePath);
+		return false;
+	}
+	if (RestoredNodeId >= 0 && !RestoredDialogue->HasNode(RestoredNodeId))
+	{
+		UE_LOG(LogDialogue, Warning, TEXT("%s: can't restore dialogue state, node %d doesn't exist"), *GetName(), RestoredNodeId);
+		return false;
+	}
+
+	if (RestoredDialogue != Dialogue)
+	{
+		SetDialogue(RestoredDialogue);
+	}
+
+	if (!WasInitialized())
+	{
+		Initialize();
+	}
+
+	for (FName Key : ParticipantKeys)
+	{
+		if (!GetParticipant(Key))
+		{
+			UE_LOG(LogDialogue, Verbose, TEXT("%s: participant %s from restored state is not bound"), *GetName(), *Key.ToString());
+		}
+	}
+
+	InvalidateConditionCache();
+
+	const FDialogueNodeTable& NodeTable = Dialogue->GetNodeTable();
+	for (TPair<int32, TArray<uint8>>& ContextState : ContextStates)
+	{
+		const int32 NodeIndex = NodeTable.FindIndex(ContextState.Key);
+		if (NodeIndex == INDEX_NONE)
+		{
+			continue;
+		}
+
+		const FDialogueNode& Node = NodeTable.Nodes[NodeIndex];
+		const FDialogueNodeContextStruct* ContextStruct = NodeTable.GetContextStruct(NodeIndex);
+		FMemoryReader ContextReader(ContextState.Value);
+		if (Node.Context && Node.Context->HasExecutorState())
+		{
+			Node.Context->SerializeExecutorState(this, ContextReader);
+		}
+		if (ContextStruct && ContextStruct->HasExecutorState())
+		{
+			ContextStruct->SerializeExecutorState(this, Node.NodeID, ContextReader);
+		}
+	}
+
+	ApplyNodeWithoutEvents(RestoredNodeId, EntryPoint);
+
+	if (CurrentNodeId >= 0 && HasReplicationAuthority())
+	{
+		ReplicatedPath.Begin(Dialogue, CurrentEntryPoint, CurrentNodeId);
+	}
+
+	return true;
+}
+
+void UDialogueExecutor::ApplyNodeWithoutEvents(int32 NodeId, FName EntryPoint)
+{
+	if (!WasInitialized())
+	{
+		Initialize();
+	}
+
+	CurrentNodeId = NodeId;
+	CurrentEntryPoint = EntryPoint;
+	bNodeExecutionInProgress = CurrentNodeId >= 0;
+
+	if (bNodeExecutionInProgress)
+	{
+		if (HasExecutorBlueprintEvent(BPEvent_NodeExecutionRestored))
+		{
+			NodeExecutionRestored();
+		}
+		else
+		{
+			NodeExecutionRestored_Implementation();
+		}
+	}
+}
+
+void UDialogueExecutor::OnRep_ReplicatedPath()
+{
+	if (HasReplicationAuthority())
+	{
+		return;
+	}
+
+	// Server may have followed jump, path is decoded against dialogue it was recorded in
+	UDialogue* PathDialogue = ReplicatedPath.Dialogue ? ReplicatedPath.Dialogue : Dialogue;
+	if (!PathDialogue)
+	{
+		return;
+	}
+
+	TArray<int32> PathNodes;
+	bool bFinished = false;
+	if (!ReplicatedPath.Decode(PathDialogue->GetNodeTable(), PathNodes, bFinished))
+	{
+		UE_LOG(LogDialogue, Warning, TEXT("%s: replicated path doesn't match dialogue %s"), *GetName(), *PathDialogue->GetName());
+		return;
+	}
+	if (PathNodes.Num() == 0)
+	{
+		return;
+	}
+
+	if (ReplicatedPath.Serial != AppliedPathSerial && IsExecutionInProgress()
+		&& Dialogue == PathDialogue && CurrentNodeId == PathNodes[0] && CurrentEntryPoint == ReplicatedPath.EntryPoint)
+	{
+		// Client already followed same jump locally
+		AppliedPathSerial = ReplicatedPath.Serial;
+		AppliedPathStep = ReplicatedPath.BaseStep;
+	}
+	else if (ReplicatedPath.Serial != AppliedPathSerial)
+	{
+		// New execution or jump on server. Current node is ended in dialogue it belongs to before switching
+		AppliedPathSerial = ReplicatedPath.Serial;
+		StopExecution();
+
+		if (Dialogue != PathDialogue)
+		{
+			SetDialogue(PathDialogue);
+		}
+
+		if (Dialogue != PathDialogue || !BeginExecution_Internal(PathNodes[0], ReplicatedPath.EntryPoint))
+		{
+			AppliedPathStep = INDEX_NONE;
+			return;
+		}
+		AppliedPathStep = ReplicatedPath.BaseStep;
+	}
+	else if (Dialogue != PathDialogue)
+	{
+		// Client followed jump ahead of server, path in new dialogue comes with next serial
+		return;
+	}
+
+	// Window may have slid since last update, position is found by step so looping paths stay unambiguous
+	int32 PathIndex = AppliedPathStep - ReplicatedPath.BaseStep;
+	if (!PathNodes.IsValidIndex(PathIndex) || PathNodes[PathIndex] != CurrentNodeId)
+	{
+		// Client fell behind window or lost track, jump straight to server node
+		PathIndex = PathNodes.Num() - 1;
+		ApplyNodeWithoutEvents(PathNodes[PathIndex], ReplicatedPath.EntryPoint);
+	}
+
+	while (PathIndex < PathNodes.Num() - 1 && IsExecutionInProgress())
+	{
+		PathIndex++;
+		FinishNodeExecution(PathNodes[PathIndex]);
+	}
+	AppliedPathStep = ReplicatedPath.BaseStep + PathIndex;
+
+	if (bFinished)
+	{
+		StopExecution();
+	}
+}
+
+
+/*--------------------------------------------
+ 	FDialogueReplicatedPath
+ *--------------------------------------------*/
+
+void FDialogueReplicatedPath::Begin(UDialogue* InDialogue, FName InEntryPoint, int32 NodeId)
+{
+	Serial++;
+	Dialogue = InDialogue;
+	EntryPoint = InEntryPoint;
+	StartNodeId = NodeId;
+	BaseStep = 0;
+	Codes.Reset();
+}
+
+void FDialogueReplicatedPath::Trim(const FDialogueNodeTable& NodeTable, int32 CurrentNodeId)
+{
+	const int32 StepNum = GetStepNum();
+	const int32 DropNum = StepNum / 2;
+
+	TArray<int32> PathNodes;
+	bool bFinished = false;
+	if (DropNum == 0 || !Decode(NodeTable, PathNodes, bFinished) || !PathNodes.IsValidIndex(DropNum))
+	{
+		BaseStep += StepNum;
+		StartNodeId = CurrentNodeId;
+		Codes.Reset();
+		return;
+	}
+
+	int32 CodeNum = 0;
+	for (int32 Step = 0; Step < DropNum; Step++)
+	{
+		CodeNum += Codes[CodeNum] == Code_Jump ? 2 : 1;
+	}
+	Codes.RemoveAt(0, CodeNum, false);
+	StartNodeId = PathNodes[DropNum];
+	BaseStep += DropNum;
+}
+
+int32 FDialogueReplicatedPath::GetStepNum() const
+{
+	int32 StepNum = 0;
+	for (int32 CodeIndex = 0; CodeIndex < Codes.Num() && Codes[CodeIndex] != Code_End; CodeIndex++)
+	{
+		if (Codes[CodeIndex] == Code_Jump)
+		{
+			CodeIndex++;
+		}
+		StepNum++;
+	}
+	return StepNum;
+}
+
+void FDialogueReplicatedPath::AddTransition(const FDialogueNodeTable& NodeTable, int32 FromNodeId, int32 ToNodeId)
+{
+	if (Codes.Num() + 2 > MaxCodes)
+	{
+		// Keep serial, clients still inside window follow transitions from node they are at
+		Trim(NodeTable, FromNodeId);
+	}
+
+	const int32 FromIndex = NodeTable.FindIndex(FromNodeId);
+	const int32 ToIndex = NodeTable.FindIndex(ToNodeId);
+	const int32 ChildIndex = FromIndex != INDEX_NONE ? NodeTable.GetChildIndices(FromIndex).Find(ToIndex) : INDEX_NONE;
+
+	if (ChildIndex != INDEX_NONE)
+	{
+		Codes.Add(Code_FirstChild + ChildIndex);
+	}
+	else
+	{
+		Codes.Add(Code_Jump);
+		Codes.Add((uint32)ToNodeId);
+	}
+}
+
+void FDialogueReplicatedPath::AddEnd(const FDialogueNodeTable& NodeTable, int32 LastNodeId)
+{
+	if (Codes.Num() + 1 > MaxCodes)
+	{
+		Trim(NodeTable, LastNodeId);
+	}
+	Codes.Add(Code_End);
+}
+
+bool FDialogueReplicatedPath::Decode(const FDialogueNodeTable& NodeTable, TArray<int32>& OutNodes, bool& bOutFinished) const
+{
+	OutNodes.Reset();
+	bOutFinished = false;
+
+	if (StartNodeId < 0)
+	{
+		return true;
+	}
+
+	int32 NodeIndex = NodeTable.FindIndex(StartNodeId);
+	if (NodeIndex == INDEX_NONE)
+	{
+		return false;
+	}
+	OutNodes.Add(StartNodeId);
+
+	for (int32 CodeIndex = 0; CodeIndex < Codes.Num(); CodeIndex++)
+	{
+		const uint32 Code = Codes[CodeIndex];
+		if (Code == Code_End)
+		{
+			bOutFinished = true;
+			break;
+		}
+
+		if (Code == Code_Jump)
+		{
+			if (!Codes.IsValidIndex(CodeIndex + 1))
+			{
+				return false;
+			}
+			CodeIndex++;
+			NodeIndex = NodeTable.FindIndex((int32)Codes[CodeIndex]);
+		}
+		else
+		{
+			const TArrayView<const int32> Children = NodeTable.GetChildIndices(NodeIndex);
+			const int32 ChildIndex = (int32)(Code - Code_FirstChild);
+			NodeIndex = Children.IsValidIndex(ChildIndex) ? Children[ChildIndex] : INDEX_NONE;
+		}
+
+		if (NodeIndex == INDEX_NONE)
+		{
+			return false;
+		}
+		OutNodes.Add(NodeTable.Nodes[NodeIndex].NodeID);
+	}
+
+	return true;
+}
+
+bool FDialogueReplicatedPath::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+{
+	Ar << Serial;
+
+	// Net archives map object through package map, dialogue assets are stably named
+	UObject* DialogueObject = Dialogue;
+	Ar << DialogueObject;
+	Dialogue = Cast<UDialogue>(DialogueObject);
+
+	Ar << EntryPoint;
+
+	uint32 PackedStartNodeId = (uint32)(StartNodeId + 1);
+	Ar.SerializeIntPacked(PackedStartNodeId);
+	StartNodeId = (int32)PackedStartNodeId - 1;
+
+	uint32 PackedBaseStep = (uint32)BaseStep;
+	Ar.SerializeIntPacked(PackedBaseStep);
+	BaseStep = (int32)PackedBaseStep;
+
+	uint32 CodeNum = Codes.Num();
+	Ar.SerializeIntPacked(CodeNum);
+	if (Ar.IsLoading())
+	{
+		if (CodeNum > MaxCodes)
+		{
+			Ar.SetError();
+			bOutSuccess = false;
+			return true;
+		}
+		Codes.SetNumUninitialized(CodeNum);
+	}
+
+	for (uint32& Code : Codes)
+	{
+		Ar.SerializeIntPacked(Code);
+	}
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
+
+
+/*--------------------------------------------
+ 	Debugger log
+ *--------------------------------------------*/
+
+#if WITH_EDITOR
+
+void UDialogueExecutorBase::FDialogueExecutionStep::PushToLog(FDialogueExecutionLog& Log, FSimpleMulticastDelegate& NotifyEvent)
+{
+	if (Log.Push(*this))
+	{
+		NotifyEvent.Broadcast();
+	}
+}
+
+UDialogueExecutorBase::FDialogueExecutionLog::FDialogueExecutionLog()
+{
+	Empty();
+}
+
+void UDialogueExecutorBase::FDialogueExecutionLog::Empty()
+{
+	Capacity = FMath::Max(1, CVarExecutionLogCapacity.GetValueOnGameThread());
+	Buffer.Empty();
+	Head = 0;
+	Count = 0;
+	TotalAdded = 0;
+	PendingEntries.Empty();
+}
+
+UDialogueExecutorBase::FDialogueExecutionStep* UDialogueExecutorBase::FDialogueExecutionLog::FindByPosition(int64 Position)
+{
+	const int64 Oldest = TotalAdded - Count;
+	if (Position < Oldest || Position >= TotalAdded)
+	{
+		return nullptr;
+	}
+	return &Buffer[(Head + (int32)(Position - Oldest)) % Capacity];
+}
+
+void UDialogueExecutorBase::FDialogueExecutionLog::Add(const FDialogueExecutionStep& Step)
+{
+	if (Buffer.Num() < Capacity)
+	{
+		Buffer.Add(Step);
+		Count++;
+	}
+	else
+	{
+		// Overwrite oldest
+		Buffer[Head] = Step;
+		Head = (Head + 1) % Capacity;
+	}
+	TotalAdded++;
+}
+
+bool UDialogueExecutorBase::FDialogueExecutionLog::Push(const FDialogueExecutionStep& Step)
+{
+	switch (Step.Action)
+	{
+	case FDialogueExecutionStep::Active:
+	case FDialogueExecutionStep::Finished:
+		if (Count == 0 || Last() != Step)
+		{
+			// Entry run ends here
+			PendingEntries.Reset();
+			Add(Step);
+			return true;
+		}
+		break;
+
+	case FDialogueExecutionStep::EntryUnknown:
+	case FDialogueExecutionStep::EntryAllowed:
+	case FDialogueExecutionStep::EntryDenied:
+	{
+		const int64* PositionPtr = PendingEntries.Find(Step.NodeId);
+		if (FDialogueExecutionStep* Existing = PositionPtr ? FindByPosition(*PositionPtr) : nullptr)
+		{
+			const bool bChanged = Existing->Action != Step.Action;
+			Existing->Action = Step.Action;
+			return bChanged;
+		}
+
+		PendingEntries.Add(Step.NodeId, TotalAdded);
+		Add(Step);
+		return true;
+	}
+
+	case FDialogueExecutionStep::None:
+	default:
+		break;
+	}
+
+	return false;
+}
+
+#endif // WITH_EDITOR
+
 #undef  LOCTEXT_NAMESPACE 
\ No newline at end of file
@@ -0,0 +1,333 @@
+
+#include "DialogueLiteExecutor.h"
+#include "DialogueContext.h"
+#include "DialogueParticipantInterface.h"
+#include "DialogueStats.h"
+#include "Sound/SoundBase.h"
+#include "UObject/UObjectGlobals.h"
+
+
+/*--------------------------------------------
+ 	FDialogueLiteExecutor
+ *--------------------------------------------*/
+
+int32 FDialogueLiteExecutor::GetNodeId() const
+{
+	return IsRunning() ? Dialogue->GetNodeTable().Nodes[NodeIndex].NodeID : INDEX_NONE;
+}
+
+FDialogueNodeView FDialogueLiteExecutor::GetNodeView() const
+{
+	return IsRunning() ? FDialogueNodeView(Dialogue->GetNodeTable(), NodeIndex) : FDialogueNodeView();
+}
+
+void FDialogueLiteExecutor::SetParticipant(FName Name, UObject* Participant)
+{
+	for (auto& Pair : Participants)
+	{
+		if (Pair.Key == Name)
+		{
+			Pair.Value = Participant;
+			return;
+		}
+	}
+	Participants.Emplace(Name, Participant);
+}
+
+UObject* FDialogueLiteExecutor::ResolveParticipant(const FDialogueParticipant& Participant) const
+{
+	if (Participant.Name != NAME_None)
+	{
+		for (const auto& Pair : Participants)
+		{
+			if (Pair.Key == Participant.Name)
+			{
+				return Pair.Value.Get();
+			}
+		}
+		return nullptr;
+	}
+
+	return Participant.Object;
+}
+
+bool FDialogueLiteExecutor::Begin(UDialogue* InDialogue, int32 NodeId, UObject* WorldContext)
+{
+	Stop(WorldContext);
+
+	Dialogue = InDialogue;
+	const int32 Index = Dialogue ? Dialogue->GetNodeTable().FindIndex(NodeId) : INDEX_NONE;
+	if (Index == INDEX_NONE)
+	{
+		Dialogue = nullptr;
+		return false;
+	}
+
+	MoveTo(Index, WorldContext);
+	FollowJumps(WorldContext);
+	return IsRunning();
+}
+
+bool FDialogueLiteExecutor::Advance(UObject* WorldContext)
+{
+	if (!IsRunning())
+	{
+		return false;
+	}
+
+	if (bWaitingForJump)
+	{
+		FollowJumps(WorldContext);
+		return IsRunning();
+	}
+
+	const int32 NextIndex = Dialogue->GetNodeTable().FindFirstAvailableChild(NodeIndex, WorldContext);
+	MoveTo(NextIndex, WorldContext);
+	FollowJumps(WorldContext);
+	return IsRunning();
+}
+
+void FDialogueLiteExecutor::Stop(UObject* WorldContext)
+{
+	if (IsRunning())
+	{
+		MoveTo(INDEX_NONE, WorldContext);
+	}
+}
+
+void FDialogueLiteExecutor::MoveTo(int32 NewIndex, UObject* WorldContext)
+{
+	const FDialogueNodeTable& NodeTable = Dialogue->GetNodeTable();
+
+	if (bNotifyNodes && NodeIndex != INDEX_NONE)
+	{
+		const FDialogueNode& Node = NodeTable.Nodes[NodeIndex];
+		if (UObject* Participant = ResolveParticipant(Node.Participant))
+		{
+			DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_Dialogue_ParticipantCallback, "ParticipantOnNodeLeft", Dialogue, Node.NodeID);
+			IDialogueParticipantInterface::Execute_OnNodeLeft(Participant, WorldContext, Dialogue, Node.NodeID);
+		}
+		if (Node.Context)
+		{
+			DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_Dialogue_ContextCallback, "ContextOnNodeLeft", Dialogue, Node.NodeID);
+			Node.Context->OnNodeLeft(WorldContext);
+		}
+		if (const FDialogueNodeContextStruct* ContextStruct = NodeTable.GetContextStruct(NodeIndex))
+		{
+			DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_Dialogue_ContextCallback, "ContextOnNodeLeft", Dialogue, Node.NodeID);
+			ContextStruct->OnNodeLeft(WorldContext, Node.NodeID);
+		}
+	}
+
+	NodeIndex = NewIndex;
+
+	if (bNotifyNodes && NodeIndex != INDEX_NONE)
+	{
+		const FDialogueNode& Node = NodeTable.Nodes[NodeIndex];
+		if (UObject* Participant = ResolveParticipant(Node.Participant))
+		{
+			DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_Dialogue_ParticipantCallback, "ParticipantOnNodeEntered", Dialogue, Node.NodeID);
+			IDialogueParticipantInterface::Execute_OnNodeEntered(Participant, WorldContext, Dialogue, Node.NodeID);
+		}
+		if (Node.Context)
+		{
+			DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_Dialogue_ContextCallback, "ContextOnNodeEntered", Dialogue, Node.NodeID);
+			Node.Context->OnNodeEntered(WorldContext);
+		}
+		if (const FDialogueNodeContextStruct* ContextStruct = NodeTable.GetContextStruct(NodeIndex))
+		{
+			DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_Dialogue_ContextCallback, "ContextOnNodeEntered", Dialogue, Node.NodeID);
+			ContextStruct->OnNodeEntered(WorldContext, Node.NodeID);
+		}
+	}
+
+	if (NodeIndex == INDEX_NONE)
+	{
+		Dialogue = nullptr;
+	}
+}
+
+void FDialogueLiteExecutor::FollowJumps(UObject* WorldContext)
+{
+	bWaitingForJump = false;
+
+	for (int32 JumpNum = 0; JumpNum < FDialogueJump::MaxChainLength && IsRunning(); JumpNum++)
+	{
+		const FDialogueJump& Jump = Dialogue->GetNodeTable().Nodes[NodeIndex].Jump;
+
+		// Batched tick must not block on loads, prefetcher already requested target of current node
+		if (Jump.IsSet() && !Jump.IsTargetLoaded())
+		{
+			bWaitingForJump = true;
+			return;
+		}
+
+		UDialogue* TargetDialogue = nullptr;
+		int32 TargetNodeId = INDEX_NONE;
+		if (!Jump.Resolve(TargetDialogue, TargetNodeId))
+		{
+			return;
+		}
+
+		MoveTo(INDEX_NONE, WorldContext);
+		Dialogue = TargetDialogue;
+		MoveTo(Dialogue->GetNodeTable().FindIndex(TargetNodeId), WorldContext);
+	}
+}
+
+
+
+/*--------------------------------------------
+ 	FDialogueLiteExecutorList
+ *--------------------------------------------*/
+
+FDialogueLiteExecutorHandle FDialogueLiteExecutorList::MakeHandle(int32 Index) const
+{
+	FDialogueLiteExecutorHandle Handle;
+	Handle.Index = Index;
+	Handle.Serial = Executors[Index].Serial;
+	return Handle;
+}
+
+FDialogueLiteExecutorHandle FDialogueLiteExecutorList::Add(UDialogue* Dialogue, FName EntryPoint, float Time, UObject* WorldContext, bool bNotifyNodes)
+{
+	const int32 NodeId = Dialogue ? Dialogue->GetEntryId(EntryPoint) : INDEX_NONE;
+	if (NodeId == INDEX_NONE)
+	{
+		return FDialogueLiteExecutorHandle();
+	}
+
+	const int32 Index = FreeIndices.Num() > 0 ? FreeIndices.Pop(false) : Executors.AddDefaulted();
+
+	FDialogueLiteExecutor& Executor = Executors[Index];
+	Executor = FDialogueLiteExecutor();
+	Executor.Serial = NextSerial++;
+	Executor.bNotifyNodes = bNotifyNodes;
+
+	if (!Executor.Begin(Dialogue, NodeId, WorldContext))
+	{
+		Executor.Serial = 0;
+		FreeIndices.Add(Index);
+		return FDialogueLiteExecutorHandle();
+	}
+
+	RunningNum++;
+	EnterNode(Index, Time);
+	return MakeHandle(Index);
+}
+
+void FDialogueLiteExecutorList::Remove(FDialogueLiteExecutorHandle Handle, UObject* WorldContext)
+{
+	if (FDialogueLiteExecutor* Executor = Find(Handle))
+	{
+		Executor->Stop(WorldContext);
+		RemoveAt(Handle.Index);
+	}
+}
+
+FDialogueLiteExecutor* FDialogueLiteExecutorList::Find(FDialogueLiteExecutorHandle Handle)
+{
+	return (Executors.IsValidIndex(Handle.Index) && Executors[Handle.Index].Serial == Handle.Serial && Handle.Serial != 0) ? &Executors[Handle.Index] : nullptr;
+}
+
+const FDialogueLiteExecutor* FDialogueLiteExecutorList::Find(FDialogueLiteExecutorHandle Handle) const
+{
+	return const_cast<FDialogueLiteExecutorList*>(this)->Find(Handle);
+}
+
+bool FDialogueLiteExecutorList::Advance(FDialogueLiteExecutorHandle Handle, float Time, UObject* WorldContext)
+{
+	FDialogueLiteExecutor* Executor = Find(Handle);
+	if (!Executor)
+	{
+		return false;
+	}
+
+	if (Executor->Advance(WorldContext))
+	{
+		EnterNode(Handle.Index, Time);
+		return true;
+	}
+
+	RemoveAt(Handle.Index);
+	return false;
+}
+
+void FDialogueLiteExecutorList::Tick(float Time, UObject* WorldContext)
+{
+	TickRange(0, Executors.Num(), Time, WorldContext);
+}
+
+int32 FDialogueLiteExecutorList::TickRange(int32 StartIndex, int32 MaxNum, float Time, UObject* WorldContext)
+{
+	const int32 EndIndex = FMath::Min(Executors.Num(), StartIndex + MaxNum);
+	for (int32 Index = StartIndex; Index < EndIndex; Index++)
+	{
+		FDialogueLiteExecutor& Executor = Executors[Index];
+		if (!Executor.IsRunning())
+		{
+			continue;
+		}
+
+		if (Executor.AdvanceTime <= Time)
+		{
+			Advance(MakeHandle(Index), Time, WorldContext);
+		}
+	}
+
+	return EndIndex >= Executors.Num() ? 0 : EndIndex;
+}
+
+void FDialogueLiteExecutorList::Empty()
+{
+	Executors.Empty();
+	FreeIndices.Empty();
+	RunningNum = 0;
+}
+
+void FDialogueLiteExecutorList::AddReferencedObjects(FReferenceCollector& Collector, const UObject* Referencer)
+{
+	for (FDialogueLiteExecutor& Executor : Executors)
+	{
+		if (Executor.Dialogue)
+		{
+			Collector.AddReferencedObject(Executor.Dialogue, Referencer);
+		}
+	}
+}
+
+void FDialogueLiteExecutorList::EnterNode(int32 Index, float Time)
+{
+	FDialogueLiteExecutor& Executor = Executors[Index];
+	FDialogueNodeView View = Executor.GetNodeView();
+
+	Executor.Prefetcher.Update(Executor.Dialogue, Executor.NodeIndex, PrefetchDepth);
+
+	// Jump node isn't a line, listeners get the node jump leads to once its dialogue is loaded
+	if (Executor.bWaitingForJump)
+	{
+		Executor.AdvanceTime = Time;
+		return;
+	}
+
+	// Batched tick must not block on loads, sound not prefetched yet plays default duration
+	USoundBase* Sound = View->Sound.Get();
+	const float SoundDuration = Sound ? Sound->GetDuration() : 0.0f;
+	Executor.AdvanceTime = Time + ((SoundDuration > 0.0f && SoundDuration < INDEFINITELY_LOOPING_DURATION) ? SoundDuration : DefaultNodeDuration);
+
+	OnNodeEntered.Broadcast(MakeHandle(Index), View);
+}
+
+void FDialogueLiteExecutorList::RemoveAt(int32 Index)
+{
+	FDialogueLiteExecutor& Executor = Executors[Index];
+	Executor.Dialogue = nullptr;
+	Executor.NodeIndex = INDEX_NONE;
+	Executor.Serial = 0;
+	Executor.bWaitingForJump = false;
+	Executor.Participants.Reset();
+	Executor.Prefetcher.Reset();
+
+	FreeIndices.Add(Index);
+	RunningNum--;
+}
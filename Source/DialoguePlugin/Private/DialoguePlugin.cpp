@@ -3,12 +3,54 @@
 #include "DialoguePlugin.h"
 #include "Dialogue.h"
 #include "DialogueExecutor.h"
+#include "DialogueSubsystem.h"
+#include "DialoguePrefetch.h"
+#include "DialogueTrace.h"
+#include "DialogueStats.h"
+#include "Sound/SoundBase.h"
+#include "Sound/DialogueWave.h"
 
 DEFINE_LOG_CATEGORY(LogDialogue);
+
+DEFINE_STAT(STAT_Dialogue_FindAvailableNextNodes);
+DEFINE_STAT(STAT_Dialogue_CheckNodeCondition);
+DEFINE_STAT(STAT_Dialogue_Condition);
+DEFINE_STAT(STAT_Dialogue_FormatText);
+DEFINE_STAT(STAT_Dialogue_ExecuteNodeEvents);
+DEFINE_STAT(STAT_Dialogue_MoveToNode);
+DEFINE_STAT(STAT_Dialogue_ParticipantCallback);
+DEFINE_STAT(STAT_Dialogue_ContextCallback);
+
+UE_TRACE_CHANNEL_DEFINE(DialogueChannel);
+
+#if CPUPROFILERTRACE_ENABLED
+void FDialogueInsightsScope::Begin(const TCHAR* Name, const UObject* Object, int32 NodeId)
+{
+	FString EventName = Name;
+	if (Object)
+	{
+		EventName += TEXT(" ") + Object->GetName();
+	}
+	if (NodeId != INDEX_NONE)
+	{
+		EventName += FString::Printf(TEXT(" #%d"), NodeId);
+	}
+
+	FCpuProfilerTrace::OutputBeginDynamicEvent(*EventName);
+}
+#endif // CPUPROFILERTRACE_ENABLED
 	
 IMPLEMENT_MODULE(FDialoguePlugin, DialoguePlugin)
 
 
+void FDialoguePlugin::ShutdownModule()
+{
+#if DIALOGUE_TRACE_ENABLED
+	FDialogueTrace::Stop();
+#endif // DIALOGUE_TRACE_ENABLED
+}
+
+
 void UDialogueUtilityLibrary::CreateDialogueExecutor(TSubclassOf<UDialogueExecutorBase> Class, UObject* Owner, UDialogue* Dialogue, bool bDeferInitialization, UDialogueExecutorBase*& OutExecutor)
 {
 	OutExecutor = nullptr;
@@ -20,6 +62,11 @@ void UDialogueUtilityLibrary::CreateDialogueExecutor(TSubclassOf<UDialogueExecut
 			OutExecutor->Dialogue = Dialogue;
 			OutExecutor->HandleCreated();
 
+			if (UDialogueSubsystem* Subsystem = UDialogueSubsystem::Get(Owner))
+			{
+				Subsystem->RegisterExecutor(OutExecutor);
+			}
+
 			if (!bDeferInitialization)
 			{
 				OutExecutor->Initialize();
@@ -27,3 +74,106 @@ void UDialogueUtilityLibrary::CreateDialogueExecutor(TSubclassOf<UDialogueExecut
 		}
 	}
 }
+
+
+void UDialogueUtilityLibrary::AcquireDialogueExecutor(TSubclassOf<UDialogueExecutorBase> Class, UObject* Owner, UDialogue* Dialogue, bool bDeferInitialization, UDialogueExecutorBase*& OutExecutor)
+{
+	UDialogueSubsystem* Subsystem = UDialogueSubsystem::Get(Owner);
+	if (!Subsystem)
+	{
+		CreateDialogueExecutor(Class, Owner, Dialogue, bDeferInitialization, OutExecutor);
+		return;
+	}
+
+	OutExecutor = Subsystem->AcquireExecutor(Class, Owner);
+	if (OutExecutor)
+	{
+		OutExecutor->SetDialogue(Dialogue);
+
+		if (!bDeferInitialization)
+		{
+			OutExecutor->Initialize();
+		}
+	}
+}
+
+void UDialogueUtilityLibrary::ReleaseDialogueExecutor(UDialogueExecutorBase* Executor)
+{
+	if (!Executor)
+	{
+		return;
+	}
+
+	if (UDialogueSubsystem* Subsystem = UDialogueSubsystem::Get(Executor))
+	{
+		Subsystem->ReleaseExecutor(Executor);
+	}
+	else
+	{
+		Executor->ResetExecutor();
+	}
+}
+
+
+bool UDialogueUtilityLibrary::IsNodeHandleValid(const FDialogueNodeHandle& Handle)
+{
+	return Handle.IsValid();
+}
+
+FDialogueNode UDialogueUtilityLibrary::GetHandleNode(const FDialogueNodeHandle& Handle)
+{
+	return Handle.Dialogue ? Handle.Dialogue->GetNode(Handle.NodeId) : FDialogueNode();
+}
+
+FName UDialogueUtilityLibrary::GetHandleNodeType(const FDialogueNodeHandle& Handle)
+{
+	FDialogueNodeView View = Handle.GetView();
+	return View ? View->NodeType : NAME_None;
+}
+
+FText UDialogueUtilityLibrary::GetHandleText(const FDialogueNodeHandle& Handle)
+{
+	FDialogueNodeView View = Handle.GetView();
+	return View ? View->Text : FText::GetEmpty();
+}
+
+FDialogueParticipant UDialogueUtilityLibrary::GetHandleParticipant(const FDialogueNodeHandle& Handle)
+{
+	FDialogueNodeView View = Handle.GetView();
+	return View ? View->Participant : FDialogueParticipant();
+}
+
+bool UDialogueUtilityLibrary::IsHandleAudioReady(const FDialogueNodeHandle& Handle)
+{
+	FDialogueNodeView View = Handle.GetView();
+	return !View || FDialoguePrefetcher::IsNodeAudioReady(*View);
+}
+
+USoundBase* UDialogueUtilityLibrary::GetHandleSound(const FDialogueNodeHandle& Handle)
+{
+	FDialogueNodeView View = Handle.GetView();
+	return View ? View->Sound.Get() : nullptr;
+}
+
+UDialogueWave* UDialogueUtilityLibrary::GetHandleDialogueWave(const FDialogueNodeHandle& Handle)
+{
+	FDialogueNodeView View = Handle.GetView();
+	return View ? View->DialogueWave.Get() : nullptr;
+}
+
+UDialogueNodeContext* UDialogueUtilityLibrary::GetHandleContext(const FDialogueNodeHandle& Handle)
+{
+	FDialogueNodeView View = Handle.GetView();
+	return View ? View->Context : nullptr;
+}
+
+int32 UDialogueUtilityLibrary::GetHandleChildrenNum(const FDialogueNodeHandle& Handle)
+{
+	return Handle.GetView().GetChildrenNum();
+}
+
+FDialogueNodeHandle UDialogueUtilityLibrary::GetHandleChild(const FDialogueNodeHandle& Handle, int32 ChildIndex)
+{
+	FDialogueNodeView Child = Handle.GetView().GetChild(ChildIndex);
+	return Child ? FDialogueNodeHandle(Handle.Dialogue, Child.GetNodeId()) : FDialogueNodeHandle();
+}
@@ -0,0 +1,110 @@
+#include "DialoguePrefetch.h"
+#include "Dialogue.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Sound/SoundBase.h"
+#include "Sound/DialogueWave.h"
+
+
+FDialoguePrefetcher::~FDialoguePrefetcher()
+{
+	Reset();
+}
+
+void FDialoguePrefetcher::Update(const UDialogue* Dialogue, int32 NodeIndex, int32 Depth)
+{
+	if (!Dialogue || NodeIndex == INDEX_NONE)
+	{
+		Reset();
+		return;
+	}
+
+	const FDialogueNodeTable& NodeTable = Dialogue->GetNodeTable();
+
+	// Nearest level is requested first and with higher priority
+	TArray<TPair<FSoftObjectPath, int32>, TInlineAllocator<16>> Wanted;
+	auto AddNodeAssets = [&Wanted](const FDialogueNode& Node, int32 Priority)
+	{
+		if (Node.Jump.IsSet())
+		{
+			Wanted.Emplace(Node.Jump.Dialogue.ToSoftObjectPath(), Priority);
+		}
+		if (!Node.Sound.IsNull())
+		{
+			Wanted.Emplace(Node.Sound.ToSoftObjectPath(), Priority);
+		}
+		if (!Node.DialogueWave.IsNull())
+		{
+			Wanted.Emplace(Node.DialogueWave.ToSoftObjectPath(), Priority);
+		}
+	};
+
+	TArray<int32, TInlineAllocator<16>> Level;
+	TArray<int32, TInlineAllocator<16>> NextLevel;
+	Level.Add(NodeIndex);
+	AddNodeAssets(NodeTable.Nodes[NodeIndex], FStreamableManager::AsyncLoadHighPriority);
+
+	for (int32 LevelIndex = 0; LevelIndex < Depth && Level.Num() > 0; LevelIndex++)
+	{
+		const int32 Priority = LevelIndex == 0 ? FStreamableManager::AsyncLoadHighPriority : FStreamableManager::DefaultAsyncLoadPriority;
+
+		NextLevel.Reset();
+		for (int32 Index : Level)
+		{
+			for (int32 ChildIndex : NodeTable.GetChildIndices(Index))
+			{
+				AddNodeAssets(NodeTable.Nodes[ChildIndex], Priority);
+
+				// Execution never continues to children of jump node
+				if (!NodeTable.Nodes[ChildIndex].Jump.IsSet())
+				{
+					NextLevel.Add(ChildIndex);
+				}
+			}
+		}
+		Swap(Level, NextLevel);
+	}
+
+	for (auto It = Handles.CreateIterator(); It; ++It)
+	{
+		if (!Wanted.ContainsByPredicate([&It](const TPair<FSoftObjectPath, int32>& Pair) { return Pair.Key == It.Key(); }))
+		{
+			if (It.Value().IsValid())
+			{
+				It.Value()->CancelHandle();
+			}
+			It.RemoveCurrent();
+		}
+	}
+
+	FStreamableManager& StreamableManager = GetStreamableManager();
+	for (const TPair<FSoftObjectPath, int32>& Pair : Wanted)
+	{
+		if (!Handles.Contains(Pair.Key))
+		{
+			Handles.Add(Pair.Key, StreamableManager.RequestAsyncLoad(Pair.Key, FStreamableDelegate(), Pair.Value));
+		}
+	}
+}
+
+void FDialoguePrefetcher::Reset()
+{
+	for (auto& Pair : Handles)
+	{
+		if (Pair.Value.IsValid())
+		{
+			Pair.Value->CancelHandle();
+		}
+	}
+	Handles.Reset();
+}
+
+bool FDialoguePrefetcher::IsNodeAudioReady(const FDialogueNode& Node)
+{
+	return (Node.Sound.IsNull() || Node.Sound.IsValid()) && (Node.DialogueWave.IsNull() || Node.DialogueWave.IsValid());
+}
+
+FStreamableManager& FDialoguePrefetcher::GetStreamableManager()
+{
+	return UAssetManager::GetStreamableManager();
+}
@@ -0,0 +1,325 @@
+#include "DialogueRecording.h"
+#include "DialoguePlugin.h"
+#include "Dialogue.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "Serialization/NameAsStringProxyArchive.h"
+#include "UObject/Package.h"
+
+
+static TAutoConsoleVariable<int32> CVarDialogueRecordExecutions(
+	TEXT("dialogue.RecordExecutions"),
+	0,
+	TEXT("Record every dialogue execution to Saved/Dialogue/Recordings for replay with dialogue.Replay"),
+	ECVF_Default);
+
+static FAutoConsoleCommand CmdDialogueReplay(
+	TEXT("dialogue.Replay"),
+	TEXT("Replay recorded dialogue execution and print node sequence diff. Usage: dialogue.Replay <RecordingFile>"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		if (Args.Num() < 1)
+		{
+			UE_LOG(LogDialogue, Warning, TEXT("Usage: dialogue.Replay <RecordingFile>"));
+			return;
+		}
+
+		FDialogueExecutionRecording Recording;
+		if (!Recording.LoadFromFile(Args[0]))
+		{
+			UE_LOG(LogDialogue, Error, TEXT("Failed to load dialogue recording %s"), *Args[0]);
+			return;
+		}
+
+		FDialogueReplayResult Result;
+		FDialogueExecutionReplayer::Replay(Recording, Result);
+
+		if (Result.IsIdentical())
+		{
+			UE_LOG(LogDialogue, Display, TEXT("%s"), *Result.ToString());
+		}
+		else
+		{
+			UE_LOG(LogDialogue, Warning, TEXT("%s"), *Result.ToString());
+		}
+	}));
+
+
+void FDialogueExecutionRecording::BeginExecution(const UDialogueExecutorBase& Executor, int32 NodeId, FName InEntryPoint)
+{
+	UDialogue* Dialogue = Executor.GetDialogue();
+	DialoguePath = Dialogue ? Dialogue->GetPathName() : FString();
+	EntryPoint = InEntryPoint;
+	EntryNodeId = NodeId;
+
+	Participants.Reset();
+	for (const auto& Pair : Executor.Participants)
+	{
+		FDialogueRecordedParticipant& Participant = Participants.AddDefaulted_GetRef();
+		Participant.Name = Pair.Key;
+		Participant.ObjectPath = Pair.Value ? Pair.Value->GetPathName() : FString();
+		Participant.ClassPath = Pair.Value ? Pair.Value->GetClass()->GetPathName() : FString();
+	}
+
+	Choices.Reset();
+	ChoiceConditionNum.Reset();
+	Conditions.Reset();
+	Queries.Reset();
+	ChoiceQueryNum.Reset();
+	NodeSequence.Reset();
+	DialogueSwitches.Reset();
+}
+
+void FDialogueExecutionRecording::SwitchDialogue(const UDialogue* Dialogue, int32 NodeId, FName InEntryPoint)
+{
+	FDialogueRecordedSwitch& Switch = DialogueSwitches.AddDefaulted_GetRef();
+	Switch.ChoiceIndex = Choices.Num();
+	Switch.NodeId = NodeId;
+	Switch.EntryPoint = InEntryPoint;
+	Switch.DialoguePath = Dialogue ? Dialogue->GetPathName() : FString();
+}
+
+void FDialogueExecutionRecording::Serialize(FArchive& Ar)
+{
+	int32 FileVersion = Version;
+	Ar << FileVersion;
+	if (Ar.IsLoading() && (FileVersion < MinVersion || FileVersion > Version))
+	{
+		Ar.SetError();
+		return;
+	}
+
+	Ar << DialoguePath;
+	Ar << EntryPoint;
+	Ar << EntryNodeId;
+	Ar << Participants;
+	Ar << Choices;
+	Ar << Conditions;
+	Ar << NodeSequence;
+	Ar << ChoiceConditionNum;
+	Ar << Queries;
+	Ar << ChoiceQueryNum;
+	Ar << DialogueSwitches;
+}
+
+bool FDialogueExecutionRecording::SaveToFile(const FString& FilePath)
+{
+	TUniquePtr<FArchive> File(IFileManager::Get().CreateFileWriter(*FilePath));
+	if (!File)
+	{
+		return false;
+	}
+
+	// File archives don't serialize names
+	FNameAsStringProxyArchive Ar(*File);
+	Serialize(Ar);
+	return File->Close();
+}
+
+bool FDialogueExecutionRecording::LoadFromFile(const FString& FilePath)
+{
+	TUniquePtr<FArchive> File(IFileManager::Get().CreateFileReader(*FilePath));
+	if (!File)
+	{
+		return false;
+	}
+
+	FNameAsStringProxyArchive Ar(*File);
+	Serialize(Ar);
+	return !Ar.IsError() && !File->IsError();
+}
+
+bool FDialogueExecutionRecording::IsAutoRecordEnabled()
+{
+	return CVarDialogueRecordExecutions.GetValueOnGameThread() != 0;
+}
+
+FString FDialogueExecutionRecording::MakeAutoRecordPath(const UDialogueExecutorBase& Executor)
+{
+	const UDialogue* Dialogue = Executor.GetDialogue();
+	const FString DialogueName = Dialogue ? Dialogue->GetName() : TEXT("None");
+
+	return FPaths::ProjectSavedDir() / TEXT("Dialogue") / TEXT("Recordings")
+		/ FString::Printf(TEXT("%s_%s_%s.dlgrec"), *DialogueName, *Executor.GetName(), *FDateTime::Now().ToString(TEXT("%Y%m%d-%H%M%S-%s")));
+}
+
+
+FString FDialogueReplayResult::ToString() const
+{
+	auto SequenceToString = [](const TArray<int32>& Sequence)
+	{
+		return FString::JoinBy(Sequence, TEXT(" "), [](int32 NodeId) { return FString::FromInt(NodeId); });
+	};
+
+	FString Result = IsIdentical() ? TEXT("Dialogue replay matches recording") : TEXT("Dialogue replay differs from recording");
+
+	if (DivergenceIndex != INDEX_NONE)
+	{
+		Result += FString::Printf(TEXT("\n  Diverged at step %d: expected %d, got %d"), DivergenceIndex,
+			ExpectedSequence.IsValidIndex(DivergenceIndex) ? ExpectedSequence[DivergenceIndex] : INDEX_NONE,
+			NodeSequence.IsValidIndex(DivergenceIndex) ? NodeSequence[DivergenceIndex] : INDEX_NONE);
+	}
+	if (ConditionMismatchNum > 0)
+	{
+		Result += FString::Printf(TEXT("\n  %d condition checks didn't match recording"), ConditionMismatchNum);
+	}
+	for (const FString& Error : Errors)
+	{
+		Result += TEXT("\n  ") + Error;
+	}
+	for (FName Participant : UnresolvedParticipants)
+	{
+		Result += FString::Printf(TEXT("\n  Participant %s not found"), *Participant.ToString());
+	}
+
+	Result += TEXT("\n  Expected: ") + SequenceToString(ExpectedSequence);
+	Result += TEXT("\n  Replayed: ") + SequenceToString(NodeSequence);
+
+	return Result;
+}
+
+
+bool FDialogueExecutionReplayer::Replay(const FDialogueExecutionRecording& Recording, FDialogueReplayResult& OutResult, UDialogue* Dialogue)
+{
+	OutResult = FDialogueReplayResult();
+	OutResult.ExpectedSequence = Recording.NodeSequence;
+
+	if (!Dialogue)
+	{
+		Dialogue = LoadObject<UDialogue>(nullptr, *Recording.DialoguePath);
+	}
+	if (!Dialogue)
+	{
+		OutResult.Errors.Add(FString::Printf(TEXT("Dialogue %s not found"), *Recording.DialoguePath));
+		return false;
+	}
+
+	UDialogueReplayExecutor* Executor = NewObject<UDialogueReplayExecutor>(GetTransientPackage());
+	Executor->SetDialogue(Dialogue);
+
+	for (const FDialogueRecordedParticipant& Participant : Recording.Participants)
+	{
+		UObject* Object = Participant.ObjectPath.IsEmpty() ? nullptr : StaticFindObject(UObject::StaticClass(), nullptr, *Participant.ObjectPath);
+		if (Object)
+		{
+			Executor->SetParticipant(Participant.Name, Object);
+		}
+		else
+		{
+			OutResult.UnresolvedParticipants.Add(Participant.Name);
+		}
+	}
+
+	TSharedRef<FDialogueExecutionRecording> Replayed = MakeShared<FDialogueExecutionRecording>();
+	Executor->SetReplaySource(MakeShared<FDialogueExecutionRecording>(Recording));
+	Executor->SetRecording(Replayed);
+
+	const bool bStarted = Recording.EntryPoint.IsNone() ? Executor->BeginExecutionAtNode(Recording.EntryNodeId) : Executor->BeginExecution(Recording.EntryPoint);
+	if (!bStarted)
+	{
+		OutResult.Errors.Add(TEXT("Execution failed to start"));
+	}
+	else
+	{
+		for (int32 ChoiceIndex = 0; ChoiceIndex < Recording.Choices.Num(); ChoiceIndex++)
+		{
+			if (!Executor->IsExecutionInProgress())
+			{
+				OutResult.Errors.Add(FString::Printf(TEXT("Execution finished before choice %d"), ChoiceIndex));
+				break;
+			}
+
+			const int32 CurrentNodeId = Executor->GetCurrentNodeId();
+			const int32 NextNodeId = Recording.Choices[ChoiceIndex];
+
+			if (Recording.ChoiceConditionNum.IsValidIndex(ChoiceIndex))
+			{
+				Executor->SetReplayConditionRange(ChoiceIndex > 0 ? Recording.ChoiceConditionNum[ChoiceIndex - 1] : 0, Recording.ChoiceConditionNum[ChoiceIndex]);
+			}
+
+			// Queries of this step are repeated as made, evaluations that no longer line up with asset are counted as mismatches
+			// Full child query of current node is the choice menu user picked from
+			TArray<int32> AvailableNodes;
+			bool bHasChoiceMenu = false;
+			if (Recording.ChoiceQueryNum.IsValidIndex(ChoiceIndex))
+			{
+				const int32 QueryEnd = FMath::Min(Recording.ChoiceQueryNum[ChoiceIndex], Recording.Queries.Num());
+				for (int32 QueryIndex = ChoiceIndex > 0 ? Recording.ChoiceQueryNum[ChoiceIndex - 1] : 0; QueryIndex < QueryEnd; QueryIndex++)
+				{
+					const FDialogueRecordedQuery& Query = Recording.Queries[QueryIndex];
+					switch (Query.Type)
+					{
+					case EDialogueRecordedQuery::AllChildren:
+					case EDialogueRecordedQuery::FirstChild:
+					{
+						TArray<int32> QueryResult = Executor->FindAvailableNextNodes(Query.NodeId, Query.Type == EDialogueRecordedQuery::FirstChild);
+						if (Query.NodeId == CurrentNodeId && Query.Type == EDialogueRecordedQuery::AllChildren)
+						{
+							AvailableNodes = MoveTemp(QueryResult);
+							bHasChoiceMenu = true;
+						}
+						break;
+					}
+					case EDialogueRecordedQuery::Node:
+						Executor->CheckNodeCondition(Query.NodeId);
+						break;
+					}
+				}
+			}
+
+			// Choice is not validated by executor, report transitions that no longer exist in asset or were not available
+			// Executor follows jumps itself, choice belongs to dialogue it is in now
+			const FDialogueNodeTable& NodeTable = Executor->GetDialogue()->GetNodeTable();
+			const int32 CurrentIndex = NodeTable.FindIndex(CurrentNodeId);
+			const int32 NextIndex = NodeTable.FindIndex(NextNodeId);
+			if (NextNodeId >= 0 && CurrentIndex != INDEX_NONE && !NodeTable.GetChildIndices(CurrentIndex).Contains(NextIndex))
+			{
+				OutResult.Errors.Add(FString::Printf(TEXT("Choice %d: node %d is not a child of %d"), ChoiceIndex, NextNodeId, CurrentNodeId));
+			}
+			else if (NextNodeId >= 0 && bHasChoiceMenu && !AvailableNodes.Contains(NextNodeId))
+			{
+				OutResult.Errors.Add(FString::Printf(TEXT("Choice %d: node %d is not available from %d"), ChoiceIndex, NextNodeId, CurrentNodeId));
+			}
+
+			Executor->FinishNodeExecution(NextNodeId);
+		}
+
+		Executor->StopExecution();
+	}
+
+	OutResult.NodeSequence = Replayed->NodeSequence;
+	OutResult.ConditionMismatchNum = Executor->GetReplayConditionMismatchNum();
+
+	for (int32 Index = 0; Index < FMath::Max(Recording.DialogueSwitches.Num(), Replayed->DialogueSwitches.Num()); Index++)
+	{
+		const FDialogueRecordedSwitch* Expected = Recording.DialogueSwitches.IsValidIndex(Index) ? &Recording.DialogueSwitches[Index] : nullptr;
+		const FDialogueRecordedSwitch* Actual = Replayed->DialogueSwitches.IsValidIndex(Index) ? &Replayed->DialogueSwitches[Index] : nullptr;
+		if (!Expected || !Actual || Expected->DialoguePath != Actual->DialoguePath || Expected->ChoiceIndex != Actual->ChoiceIndex || Expected->NodeId != Actual->NodeId)
+		{
+			OutResult.Errors.Add(FString::Printf(TEXT("Dialogue switch %d: expected %s at choice %d, got %s at choice %d"), Index,
+				Expected ? *Expected->DialoguePath : TEXT("none"), Expected ? Expected->ChoiceIndex : INDEX_NONE,
+				Actual ? *Actual->DialoguePath : TEXT("none"), Actual ? Actual->ChoiceIndex : INDEX_NONE));
+			break;
+		}
+	}
+
+	const int32 CommonNum = FMath::Min(OutResult.NodeSequence.Num(), OutResult.ExpectedSequence.Num());
+	for (int32 Index = 0; Index < CommonNum; Index++)
+	{
+		if (OutResult.NodeSequence[Index] != OutResult.ExpectedSequence[Index])
+		{
+			OutResult.DivergenceIndex = Index;
+			break;
+		}
+	}
+	if (OutResult.DivergenceIndex == INDEX_NONE && OutResult.NodeSequence.Num() != OutResult.ExpectedSequence.Num())
+	{
+		OutResult.DivergenceIndex = CommonNum;
+	}
+
+	Executor->ResetExecutor();
+	Executor->MarkPendingKill();
+
+	return bStarted;
+}
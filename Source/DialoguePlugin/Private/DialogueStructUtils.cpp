@@ -0,0 +1,167 @@
+#include "DialogueStructUtils.h"
+#include "DialoguePlugin.h"
+
+
+namespace DialogueStructUtils
+{
+	bool IsValidStruct(const UScriptStruct* Struct, const UScriptStruct* BaseStruct)
+	{
+		return Struct && Struct->IsChildOf(BaseStruct) && Struct->GetCppStructOps() != nullptr;
+	}
+
+	void SerializeStructType(FArchive& Ar, const UScriptStruct*& Struct, const UScriptStruct* BaseStruct)
+	{
+		UObject* StructObject = const_cast<UScriptStruct*>(Struct);
+		Ar << StructObject;
+
+		if (Ar.IsLoading())
+		{
+			Struct = Cast<UScriptStruct>(StructObject);
+			if (Struct && !IsValidStruct(Struct, BaseStruct))
+			{
+				UE_LOG(LogDialogue, Warning, TEXT("%s is not derived from %s, struct data is skipped"), *Struct->GetName(), *BaseStruct->GetName());
+				Struct = nullptr;
+			}
+		}
+	}
+
+	void SerializeItems(FArchive& Ar, const UScriptStruct* Struct, uint8* Memory, int32 Num)
+	{
+		UScriptStruct* MutableStruct = const_cast<UScriptStruct*>(Struct);
+		const int32 Stride = Struct ? Struct->GetStructureSize() : 0;
+
+		if (Ar.IsLoading())
+		{
+			int32 SerialSize = 0;
+			Ar << SerialSize;
+
+			if (!Struct || !Memory)
+			{
+				Ar.Seek(Ar.Tell() + SerialSize);
+				return;
+			}
+			for (int32 Index = 0; Index < Num; Index++)
+			{
+				MutableStruct->SerializeItem(Ar, Memory + Index * Stride, nullptr);
+			}
+		}
+		else if (Ar.IsSaving())
+		{
+			const int64 SizeOffset = Ar.Tell();
+			int32 SerialSize = 0;
+			Ar << SerialSize;
+
+			const int64 StartOffset = Ar.Tell();
+			for (int32 Index = 0; Struct && Memory && Index < Num; Index++)
+			{
+				MutableStruct->SerializeItem(Ar, Memory + Index * Stride, nullptr);
+			}
+			const int64 EndOffset = Ar.Tell();
+
+			if (SizeOffset != INDEX_NONE)
+			{
+				SerialSize = (int32)(EndOffset - StartOffset);
+				Ar.Seek(SizeOffset);
+				Ar << SerialSize;
+				Ar.Seek(EndOffset);
+			}
+		}
+		else
+		{
+			// Reference collectors and memory counters
+			for (int32 Index = 0; Struct && Memory && Index < Num; Index++)
+			{
+				MutableStruct->SerializeItem(Ar, Memory + Index * Stride, nullptr);
+			}
+		}
+	}
+
+	void ExportTextItem(FString& ValueStr, const UScriptStruct* Struct, const uint8* Memory, const uint8* DefaultMemory, UObject* Parent, int32 PortFlags, UObject* ExportRootScope)
+	{
+		if (!Struct || !Memory)
+		{
+			ValueStr += TEXT("None");
+			return;
+		}
+
+		ValueStr += Struct->GetPathName();
+		Struct->ExportText(ValueStr, Memory, DefaultMemory, Parent, PortFlags, ExportRootScope);
+	}
+
+	bool ImportStructType(const TCHAR*& Buffer, const UScriptStruct*& OutStruct, const UScriptStruct* BaseStruct, FOutputDevice* ErrorText)
+	{
+		OutStruct = nullptr;
+
+		// Path ends where exported instance begins
+		const TCHAR* Start = Buffer;
+		while (*Buffer && *Buffer != TCHAR('(') && *Buffer != TCHAR(',') && *Buffer != TCHAR(')') && !FChar::IsWhitespace(*Buffer))
+		{
+			Buffer++;
+		}
+		const FString StructPath(UE_PTRDIFF_TO_INT32(Buffer - Start), Start);
+
+		if (StructPath.IsEmpty() || StructPath == TEXT("None"))
+		{
+			return true;
+		}
+
+		const UScriptStruct* Struct = FindObject<UScriptStruct>(nullptr, *StructPath);
+		if (!IsValidStruct(Struct, BaseStruct))
+		{
+			if (ErrorText)
+			{
+				ErrorText->Logf(ELogVerbosity::Warning, TEXT("%s is not native struct derived from %s"), *StructPath, *BaseStruct->GetName());
+			}
+			return false;
+		}
+
+		OutStruct = Struct;
+		return true;
+	}
+
+	bool ImportItem(const TCHAR*& Buffer, const UScriptStruct* Struct, uint8* Memory, UObject* Parent, int32 PortFlags, FOutputDevice* ErrorText)
+	{
+		if (!Struct || !Memory)
+		{
+			return true;
+		}
+
+		const TCHAR* Result = const_cast<UScriptStruct*>(Struct)->ImportText(Buffer, Memory, Parent, PortFlags, ErrorText, Struct->GetName());
+		if (!Result)
+		{
+			return false;
+		}
+
+		Buffer = Result;
+		return true;
+	}
+
+	void AddReferencedObjects(FReferenceCollector& Collector, const UScriptStruct* Struct, uint8* Memory, int32 Num)
+	{
+		// Structs without object references need no work, which is the common case for context and condition data
+		if (!Struct || !Memory || Struct->RefLink == nullptr)
+		{
+			return;
+		}
+
+		FVerySlowReferenceCollectorArchiveScope CollectorScope(Collector.GetVerySlowReferenceCollectorArchive(), nullptr);
+		const int32 Stride = Struct->GetStructureSize();
+		for (int32 Index = 0; Index < Num; Index++)
+		{
+			const_cast<UScriptStruct*>(Struct)->SerializeBin(CollectorScope.GetArchive(), Memory + Index * Stride);
+		}
+	}
+
+	uint8* Allocate(const UScriptStruct* Struct, int32 Num)
+	{
+		uint8* Memory = (uint8*)FMemory::Malloc(FMath::Max(1, Struct->GetStructureSize() * Num), Struct->GetMinAlignment());
+		Struct->InitializeStruct(Memory, Num);
+		return Memory;
+	}
+
+	void Free(const UScriptStruct* Struct, uint8* Memory, int32 Num)
+	{
+		Struct->DestroyStruct(Memory, Num);
+		FMemory::Free(Memory);
+	}
+}
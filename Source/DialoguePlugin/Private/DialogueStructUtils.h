@@ -0,0 +1,30 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Memory and serialization helpers shared by owning struct containers of contexts and conditions */
+namespace DialogueStructUtils
+{
+	/** Only native structs derived from base are accepted, vtable of virtual hooks is set by native constructor */
+	bool IsValidStruct(const UScriptStruct* Struct, const UScriptStruct* BaseStruct);
+
+	/** Struct that is not valid child of base is loaded as nullptr */
+	void SerializeStructType(FArchive& Ar, const UScriptStruct*& Struct, const UScriptStruct* BaseStruct);
+
+	/** Data is size prefixed, so loading can skip data of removed struct types */
+	void SerializeItems(FArchive& Ar, const UScriptStruct* Struct, uint8* Memory, int32 Num);
+
+	/** Struct path followed by exported instance, None when empty. Keeps data through copy/paste */
+	void ExportTextItem(FString& ValueStr, const UScriptStruct* Struct, const uint8* Memory, const uint8* DefaultMemory, UObject* Parent, int32 PortFlags, UObject* ExportRootScope);
+
+	/** Read struct path written by ExportTextItem. None is loaded as nullptr, unknown struct or struct that is not valid child of base fails */
+	bool ImportStructType(const TCHAR*& Buffer, const UScriptStruct*& OutStruct, const UScriptStruct* BaseStruct, FOutputDevice* ErrorText);
+
+	/** Read instance that follows struct path, Memory must be initialized instance of Struct */
+	bool ImportItem(const TCHAR*& Buffer, const UScriptStruct* Struct, uint8* Memory, UObject* Parent, int32 PortFlags, FOutputDevice* ErrorText);
+
+	void AddReferencedObjects(FReferenceCollector& Collector, const UScriptStruct* Struct, uint8* Memory, int32 Num);
+
+	uint8* Allocate(const UScriptStruct* Struct, int32 Num);
+	void Free(const UScriptStruct* Struct, uint8* Memory, int32 Num);
+}
@@ -0,0 +1,299 @@
+
+#include "DialogueSubsystem.h"
+#include "DialogueExecutor.h"
+#include "Engine/World.h"
+#include "Engine/Engine.h"
+
+
+UDialogueSubsystem::UDialogueSubsystem()
+{
+	MaxPooledPerClass = 32;
+	FrameBudgetMs = 1.0f;
+	LiteExecutorBatchSize = 64;
+	LiteExecutorCursor = 0;
+	RegisteredPruneNum = 64;
+}
+
+void UDialogueSubsystem::Deinitialize()
+{
+	PendingOperations.Empty();
+	LiteExecutors.Empty();
+	RegisteredExecutors.Empty();
+	EmptyPool();
+
+	Super::Deinitialize();
+}
+
+void UDialogueSubsystem::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+	UDialogueSubsystem* This = CastChecked<UDialogueSubsystem>(InThis);
+	This->LiteExecutors.AddReferencedObjects(Collector, This);
+
+	Super::AddReferencedObjects(InThis, Collector);
+}
+
+UDialogueSubsystem* UDialogueSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+	return World ? World->GetSubsystem<UDialogueSubsystem>() : nullptr;
+}
+
+void UDialogueSubsystem::Tick(float DeltaTime)
+{
+	ProcessBatch(FrameBudgetMs > 0.0f ? FrameBudgetMs / 1000.0 : 0.0);
+}
+
+ETickableTickType UDialogueSubsystem::GetTickableTickType() const
+{
+	return HasAnyFlags(RF_ClassDefaultObject) ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+bool UDialogueSubsystem::IsTickable() const
+{
+	return PendingOperations.Num() > 0 || LiteExecutors.Num() > 0;
+}
+
+UWorld* UDialogueSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+TStatId UDialogueSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDialogueSubsystem, STATGROUP_Tickables);
+}
+
+
+
+/*--------------------------------------------
+ 	Pool
+ *--------------------------------------------*/
+
+UDialogueExecutorBase* UDialogueSubsystem::AcquireExecutor(TSubclassOf<UDialogueExecutorBase> Class, UObject* Owner)
+{
+	if (!Class || !Owner || Class->HasAnyClassFlags(CLASS_Abstract))
+	{
+		return nullptr;
+	}
+
+	UDialogueExecutorBase* Executor = nullptr;
+
+	if (FDialogueExecutorPoolList* List = Pool.Find(Class))
+	{
+		while (List->Executors.Num() > 0 && Executor == nullptr)
+		{
+			Executor = List->Executors.Pop(false);
+		}
+	}
+
+	if (Executor)
+	{
+		// Outer is used as world context and owner
+		Executor->Rename(nullptr, Owner, REN_DontCreateRedirectors | REN_ForceNoResetLoaders | REN_NonTransactional | REN_DoNotDirty);
+	}
+	else
+	{
+		Executor = NewObject<UDialogueExecutorBase>(Owner, Class);
+	}
+
+	Executor->HandleCreated();
+	RegisterExecutor(Executor);
+	return Executor;
+}
+
+void UDialogueSubsystem::ReleaseExecutor(UDialogueExecutorBase* Executor)
+{
+	if (!Executor || Executor->IsPendingKill())
+	{
+		return;
+	}
+
+	UnregisterExecutor(Executor);
+	Executor->ResetExecutor();
+
+	FDialogueExecutorPoolList& List = Pool.FindOrAdd(Executor->GetClass());
+	if (List.Executors.Num() >= MaxPooledPerClass || List.Executors.Contains(Executor))
+	{
+		return;
+	}
+
+	// Pooled executor must not keep its previous owner alive
+	Executor->Rename(nullptr, this, REN_DontCreateRedirectors | REN_ForceNoResetLoaders | REN_NonTransactional | REN_DoNotDirty);
+	List.Executors.Add(Executor);
+}
+
+void UDialogueSubsystem::EmptyPool()
+{
+	Pool.Empty();
+}
+
+int32 UDialogueSubsystem::GetPooledNum(TSubclassOf<UDialogueExecutorBase> Class) const
+{
+	const FDialogueExecutorPoolList* List = Pool.Find(Class);
+	return List ? List->Executors.Num() : 0;
+}
+
+
+
+/*--------------------------------------------
+ 	Batch processing
+ *--------------------------------------------*/
+
+void UDialogueSubsystem::RegisterExecutor(UDialogueExecutorBase* Executor)
+{
+	if (!Executor)
+	{
+		return;
+	}
+
+	if (RegisteredExecutors.Num() >= RegisteredPruneNum)
+	{
+		for (auto It = RegisteredExecutors.CreateIterator(); It; ++It)
+		{
+			if (!It->IsValid())
+			{
+				It.RemoveCurrent();
+			}
+		}
+		RegisteredPruneNum = FMath::Max(64, RegisteredExecutors.Num() * 2);
+	}
+
+	RegisteredExecutors.Add(Executor);
+}
+
+void UDialogueSubsystem::UnregisterExecutor(UDialogueExecutorBase* Executor)
+{
+	RegisteredExecutors.Remove(Executor);
+
+	// Pending work of released executor must not run on its next user. Entries are kept to not break batch in progress
+	for (FDialoguePendingOperation& Operation : PendingOperations)
+	{
+		if (Operation.Executor.Get() == Executor)
+		{
+			Operation.Executor.Reset();
+		}
+	}
+}
+
+void UDialogueSubsystem::QueueTransition(UDialogueExecutor* Executor, int32 NextNodeId)
+{
+	if (Executor)
+	{
+		FDialoguePendingOperation& Operation = PendingOperations.AddDefaulted_GetRef();
+		Operation.Type = FDialoguePendingOperation::EType::Transition;
+		Operation.Executor = Executor;
+		Operation.NodeId = NextNodeId;
+		Operation.bStopOnFirst = false;
+	}
+}
+
+void UDialogueSubsystem::QueueAvailableNodesQuery(UDialogueExecutorBase* Executor, int32 NodeId, bool bStopOnFirst, TFunction<void(const TArray<int32>&)> Callback)
+{
+	if (Executor)
+	{
+		FDialoguePendingOperation& Operation = PendingOperations.AddDefaulted_GetRef();
+		Operation.Type = FDialoguePendingOperation::EType::AvailableNodes;
+		Operation.Executor = Executor;
+		Operation.NodeId = NodeId;
+		Operation.bStopOnFirst = bStopOnFirst;
+		Operation.Callback = MoveTemp(Callback);
+	}
+}
+
+void UDialogueSubsystem::QueueNodeEvents(UDialogueExecutorBase* Executor, int32 NodeId)
+{
+	if (Executor)
+	{
+		FDialoguePendingOperation& Operation = PendingOperations.AddDefaulted_GetRef();
+		Operation.Type = FDialoguePendingOperation::EType::NodeEvents;
+		Operation.Executor = Executor;
+		Operation.NodeId = NodeId;
+		Operation.bStopOnFirst = false;
+	}
+}
+
+void UDialogueSubsystem::Flush()
+{
+	// Operations may keep queuing new ones, limit passes
+	static const int32 MaxPasses = 64;
+	for (int32 Pass = 0; Pass < MaxPasses && !ProcessBatch(0.0); Pass++)
+	{
+	}
+}
+
+bool UDialogueSubsystem::ProcessBatch(double BudgetSeconds)
+{
+	const double StartTime = FPlatformTime::Seconds();
+	auto IsOverBudget = [StartTime, BudgetSeconds]()
+	{
+		return BudgetSeconds > 0.0 && FPlatformTime::Seconds() - StartTime >= BudgetSeconds;
+	};
+
+	// Queued operations first, in order. At least one is processed each frame
+	int32 ProcessedNum = 0;
+	const int32 QueuedNum = PendingOperations.Num();
+	while (ProcessedNum < QueuedNum && (ProcessedNum == 0 || !IsOverBudget()))
+	{
+		// Operation may queue more work, so it's moved out first
+		FDialoguePendingOperation Operation = MoveTemp(PendingOperations[ProcessedNum]);
+		ProcessedNum++;
+
+		UDialogueExecutorBase* Executor = Operation.Executor.Get();
+		if (!Executor)
+		{
+			continue;
+		}
+
+		switch (Operation.Type)
+		{
+		case FDialoguePendingOperation::EType::Transition:
+			if (UDialogueExecutor* StandardExecutor = Cast<UDialogueExecutor>(Executor))
+			{
+				StandardExecutor->FinishNodeExecution(Operation.NodeId);
+			}
+			break;
+		case FDialoguePendingOperation::EType::AvailableNodes:
+		{
+			TArray<int32> AvailableNodes = Executor->FindAvailableNextNodes(Operation.NodeId, Operation.bStopOnFirst);
+			if (Operation.Callback)
+			{
+				Operation.Callback(AvailableNodes);
+			}
+		}
+			break;
+		case FDialoguePendingOperation::EType::NodeEvents:
+			Executor->ExecuteNodeEvents(Operation.NodeId);
+			break;
+		}
+	}
+	PendingOperations.RemoveAt(0, ProcessedNum, false);
+
+	if (PendingOperations.Num() > 0 && IsOverBudget())
+	{
+		return false;
+	}
+
+	// Lite executors are time sliced, pass over whole list may take several frames
+	const int32 SlotNum = LiteExecutors.GetSlotNum();
+	if (SlotNum > 0)
+	{
+		UWorld* World = GetWorld();
+		const float Time = World ? World->GetTimeSeconds() : 0.0f;
+		const int32 BatchSize = FMath::Max(1, LiteExecutorBatchSize);
+
+		int32 VisitedNum = 0;
+		do
+		{
+			LiteExecutorCursor = LiteExecutors.TickRange(LiteExecutorCursor, BatchSize, Time, this);
+			VisitedNum += BatchSize;
+		} 
+		while (LiteExecutorCursor != 0 && VisitedNum < SlotNum && !IsOverBudget());
+
+		if (LiteExecutorCursor != 0)
+		{
+			return false;
+		}
+	}
+
+	return PendingOperations.Num() == 0;
+}
@@ -0,0 +1,127 @@
+
+#include "DialogueTextFormat.h"
+#include "Internationalization/TextLocalizationManager.h"
+
+
+void FDialogueFormatPlan::Build(const FText& InText)
+{
+	SourceText = InText;
+	Format = FTextFormat(InText);
+	TextRevision = FTextLocalizationManager::Get().GetTextRevision();
+
+	Arguments.Empty();
+	InvalidArguments.Empty();
+	bErrorsReported = false;
+
+	TArray<FString> ArgumentNames;
+	Format.GetFormatArgumentNames(ArgumentNames);
+
+	static const FName NAME_Executor(TEXT("Executor"));
+	static const FName NAME_Dialogue(TEXT("Dialogue"));
+	static const FName NAME_Participant(TEXT("Participant"));
+	static const FName NAME_Context(TEXT("Context"));
+
+	for (const FString& ArgumentName : ArgumentNames)
+	{
+		FString TargetPart;
+		FString FuncNamePart;
+		if (!ArgumentName.Split(TEXT("."), &TargetPart, &FuncNamePart))
+		{
+			InvalidArguments.Add(ArgumentName);
+			continue;
+		}
+
+		FDialogueFormatArgument& Argument = Arguments.AddDefaulted_GetRef();
+		Argument.Name = ArgumentName;
+		Argument.TargetName = *TargetPart;
+		Argument.FunctionName = *FuncNamePart;
+
+		if (Argument.TargetName == NAME_Executor)
+		{
+			Argument.Target = EDialogueFormatTarget::Executor;
+		}
+		else if (Argument.TargetName == NAME_Dialogue)
+		{
+			Argument.Target = EDialogueFormatTarget::Dialogue;
+		}
+		else if (Argument.TargetName == NAME_Participant)
+		{
+			Argument.Target = EDialogueFormatTarget::Participant;
+		}
+		else if (Argument.TargetName == NAME_Context)
+		{
+			Argument.Target = EDialogueFormatTarget::Context;
+		}
+		else
+		{
+			Argument.Target = EDialogueFormatTarget::ParticipantKey;
+		}
+	}
+}
+
+bool FDialogueFormatPlan::IsBuiltFor(const FText& InText) const
+{
+	return SourceText.IdenticalTo(InText) && TextRevision == FTextLocalizationManager::Get().GetTextRevision();
+}
+
+FDialogueFormatBinding FDialogueFormatPlan::MakeBinding(UClass* Class, FName FunctionName, bool& bOutHasInput, int32& OutReturnNum)
+{
+	FDialogueFormatBinding Binding;
+	Binding.Class = Class;
+
+	bOutHasInput = false;
+	OutReturnNum = 0;
+
+	UFunction* Func = Class ? Class->FindFunctionByName(FunctionName) : nullptr;
+	Binding.Function = Func;
+	if (!Func)
+	{
+		return Binding;
+	}
+
+	EDialogueFormatReturn ReturnType = EDialogueFormatReturn::None;
+	for (TFieldIterator<FProperty> It(Func); It; ++It)
+	{
+		FProperty* Prop = *It;
+		if (Prop->HasAnyPropertyFlags(CPF_Parm) && !Prop->HasAnyPropertyFlags(CPF_OutParm))
+		{
+			bOutHasInput = true;
+			break;
+		}
+		else if (Prop->HasAllPropertyFlags(CPF_Parm | CPF_OutParm))
+		{
+			OutReturnNum++;
+
+			if (Prop->IsA<FStrProperty>())
+			{
+				ReturnType = EDialogueFormatReturn::String;
+			}
+			else if (Prop->IsA<FTextProperty>())
+			{
+				ReturnType = EDialogueFormatReturn::Text;
+			}
+			else if (Prop->IsA<FNameProperty>())
+			{
+				ReturnType = EDialogueFormatReturn::Name;
+			}
+			else if (Prop->IsA<FFloatProperty>())
+			{
+				ReturnType = EDialogueFormatReturn::Float;
+			}
+			else if (Prop->IsA<FIntProperty>())
+			{
+				ReturnType = EDialogueFormatReturn::Integer;
+			}
+			else
+			{
+				ReturnType = EDialogueFormatReturn::None;
+			}
+		}
+	}
+
+	if (!bOutHasInput && OutReturnNum == 1)
+	{
+		Binding.ReturnType = ReturnType;
+	}
+	return Binding;
+}
@@ -0,0 +1,564 @@
+#include "DialogueTrace.h"
+
+#if DIALOGUE_TRACE_ENABLED
+
+#include "DialoguePlugin.h"
+#include "DialogueExecutor.h"
+#include "Dialogue.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/Event.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Algo/StableSort.h"
+#include "Templates/Atomic.h"
+
+
+static int32 GDialogueTraceEnabled = 0;
+
+static void OnDialogueTraceChanged(IConsoleVariable* Variable)
+{
+	if (GDialogueTraceEnabled != 0)
+	{
+		FDialogueTrace::Start();
+	}
+	else
+	{
+		FDialogueTrace::Stop();
+	}
+}
+
+static FAutoConsoleVariableRef CVarDialogueTrace(
+	TEXT("dialogue.Trace"),
+	GDialogueTraceEnabled,
+	TEXT("Write dialogue execution trace to binary file. 0 - disabled, 1 - enabled"),
+	FConsoleVariableDelegate::CreateStatic(&OnDialogueTraceChanged),
+	ECVF_Default);
+
+static TAutoConsoleVariable<FString> CVarDialogueTraceFile(
+	TEXT("dialogue.TraceFile"),
+	TEXT(""),
+	TEXT("Trace file path. Empty path creates timestamped file in Saved/Profiling/Dialogue"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarDialogueTraceFlushInterval(
+	TEXT("dialogue.TraceFlushInterval"),
+	50,
+	TEXT("Milliseconds between trace writer flushes"),
+	ECVF_Default);
+
+
+/**
+ * Bounded multi-producer queue, consumed by writer thread only
+ * Each slot sequence tells whether it's free for position or holds committed record
+ * Executor descriptions are rare and variable sized, they go to locked list instead
+ */
+class FDialogueTraceQueue
+{
+	struct FSlot
+	{
+		TAtomic<uint64> Sequence;
+		FDialogueTraceRecord Record;
+	};
+
+	static const uint64 Capacity = 1 << 16;
+	static const uint64 Mask = Capacity - 1;
+
+	TUniquePtr<FSlot[]> Slots;
+
+	TAtomic<uint64> EnqueuePos;
+	uint64 DequeuePos;
+
+	TAtomic<uint32> DroppedNum;
+
+	FCriticalSection ExecutionsLock;
+	TArray<FDialogueTraceExecution> PendingExecutions;
+
+public:
+	FDialogueTraceQueue()
+		: Slots(new FSlot[Capacity])
+		, EnqueuePos(0)
+		, DequeuePos(0)
+		, DroppedNum(0)
+	{
+		for (uint64 Index = 0; Index < Capacity; Index++)
+		{
+			Slots[Index].Sequence = Index;
+		}
+	}
+
+	bool Enqueue(const FDialogueTraceRecord& Record)
+	{
+		uint64 Pos = EnqueuePos.Load(EMemoryOrder::Relaxed);
+		FSlot* Slot = nullptr;
+		for (;;)
+		{
+			Slot = &Slots[Pos & Mask];
+			const int64 Diff = (int64)(Slot->Sequence.Load() - Pos);
+			if (Diff == 0)
+			{
+				if (EnqueuePos.CompareExchange(Pos, Pos + 1))
+				{
+					break;
+				}
+			}
+			else if (Diff < 0)
+			{
+				DroppedNum++;
+				return false;
+			}
+			else
+			{
+				Pos = EnqueuePos.Load(EMemoryOrder::Relaxed);
+			}
+		}
+
+		Slot->Record = Record;
+		Slot->Sequence = Pos + 1;
+		return true;
+	}
+
+	/** Consumer side, must be called from single thread */
+	bool Dequeue(FDialogueTraceRecord& OutRecord)
+	{
+		FSlot& Slot = Slots[DequeuePos & Mask];
+		if (Slot.Sequence.Load() != DequeuePos + 1)
+		{
+			return false;
+		}
+
+		OutRecord = Slot.Record;
+		Slot.Sequence = DequeuePos + Capacity;
+		DequeuePos++;
+		return true;
+	}
+
+	uint32 ConsumeDroppedNum()
+	{
+		return DroppedNum.Exchange(0);
+	}
+
+	void AddExecution(FDialogueTraceExecution&& Execution)
+	{
+		FScopeLock Lock(&ExecutionsLock);
+		PendingExecutions.Add(MoveTemp(Execution));
+	}
+
+	TArray<FDialogueTraceExecution> ConsumeExecutions()
+	{
+		FScopeLock Lock(&ExecutionsLock);
+		TArray<FDialogueTraceExecution> Executions = MoveTemp(PendingExecutions);
+		PendingExecutions.Reset();
+		return Executions;
+	}
+};
+
+
+class FDialogueTraceWriter : public FRunnable
+{
+public:
+	FDialogueTraceWriter(FDialogueTraceQueue& InQueue, FArchive* InFile, const FString& InFilePath)
+		: Queue(InQueue)
+		, File(InFile)
+		, FilePath(InFilePath)
+		, bStopRequested(false)
+	{
+		WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+
+		uint32 HeaderMagic = FDialogueTraceFile::Magic;
+		uint32 HeaderVersion = FDialogueTraceFile::Version;
+		double SecondsPerCycle = FPlatformTime::GetSecondsPerCycle64();
+		*File << HeaderMagic << HeaderVersion << SecondsPerCycle;
+
+		Thread = FRunnableThread::Create(this, TEXT("DialogueTraceWriter"), 0, TPri_BelowNormal);
+	}
+
+	virtual ~FDialogueTraceWriter()
+	{
+		bStopRequested = true;
+		WakeEvent->Trigger();
+
+		if (Thread)
+		{
+			Thread->WaitForCompletion();
+			delete Thread;
+			Thread = nullptr;
+		}
+
+		// Producers are stopped at this point, write what's left
+		Flush();
+
+		const uint32 DroppedNum = Queue.ConsumeDroppedNum();
+		if (DroppedNum > 0)
+		{
+			UE_LOG(LogDialogue, Warning, TEXT("Dialogue trace dropped %u records, lower dialogue.TraceFlushInterval"), DroppedNum);
+		}
+
+		File->Close();
+		delete File;
+
+		FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+
+		UE_LOG(LogDialogue, Log, TEXT("Dialogue trace written to %s"), *FilePath);
+	}
+
+	virtual uint32 Run() override
+	{
+		while (!bStopRequested)
+		{
+			WakeEvent->Wait(FMath::Max(1, CVarDialogueTraceFlushInterval.GetValueOnAnyThread()));
+			Flush();
+		}
+		return 0;
+	}
+
+	const FString& GetFilePath() const { return FilePath; }
+
+private:
+	void Flush()
+	{
+		TArray<FDialogueTraceExecution> Executions = Queue.ConsumeExecutions();
+
+		if (Executions.Num() > 0)
+		{
+			uint8 ChunkType = FDialogueTraceFile::Chunk_Executions;
+			uint32 ChunkNum = Executions.Num();
+			*File << ChunkType << ChunkNum;
+			for (FDialogueTraceExecution& Execution : Executions)
+			{
+				*File << Execution;
+			}
+		}
+
+		Records.Reset();
+		FDialogueTraceRecord Record;
+		while (Queue.Dequeue(Record))
+		{
+			Records.Add(Record);
+		}
+
+		if (Records.Num() > 0)
+		{
+			uint8 ChunkType = FDialogueTraceFile::Chunk_Records;
+			uint32 ChunkNum = Records.Num();
+			*File << ChunkType << ChunkNum;
+			for (FDialogueTraceRecord& Each : Records)
+			{
+				*File << Each;
+			}
+		}
+
+		File->Flush();
+	}
+
+private:
+	FDialogueTraceQueue& Queue;
+	FArchive* File;
+	FString FilePath;
+
+	FRunnableThread* Thread;
+	FEvent* WakeEvent;
+	TAtomic<bool> bStopRequested;
+
+	/** Writer thread scratch */
+	TArray<FDialogueTraceRecord> Records;
+};
+
+
+/**
+ * Producers only touch queue, which is created before first enable and never freed
+ * Producer that saw trace enabled just before Stop pushes into queue after writer is gone, Start discards such leftovers
+ * Writer is only accessed from game thread
+ */
+static FDialogueTraceQueue* GDialogueTraceQueue = nullptr;
+static FDialogueTraceWriter* GDialogueTraceWriter = nullptr;
+
+TAtomic<bool> FDialogueTrace::bEnabled(false);
+
+bool FDialogueTrace::Start(const FString& FilePath)
+{
+	check(IsInGameThread());
+
+	if (GDialogueTraceWriter)
+	{
+		return true;
+	}
+
+	FString TracePath = FilePath.IsEmpty() ? CVarDialogueTraceFile.GetValueOnGameThread() : FilePath;
+	if (TracePath.IsEmpty())
+	{
+		TracePath = FPaths::ProfilingDir() / TEXT("Dialogue") / FString::Printf(TEXT("DialogueTrace_%s.dlgtrace"), *FDateTime::Now().ToString());
+	}
+
+	FArchive* File = IFileManager::Get().CreateFileWriter(*TracePath);
+	if (!File)
+	{
+		UE_LOG(LogDialogue, Error, TEXT("Failed to create dialogue trace file %s"), *TracePath);
+		return false;
+	}
+
+	if (!GDialogueTraceQueue)
+	{
+		GDialogueTraceQueue = new FDialogueTraceQueue();
+	}
+	else
+	{
+		// Discard records pushed by late producers after previous trace stopped
+		FDialogueTraceRecord StaleRecord;
+		while (GDialogueTraceQueue->Dequeue(StaleRecord))
+		{ }
+		GDialogueTraceQueue->ConsumeDroppedNum();
+		GDialogueTraceQueue->ConsumeExecutions();
+	}
+
+	GDialogueTraceWriter = new FDialogueTraceWriter(*GDialogueTraceQueue, File, TracePath);
+	bEnabled = true;
+
+	UE_LOG(LogDialogue, Log, TEXT("Dialogue trace started: %s"), *TracePath);
+	return true;
+}
+
+void FDialogueTrace::Stop()
+{
+	check(IsInGameThread());
+
+	bEnabled = false;
+
+	if (GDialogueTraceWriter)
+	{
+		delete GDialogueTraceWriter;
+		GDialogueTraceWriter = nullptr;
+	}
+}
+
+FString FDialogueTrace::GetFilePath()
+{
+	check(IsInGameThread());
+
+	return GDialogueTraceWriter ? GDialogueTraceWriter->GetFilePath() : FString();
+}
+
+void FDialogueTrace::Record(EDialogueTraceEvent Event, const UDialogueExecutorBase* Executor, int32 NodeId, uint8 Value, uint64 StartCycles)
+{
+	if (!bEnabled || !GDialogueTraceQueue)
+	{
+		return;
+	}
+
+	FDialogueTraceRecord Record;
+	Record.Cycles = FPlatformTime::Cycles64();
+	Record.Duration = StartCycles > 0 ? (uint32)FMath::Min<uint64>(Record.Cycles - StartCycles, MAX_uint32) : 0;
+	Record.ExecutorId = Executor ? Executor->GetUniqueID() : 0;
+	Record.NodeId = NodeId;
+	Record.Event = Event;
+	Record.Value = Value;
+
+	GDialogueTraceQueue->Enqueue(Record);
+}
+
+void FDialogueTrace::RecordExecutionBegin(const UDialogueExecutorBase* Executor, int32 NodeId, FName EntryPoint)
+{
+	RecordExecution(EDialogueTraceEvent::ExecutionBegin, Executor, NodeId, EntryPoint);
+}
+
+void FDialogueTrace::RecordDialogueSwitch(const UDialogueExecutorBase* Executor, int32 NodeId, FName EntryPoint)
+{
+	RecordExecution(EDialogueTraceEvent::DialogueSwitch, Executor, NodeId, EntryPoint);
+}
+
+void FDialogueTrace::RecordExecution(EDialogueTraceEvent Event, const UDialogueExecutorBase* Executor, int32 NodeId, FName EntryPoint)
+{
+	if (!bEnabled || !GDialogueTraceQueue || !Executor)
+	{
+		return;
+	}
+
+	FDialogueTraceRecord Record;
+	Record.Cycles = FPlatformTime::Cycles64();
+	Record.ExecutorId = Executor->GetUniqueID();
+	Record.NodeId = NodeId;
+	Record.Event = Event;
+
+	FDialogueTraceExecution Execution;
+	Execution.ExecutorId = Record.ExecutorId;
+	Execution.Cycles = Record.Cycles;
+	Execution.ExecutorName = Executor->GetPathName();
+	Execution.DialoguePath = Executor->GetDialogue() ? Executor->GetDialogue()->GetPathName() : FString();
+	Execution.EntryPoint = EntryPoint;
+
+	GDialogueTraceQueue->AddExecution(MoveTemp(Execution));
+	GDialogueTraceQueue->Enqueue(Record);
+}
+
+
+/*--------------------------------------------
+ 	Reader
+ *--------------------------------------------*/
+
+bool FDialogueTraceSession::HasDialogue(const FString& DialoguePath) const
+{
+	return Execution.DialoguePath == DialoguePath
+		|| DialogueSwitches.ContainsByPredicate([&DialoguePath](const FDialogueTraceExecution& Switch) { return Switch.DialoguePath == DialoguePath; });
+}
+
+uint64 FDialogueTraceSession::GetConditionCycles() const
+{
+	uint64 Total = 0;
+	for (const FDialogueTraceRecord& Record : Records)
+	{
+		if (Record.Event == EDialogueTraceEvent::Condition)
+		{
+			Total += Record.Duration;
+		}
+	}
+	return Total;
+}
+
+bool FDialogueTraceFile::Load(const FString& FilePath, FString* OutError)
+{
+	auto Fail = [OutError](const FString& Error)
+	{
+		if (OutError)
+		{
+			*OutError = Error;
+		}
+		return false;
+	};
+
+	SecondsPerCycle = 0.0;
+	Sessions.Reset();
+
+	TUniquePtr<FArchive> File(IFileManager::Get().CreateFileReader(*FilePath));
+	if (!File)
+	{
+		return Fail(FString::Printf(TEXT("Failed to open %s"), *FilePath));
+	}
+
+	uint32 FileMagic = 0;
+	uint32 FileVersion = 0;
+	*File << FileMagic << FileVersion;
+	if (FileMagic != Magic)
+	{
+		return Fail(TEXT("Not a dialogue trace file"));
+	}
+	if (FileVersion < MinVersion || FileVersion > Version)
+	{
+		return Fail(FString::Printf(TEXT("Unsupported trace version %u"), FileVersion));
+	}
+	*File << SecondsPerCycle;
+
+	TArray<FDialogueTraceRecord> Records;
+	TMap<TPair<uint32, uint64>, FDialogueTraceExecution> Executions;
+
+	// Chunks are appended by writer thread, file may be truncated if process was terminated
+	bool bTruncated = false;
+	while (!File->AtEnd() && !bTruncated)
+	{
+		uint8 ChunkType = 0;
+		uint32 ChunkNum = 0;
+		*File << ChunkType << ChunkNum;
+
+		// Count is not trusted, chunk that does not fit in rest of file is cut off or garbage
+		const int64 RemainingSize = File->TotalSize() - File->Tell();
+		if (File->IsError())
+		{
+			bTruncated = true;
+		}
+		else if (ChunkType == Chunk_Records)
+		{
+			if ((int64)ChunkNum > RemainingSize / FDialogueTraceRecord::SerializedSize)
+			{
+				bTruncated = true;
+				break;
+			}
+
+			Records.Reserve(Records.Num() + ChunkNum);
+			for (uint32 Index = 0; Index < ChunkNum; Index++)
+			{
+				FDialogueTraceRecord Record;
+				*File << Record;
+				if (File->IsError())
+				{
+					bTruncated = true;
+					break;
+				}
+				Records.Add(Record);
+			}
+		}
+		else if (ChunkType == Chunk_Executions)
+		{
+			if ((int64)ChunkNum > RemainingSize / FDialogueTraceExecution::MinSerializedSize)
+			{
+				bTruncated = true;
+				break;
+			}
+
+			for (uint32 Index = 0; Index < ChunkNum; Index++)
+			{
+				FDialogueTraceExecution Execution;
+				*File << Execution;
+				if (File->IsError())
+				{
+					bTruncated = true;
+					break;
+				}
+				Executions.Add(TPair<uint32, uint64>(Execution.ExecutorId, Execution.Cycles), MoveTemp(Execution));
+			}
+		}
+		else
+		{
+			return Fail(FString::Printf(TEXT("Unknown chunk type %u"), ChunkType));
+		}
+	}
+
+	if (bTruncated)
+	{
+		UE_LOG(LogDialogue, Warning, TEXT("Dialogue trace %s is truncated, loaded %d records"), *FilePath, Records.Num());
+	}
+
+	// Multiple producers may interleave
+	Algo::StableSortBy(Records, &FDialogueTraceRecord::Cycles);
+
+	TMap<uint32, int32> OpenSessions;
+	for (const FDialogueTraceRecord& Record : Records)
+	{
+		int32* SessionIndexPtr = OpenSessions.Find(Record.ExecutorId);
+
+		if (Record.Event == EDialogueTraceEvent::ExecutionBegin || !SessionIndexPtr)
+		{
+			FDialogueTraceSession& Session = Sessions.AddDefaulted_GetRef();
+			if (const FDialogueTraceExecution* Execution = Executions.Find(TPair<uint32, uint64>(Record.ExecutorId, Record.Cycles)))
+			{
+				Session.Execution = *Execution;
+			}
+			else
+			{
+				Session.Execution.ExecutorId = Record.ExecutorId;
+				Session.Execution.Cycles = Record.Cycles;
+			}
+
+			SessionIndexPtr = &OpenSessions.Add(Record.ExecutorId, Sessions.Num() - 1);
+		}
+
+		FDialogueTraceSession& Session = Sessions[*SessionIndexPtr];
+		Session.Records.Add(Record);
+
+		if (Record.Event == EDialogueTraceEvent::DialogueSwitch)
+		{
+			// Switch without description keeps slot so records and switches stay in step
+			const FDialogueTraceExecution* Switch = Executions.Find(TPair<uint32, uint64>(Record.ExecutorId, Record.Cycles));
+			Session.DialogueSwitches.Add(Switch ? *Switch : FDialogueTraceExecution());
+		}
+
+		if (Record.Event == EDialogueTraceEvent::ExecutionEnd)
+		{
+			OpenSessions.Remove(Record.ExecutorId);
+		}
+	}
+
+	return true;
+}
+
+#endif // DIALOGUE_TRACE_ENABLED
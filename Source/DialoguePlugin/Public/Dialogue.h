@@ -5,12 +5,16 @@
 #include "CoreMinimal.h"
 #include "Engine/DataAsset.h"
 #include "DialogueParticipantInterface.h"
+#include "DialogueCondition.h"
+#include "DialogueTextFormat.h"
+#include "DialogueContext.h"
 #include "Dialogue.generated.h"
 
 class UDialogueCondition;
 class UDialogueNodeContext;
 class UDialogueEvent;
 class UDialogueAssetContext;
+class UDialogue;
 
 
 
@@ -49,6 +53,41 @@ struct DIALOGUEPLUGIN_API FDialogueParticipant
 
 
 
+/**
+ * Continues execution at entry of another dialogue
+ * Allows splitting large dialogue into chunks that are streamed in only when execution gets close
+ */
+USTRUCT(BlueprintType)
+struct DIALOGUEPLUGIN_API FDialogueJump
+{
+	GENERATED_BODY()
+
+	/** Chunk to continue in. Loaded asynchronously once jump node is within executor prefetch depth */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TSoftObjectPtr<UDialogue> Dialogue;
+
+	/** Entry point of target dialogue */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FName Entry;
+
+	/** Jump nodes entered through jumps are followed up to this number in a row, guards against cycles */
+	static constexpr int32 MaxChainLength = 16;
+
+public:
+	bool IsSet() const { return !Dialogue.IsNull(); }
+
+	/** Target dialogue is in memory, Resolve won't block */
+	bool IsTargetLoaded() const { return Dialogue.Get() != nullptr; }
+
+	/**
+	 * Get target dialogue and its entry node
+	 * Target is loaded synchronously when prefetch didn't finish in time
+	 */
+	bool Resolve(UDialogue*& OutDialogue, int32& OutNodeId) const;
+};
+
+
+
 /**  */
 USTRUCT(BlueprintType)
 struct DIALOGUEPLUGIN_API FDialogueNode
@@ -59,6 +98,7 @@ struct DIALOGUEPLUGIN_API FDialogueNode
 	UPROPERTY(BlueprintReadOnly)
 	int32 NodeID;
 
+	/** Child NodeIds in execution order. Stripped from runtime node table, which stores children as index ranges */
 	UPROPERTY(BlueprintReadWrite);
 	TArray<int32> Children;
 
@@ -71,29 +111,44 @@ struct DIALOGUEPLUGIN_API FDialogueNode
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	FDialogueParticipant Participant;
 	
+	/** Soft so voice lines are loaded only when node is close, see FDialoguePrefetcher */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	class USoundBase* Sound;
+	TSoftObjectPtr<class USoundBase> Sound;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	class UDialogueWave* DialogueWave;
+	TSoftObjectPtr<class UDialogueWave> DialogueWave;
 		
 	/** Additional node info */
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Instanced)
 	UDialogueNodeContext* Context;
 
+	/** Struct alternative of Context, set from UDialogue::NodeContextStruct. Packed into node table at runtime */
+	UPROPERTY(EditAnywhere)
+	FDialogueInstancedContext ContextStruct;
+
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Instanced)
 	UDialogueCondition* Condition;
 
+	/** Joined to Condition by AND. Moved into compiled condition of node table at runtime */
+	UPROPERTY(EditAnywhere)
+	TArray<FDialogueInstancedCondition> ConditionStructs;
+
+	/** Library conditions joined to Condition by AND */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<FDialogueConditionHandle> SharedConditions;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Instanced)
 	TArray<UDialogueEvent*> Events;
 
+	/** When set, entering node continues at target entry instead. Node is not executed and its children are ignored */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FDialogueJump Jump;
+
 public:
 
 	FDialogueNode()
 		: NodeID(-1)
-		, Sound(nullptr)
-		, DialogueWave(nullptr)
 		, Context(nullptr)
 		, Condition(nullptr)
 	{ }
@@ -111,19 +166,257 @@ public:
 	}
 
 	void SetContextClass(UDialogue* Outer, TSubclassOf<UDialogueNodeContext> NewClass);
+	void SetContextStruct(const UScriptStruct* NewStruct);
 	void FixContext();
 	bool IsEmpty() const
 	{
 		return Text.IsEmpty() &&
 			Participant.Name == NAME_None &&
 			Participant.Object == nullptr &&
-			Sound == nullptr &&
-			DialogueWave == nullptr &&
-			Context == nullptr;
+			Sound.IsNull() &&
+			DialogueWave.IsNull() &&
+			Context == nullptr &&
+			!ContextStruct.IsValid();
+	}
+};
+
+
+/**
+ * Dense runtime representation of dialogue nodes
+ * Built from editor node map on load and cook, cooked packages contain only this form
+ * Children are stored contiguously: children of node at Index are ChildIndices[ChildOffsets[Index] .. ChildOffsets[Index + 1])
+ */
+USTRUCT()
+struct DIALOGUEPLUGIN_API FDialogueNodeTable
+{
+	GENERATED_BODY()
+
+	/** Node data sorted by NodeId. Children arrays are empty */
+	UPROPERTY()
+	TArray<FDialogueNode> Nodes;
+
+	/** Nodes.Num() + 1 entries */
+	UPROPERTY()
+	TArray<int32> ChildOffsets;
+
+	/** Dense indices of children */
+	UPROPERTY()
+	TArray<int32> ChildIndices;
+
+	/** NodeId to dense index. NodeIds are kept tight by FDialogueEditorStruct, holes are INDEX_NONE */
+	UPROPERTY()
+	TArray<int32> IdToIndex;
+
+	/** Compiled node conditions, parallel to Nodes */
+	UPROPERTY()
+	TArray<FDialogueConditionProgram> Conditions;
+
+	/** Blackboard keys of all node conditions, executors watch them */
+	UPROPERTY()
+	TArray<FName> BlackboardKeys;
+
+	/** Unique participant keys used by nodes. Executors resolve each key once into slot with same index */
+	UPROPERTY()
+	TArray<FName> ParticipantKeys;
+
+	/** Slot in ParticipantKeys of each node, parallel to Nodes. INDEX_NONE when node participant has no key */
+	UPROPERTY()
+	TArray<int32> ParticipantSlots;
+
+	/** Struct contexts of all nodes when every node has context of same struct type, inline node contexts are moved here */
+	UPROPERTY()
+	FDialogueContextArray ContextStructs;
+
+	/** Dense indices of nodes whose object or struct context has executor state, only these are visited by state snapshots */
+	UPROPERTY()
+	TArray<int32> StatefulContextIndices;
+
+	/** Changes on each Build, slots resolved against older revision are stale */
+	uint32 Revision = 0;
+
+public:
+	void Build(const TMap<int32, FDialogueNode>& NodeMap);
+	void Reset();
+
+	int32 Num() const { return Nodes.Num(); }
+
+	FORCEINLINE int32 FindIndex(int32 NodeId) const
+	{
+		return IdToIndex.IsValidIndex(NodeId) ? IdToIndex[NodeId] : INDEX_NONE;
+	}
+
+	FORCEINLINE const FDialogueNode* FindNode(int32 NodeId) const
+	{
+		const int32 Index = FindIndex(NodeId);
+		return Index != INDEX_NONE ? &Nodes[Index] : nullptr;
+	}
+
+	FORCEINLINE TArrayView<const int32> GetChildIndices(int32 Index) const
+	{
+		return MakeArrayView(ChildIndices.GetData() + ChildOffsets[Index], ChildOffsets[Index + 1] - ChildOffsets[Index]);
+	}
+
+	FORCEINLINE int32 GetChildNum(int32 Index) const
+	{
+		return ChildOffsets[Index + 1] - ChildOffsets[Index];
+	}
+
+	FORCEINLINE int32 GetParticipantSlot(int32 Index) const
+	{
+		return ParticipantSlots.IsValidIndex(Index) ? ParticipantSlots[Index] : INDEX_NONE;
+	}
+
+	FORCEINLINE int32 FindParticipantSlot(FName Key) const
+	{
+		return Key.IsNone() ? INDEX_NONE : ParticipantKeys.IndexOfByKey(Key);
+	}
+
+	/** Struct context of node, packed or inline. nullptr if node has none */
+	FORCEINLINE const FDialogueNodeContextStruct* GetContextStruct(int32 Index) const
+	{
+		return ContextStructs.IsEmpty() ? Nodes[Index].ContextStruct.Get() : ContextStructs.Get(Index);
+	}
+
+	/** Run compiled node condition. Node without condition is always allowed */
+	FORCEINLINE bool CheckCondition(int32 Index, UObject* WorldContext, FDialogueConditionCache* Cache = nullptr) const
+	{
+		return Conditions[Index].Execute(WorldContext, Cache);
+	}
+
+	/** 
+	 * Traversal rule shared by all executors: context must allow entry and condition must be met
+	 * @param	FromNodeId	Node transition is made from, passed to context
+	 */
+	bool CanEnterNode(int32 Index, int32 FromNodeId, UObject* WorldContext, FDialogueConditionCache* Cache = nullptr) const;
+
+	/** Returns dense index of first child that can be entered, INDEX_NONE if there are none */
+	int32 FindFirstAvailableChild(int32 Index, UObject* WorldContext, FDialogueConditionCache* Cache = nullptr) const;
+
+	/** Copy node with restored Children ids */
+	FDialogueNode MakeNode(int32 Index) const;
+
+	void GetChildrenIds(int32 Index, TArray<int32>& OutIds) const;
+};
+
+
+
+/**
+ * Non-owning const view of a node in runtime node table
+ * Avoids node copies, valid until dialogue node table is rebuilt
+ */
+struct DIALOGUEPLUGIN_API FDialogueNodeView
+{
+private:
+	const FDialogueNodeTable* Table;
+	int32 Index;
+
+public:
+	FDialogueNodeView()
+		: Table(nullptr)
+		, Index(INDEX_NONE)
+	{ }
+
+	FDialogueNodeView(const FDialogueNodeTable& InTable, int32 InIndex)
+		: Table(&InTable)
+		, Index(InTable.Nodes.IsValidIndex(InIndex) ? InIndex : INDEX_NONE)
+	{ }
+
+	FORCEINLINE bool IsValid() const { return Table != nullptr && Index != INDEX_NONE; }
+	FORCEINLINE explicit operator bool() const { return IsValid(); }
+
+	FORCEINLINE const FDialogueNode& Get() const { check(IsValid()); return Table->Nodes[Index]; }
+	FORCEINLINE const FDialogueNode& operator*() const { return Get(); }
+	FORCEINLINE const FDialogueNode* operator->() const { return &Get(); }
+
+	/** Dense index in node table */
+	FORCEINLINE int32 GetIndex() const { return Index; }
+	FORCEINLINE int32 GetNodeId() const { return IsValid() ? Get().NodeID : INDEX_NONE; }
+
+	FORCEINLINE int32 GetChildrenNum() const { return IsValid() ? Table->GetChildNum(Index) : 0; }
+
+	/** Returns invalid view if not found */
+	FORCEINLINE FDialogueNodeView GetChild(int32 ChildIndex) const
+	{
+		if (IsValid())
+		{
+			TArrayView<const int32> Children = Table->GetChildIndices(Index);
+			if (Children.IsValidIndex(ChildIndex))
+			{
+				return FDialogueNodeView(*Table, Children[ChildIndex]);
+			}
+		}
+		return FDialogueNodeView();
+	}
+
+	/** Range-for support over children: for (FDialogueNodeView Child : View.GetChildren()) */
+	struct FChildRange
+	{
+		struct FIterator
+		{
+			const FDialogueNodeTable* Table;
+			const int32* Ptr;
+
+			FORCEINLINE FDialogueNodeView operator*() const { return FDialogueNodeView(*Table, *Ptr); }
+			FORCEINLINE FIterator& operator++() { ++Ptr; return *this; }
+			FORCEINLINE bool operator!=(const FIterator& Other) const { return Ptr != Other.Ptr; }
+		};
+
+		const FDialogueNodeTable* Table;
+		TArrayView<const int32> Indices;
+
+		FORCEINLINE FIterator begin() const { return FIterator{ Table, Indices.GetData() }; }
+		FORCEINLINE FIterator end() const { return FIterator{ Table, Indices.GetData() + Indices.Num() }; }
+		FORCEINLINE int32 Num() const { return Indices.Num(); }
+	};
+
+	FORCEINLINE FChildRange GetChildren() const
+	{
+		return IsValid() ? FChildRange{ Table, Table->GetChildIndices(Index) } : FChildRange{ nullptr, TArrayView<const int32>() };
 	}
 };
 
 
+
+/** Lightweight blueprint reference to dialogue node, use instead of copying FDialogueNode */
+USTRUCT(BlueprintType)
+struct DIALOGUEPLUGIN_API FDialogueNodeHandle
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = Dialogue)
+	UDialogue* Dialogue;
+
+	UPROPERTY(BlueprintReadOnly, Category = Dialogue)
+	int32 NodeId;
+
+	FDialogueNodeHandle()
+		: Dialogue(nullptr)
+		, NodeId(INDEX_NONE)
+	{ }
+
+	FDialogueNodeHandle(UDialogue* InDialogue, int32 InNodeId)
+		: Dialogue(InDialogue)
+		, NodeId(InNodeId)
+	{ }
+
+	/** Resolve to view. Lookup is a single array access */
+	FDialogueNodeView GetView() const;
+
+	bool IsValid() const { return GetView().IsValid(); }
+
+	FORCEINLINE bool operator==(const FDialogueNodeHandle& Other) const
+	{
+		return Dialogue == Other.Dialogue && NodeId == Other.NodeId;
+	}
+
+	FORCEINLINE friend uint32 GetTypeHash(const FDialogueNodeHandle& Handle)
+	{
+		return HashCombine(::GetTypeHash(Handle.Dialogue), ::GetTypeHash(Handle.NodeId));
+	}
+};
+
+
+
 /**
  * Basic dialogue data asset
  */
@@ -144,9 +437,18 @@ private:
 	UPROPERTY()
 	TMap<FName, int32> EntryPoints;
 
+#if WITH_EDITORONLY_DATA
 	/** NodeId-Node map. Using array is possible, but then node removal will become extremely slow */
 	UPROPERTY()
 	TMap<int32, FDialogueNode> Nodes;
+#endif // WITH_EDITORONLY_DATA
+
+	/** Runtime form of Nodes. Rebuilt from map in editor, serialized only to cooked packages */
+	UPROPERTY(Transient)
+	FDialogueNodeTable NodeTable;
+
+	/** Text format plans by NodeId, shared by all executors. Few texts per node are kept */
+	mutable TMap<int32, TArray<TSharedRef<FDialogueFormatPlan>, TInlineAllocator<1>>> FormatPlans;
 
 	/** Collected unique participants from all nodes */
 	UPROPERTY(VisibleAnywhere, Category = Dialogue)
@@ -161,11 +463,29 @@ public:
 	UPROPERTY(EditAnywhere, Category = Dialogue)
 	TSubclassOf<UDialogueNodeContext> NodeContextClass;
 
+	/** 
+	 * Struct context of every node when bUniformContext is set
+	 * Alternative to NodeContextClass without UObject per node, contexts are packed into one allocation at runtime
+	 */
+	UPROPERTY(EditAnywhere, Category = Dialogue, meta = (MetaStruct = "DialogueNodeContextStruct"))
+	UScriptStruct* NodeContextStruct;
+
 public:
 	UDialogue();
 
+	virtual void Serialize(FArchive& Ar) override;
+	virtual void PostLoad() override;
+
+	/** 
+	 * Cooked dialogue is clustered with its subobjects on load, GC then checks whole tree at once
+	 * Refused when dialogue references runtime created objects, see ValidateCluster
+	 */
+	virtual bool CanBeClusterRoot() const override;
+
 #if WITH_EDITOR
 	void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+	virtual void PostEditUndo() override;
+	virtual void PostDuplicate(bool bDuplicateForPIE) override;
 
 	/** Ensure all node properties are correct */
 	virtual void FixNode(FDialogueNode& Node);
@@ -173,10 +493,34 @@ public:
 	virtual void PostRebuild() { }
 #endif //WITH_EDITOR
 
+#if WITH_EDITORONLY_DATA
+	/**
+	 * Rebuild runtime node table from node map
+	 * Called at edit boundaries only, views and node pointers taken before are invalidated
+	 */
+	void CompileNodes();
+#endif // WITH_EDITORONLY_DATA
+
+private:
+	/** References to transient objects would be pinned by cluster and are not tracked once cluster is created */
+	bool ValidateCluster() const;
+
 
 public:
 	const TMap<FName, int32>& GetEntryMap() const { return EntryPoints; }
+	const FDialogueNodeTable& GetNodeTable() const { return NodeTable; }
+
+	/** Zero-copy node access. Returns invalid view if not found */
+	FDialogueNodeView FindNodeView(int32 NodeId) const { return FDialogueNodeView(GetNodeTable(), GetNodeTable().FindIndex(NodeId)); }
+	FDialogueNodeView FindChildView(int32 NodeId, int32 ChildIndex) const { return FindNodeView(NodeId).GetChild(ChildIndex); }
+	FDialogueNodeView FindEntryView(FName EntryName) const { return FindNodeView(GetEntryId(EntryName)); }
+
+	/** Returns cached plan for text formatted on node, builds new one if text or culture changed */
+	TSharedRef<FDialogueFormatPlan> FindOrAddFormatPlan(int32 NodeId, const FText& Text) const;
+
+#if WITH_EDITORONLY_DATA
 	const TMap<int32, FDialogueNode>& GetNodeMap() const { return Nodes; }
+#endif // WITH_EDITORONLY_DATA
 
 
 	// BP functions
@@ -184,10 +528,13 @@ public:
 	UFUNCTION(BlueprintCallable, Category = Dialogue)
 	bool HasNode(int32 NodeId) const;
 
-	/** Returns default constructed node if not found */
+	/** Returns default constructed node if not found. Copies whole node, prefer GetNodeHandle */
 	UFUNCTION(BlueprintCallable, Category = Dialogue)
 	FDialogueNode GetNode(int32 NodeId) const;
 
+	UFUNCTION(BlueprintCallable, Category = Dialogue)
+	FDialogueNodeHandle GetNodeHandle(int32 NodeId) const;
+
 	UFUNCTION(BlueprintCallable, Category = Dialogue)
 	FText GetNodeText(int32 NodeId) const;
 
@@ -212,9 +559,13 @@ public:
 	UFUNCTION(BlueprintCallable, Category = Dialogue)
 	int32 GetChildId(int32 NodeId, int32 ChildIndex) const;
 
+	/** Copies all child nodes, prefer GetChildrenHandles */
 	UFUNCTION(BlueprintCallable, Category = Dialogue)
 	TArray<FDialogueNode> GetChildrenNodes(int32 NodeId) const;
 
+	UFUNCTION(BlueprintCallable, Category = Dialogue)
+	TArray<FDialogueNodeHandle> GetChildrenHandles(int32 NodeId) const;
+
 	UFUNCTION(BlueprintCallable, Category = Dialogue)
 	TArray<int32> GetChildrenIds(int32 NodeId) const;
 
@@ -230,6 +581,9 @@ public:
 	UFUNCTION(BlueprintCallable, Category = Dialogue)
 	FDialogueNode GetEntryNode(FName EntryName) const;
 
+	UFUNCTION(BlueprintCallable, Category = Dialogue)
+	FDialogueNodeHandle GetEntryHandle(FName EntryName) const;
+
 	UFUNCTION(BlueprintCallable, Category = Dialogue)
 	TArray<FName> GetEntries() const;
 
@@ -250,9 +604,10 @@ public:
 
 
 /** 
- * Convenience struct to allow dialogue editing at runtime
+ * Convenience struct to allow dialogue editing
  * Separated from asset to remove unnecessary data
  * Keeps tight NodeId assignment
+ * Node map is editor only data, so editing is unavailable in cooked builds
  */
 USTRUCT()
 struct DIALOGUEPLUGIN_API FDialogueEditorStruct
@@ -278,6 +633,7 @@ public:
 
 	FDialogueEditorStruct(UDialogue* InDialogue, bool bInitializeIdCreation = true);
 
+#if WITH_EDITORONLY_DATA
 
 	/** Required to add new nodes. Finds maximum Id and collects free Id's to assign */
 	void InitializeIdCreation();
@@ -314,4 +670,5 @@ public:
 		check(Dialogue != nullptr);
 		return Dialogue->EntryPoints;
 	}
+#endif // WITH_EDITORONLY_DATA
 };
\ No newline at end of file
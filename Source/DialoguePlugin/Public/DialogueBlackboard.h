@@ -0,0 +1,297 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "DialogueCondition.h"
+#include "DialogueBlackboard.generated.h"
+
+
+UENUM(BlueprintType)
+enum class EDialogueFactType : uint8
+{
+	None,
+	Bool,
+	Int,
+	Float,
+	Name
+};
+
+
+/** Typed blackboard value. None type means fact is not set */
+struct DIALOGUEPLUGIN_API FDialogueFact
+{
+	EDialogueFactType Type;
+
+	union
+	{
+		bool bBoolValue;
+		int32 IntValue;
+		float FloatValue;
+	};
+
+	FName NameValue;
+
+public:
+	FDialogueFact()
+		: Type(EDialogueFactType::None)
+		, IntValue(0)
+	{ }
+
+	static FDialogueFact MakeBool(bool bValue);
+	static FDialogueFact MakeInt(int32 Value);
+	static FDialogueFact MakeFloat(float Value);
+	static FDialogueFact MakeName(FName Value);
+
+	/** Zero value of type */
+	static FDialogueFact MakeDefault(EDialogueFactType Type);
+
+	bool IsSet() const { return Type != EDialogueFactType::None; }
+
+	/** Int and float facts as number, false for other types */
+	bool GetNumber(double& OutNumber) const;
+
+	FString ToString() const;
+
+	/** Facts of different types are never equal */
+	bool operator==(const FDialogueFact& Other) const;
+	bool operator!=(const FDialogueFact& Other) const { return !(*this == Other); }
+};
+
+
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnDialogueFactChanged, FName /*Key*/, const FDialogueFact& /*Value*/);
+
+/** Watcher slot in FDialogueBlackboard, serial tells reused slot from removed watcher */
+struct FDialogueBlackboardWatchHandle
+{
+	int32 Index = INDEX_NONE;
+	uint32 Serial = 0;
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+	void Reset() { *this = FDialogueBlackboardWatchHandle(); }
+
+	FORCEINLINE bool operator==(const FDialogueBlackboardWatchHandle& Other) const
+	{
+		return Index == Other.Index && Serial == Other.Serial;
+	}
+};
+
+/**
+ * FName keyed fact store
+ * Flat open addressing table with linear probing, lookup is one hash and usually one probe
+ * Watchers registered for keys are called after value of any of them changes, setting same value is not a change
+ */
+class DIALOGUEPLUGIN_API FDialogueBlackboard
+{
+private:
+	struct FSlot
+	{
+		/** None marks empty slot */
+		FName Key;
+
+		/** Unset when slot only holds watchers of key */
+		FDialogueFact Value;
+
+		/** Watchers of key */
+		TArray<FDialogueBlackboardWatchHandle, TInlineAllocator<2>> Watches;
+	};
+
+	struct FWatcher
+	{
+		uint32 Serial;
+		FOnDialogueFactChanged::FDelegate Delegate;
+		TArray<FName> Keys;
+	};
+
+	/** Power of two size, at most half is used */
+	TArray<FSlot> Slots;
+	int32 NumSlotsUsed;
+	int32 NumFacts;
+	uint32 Serial;
+
+	TSparseArray<FWatcher> Watchers;
+	uint32 NextWatcherSerial;
+
+public:
+	/** Called after any fact changes */
+	FOnDialogueFactChanged OnFactChanged;
+
+public:
+	FDialogueBlackboard();
+
+	/** nullptr if fact is not set */
+	const FDialogueFact* Find(FName Key) const;
+	bool Contains(FName Key) const { return Find(Key) != nullptr; }
+
+	/** Default is returned when fact is not set or has other type */
+	bool GetBool(FName Key, bool bDefault = false) const;
+	int32 GetInt(FName Key, int32 Default = 0) const;
+	float GetFloat(FName Key, float Default = 0.0f) const;
+	FName GetName(FName Key, FName Default = NAME_None) const;
+
+	/** Unset value removes fact */
+	void Set(FName Key, const FDialogueFact& Value);
+	void SetBool(FName Key, bool bValue) { Set(Key, FDialogueFact::MakeBool(bValue)); }
+	void SetInt(FName Key, int32 Value) { Set(Key, FDialogueFact::MakeInt(Value)); }
+	void SetFloat(FName Key, float Value) { Set(Key, FDialogueFact::MakeFloat(Value)); }
+	void SetName(FName Key, FName Value) { Set(Key, FDialogueFact::MakeName(Value)); }
+
+	/** @return	true if fact was set */
+	bool Remove(FName Key);
+
+	/** Remove all facts, watchers are notified of each removed one */
+	void Reset();
+
+	int32 Num() const { return NumFacts; }
+
+	/** Incremented on each change */
+	uint32 GetSerial() const { return Serial; }
+
+	void ForEachFact(TFunctionRef<void(FName, const FDialogueFact&)> Func) const;
+
+	/**
+	 * Call delegate after any of keys changes. Keys don't have to be set
+	 * @return	Handle for RemoveWatcher
+	 */
+	FDialogueBlackboardWatchHandle AddWatcher(TArrayView<const FName> Keys, FOnDialogueFactChanged::FDelegate&& Delegate);
+	void RemoveWatcher(FDialogueBlackboardWatchHandle Handle);
+
+private:
+	int32 GetHomeIndex(FName Key) const;
+	int32 FindSlot(FName Key) const;
+	int32 FindOrAddSlot(FName Key);
+	void Grow();
+
+	/** Slot without value and watchers is removed, following entries are shifted back so no tombstones are needed */
+	void ReleaseSlotIfUnused(int32 SlotIndex);
+
+	const FWatcher* FindWatcher(FDialogueBlackboardWatchHandle Handle) const;
+	void Notify(FName Key, const FDialogueFact& Value, TArrayView<const FDialogueBlackboardWatchHandle> Watches);
+};
+
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FDialogueFactEvent, FName, Key);
+
+/**
+ * Game wide dialogue facts, kept across level changes
+ * Conditions read facts through FDialogueBlackboardCondition, executors are notified when keys used by their dialogue change
+ */
+UCLASS()
+class DIALOGUEPLUGIN_API UDialogueBlackboardSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(BlueprintAssignable, Category = Dialogue)
+	FDialogueFactEvent OnFactChanged;
+
+private:
+	FDialogueBlackboard Blackboard;
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	static UDialogueBlackboardSubsystem* Get(const UObject* WorldContextObject);
+
+	/** nullptr if world context has no game instance */
+	static FDialogueBlackboard* FindBlackboard(const UObject* WorldContextObject);
+
+	FDialogueBlackboard& GetBlackboard() { return Blackboard; }
+	const FDialogueBlackboard& GetBlackboard() const { return Blackboard; }
+
+
+	UFUNCTION(BlueprintCallable, Category = "Dialogue|Blackboard")
+	void SetBoolFact(FName Key, bool bValue);
+
+	UFUNCTION(BlueprintCallable, Category = "Dialogue|Blackboard")
+	void SetIntFact(FName Key, int32 Value);
+
+	UFUNCTION(BlueprintCallable, Category = "Dialogue|Blackboard")
+	void SetFloatFact(FName Key, float Value);
+
+	UFUNCTION(BlueprintCallable, Category = "Dialogue|Blackboard")
+	void SetNameFact(FName Key, FName Value);
+
+	UFUNCTION(BlueprintCallable, Category = "Dialogue|Blackboard")
+	bool GetBoolFact(FName Key) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Dialogue|Blackboard")
+	int32 GetIntFact(FName Key) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Dialogue|Blackboard")
+	float GetFloatFact(FName Key) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Dialogue|Blackboard")
+	FName GetNameFact(FName Key) const;
+
+	/** None if fact is not set */
+	UFUNCTION(BlueprintCallable, Category = "Dialogue|Blackboard")
+	EDialogueFactType GetFactType(FName Key) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Dialogue|Blackboard")
+	bool RemoveFact(FName Key);
+
+	UFUNCTION(BlueprintCallable, Category = "Dialogue|Blackboard")
+	void ResetFacts();
+
+private:
+	void HandleFactChanged(FName Key, const FDialogueFact& Value);
+};
+
+
+UENUM()
+enum class EDialogueFactCompare : uint8
+{
+	Equal,
+	NotEqual,
+	Less,
+	LessOrEqual,
+	Greater,
+	GreaterOrEqual,
+	IsSet,
+	IsNotSet
+};
+
+/**
+ * Compares blackboard fact with value. Fact that is not set compares as zero value of Type
+ * Pure by default: executor caches result until Key changes
+ */
+USTRUCT(meta = (DisplayName = "Blackboard"))
+struct DIALOGUEPLUGIN_API FDialogueBlackboardCondition : public FDialogueConditionStruct
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = Dialogue)
+	FName Key;
+
+	/** Ordering compares numbers only, false for bool and name */
+	UPROPERTY(EditAnywhere, Category = Dialogue)
+	EDialogueFactCompare Compare = EDialogueFactCompare::Equal;
+
+	UPROPERTY(EditAnywhere, Category = Dialogue)
+	EDialogueFactType Type = EDialogueFactType::Bool;
+
+	UPROPERTY(EditAnywhere, Category = Dialogue, meta = (EditCondition = "Type == EDialogueFactType::Bool", EditConditionHides))
+	bool bBoolValue = true;
+
+	UPROPERTY(EditAnywhere, Category = Dialogue, meta = (EditCondition = "Type == EDialogueFactType::Int", EditConditionHides))
+	int32 IntValue = 0;
+
+	UPROPERTY(EditAnywhere, Category = Dialogue, meta = (EditCondition = "Type == EDialogueFactType::Float", EditConditionHides))
+	float FloatValue = 0.0f;
+
+	UPROPERTY(EditAnywhere, Category = Dialogue, meta = (EditCondition = "Type == EDialogueFactType::Name", EditConditionHides))
+	FName NameValue;
+
+public:
+	FDialogueBlackboardCondition()
+	{
+		bPure = true;
+	}
+
+	FDialogueFact GetValue() const;
+
+	virtual FString GetConditionDescription() const override;
+	virtual bool IsConditionMet(UObject* WorldContext) const override;
+	virtual void GetBlackboardKeys(TArray<FName>& OutKeys) const override;
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+/**
+ * Per class cache of blueprint implemented events
+ * Event is implemented when class function is owned by non-native class, i.e. blueprint has graph for it
+ * Masks are cached per class and event list, bit N of mask matches FunctionNames[N]
+ * Event list must be static array. Cache is cleared when blueprint is compiled
+ */
+struct DIALOGUEPLUGIN_API FDialogueBlueprintOverrides
+{
+	static uint32 GetMask(const UClass* Class, const FName* FunctionNames, int32 FunctionNum);
+
+	template<int32 FunctionNum>
+	static uint32 GetMask(const UClass* Class, const FName (&FunctionNames)[FunctionNum])
+	{
+		static_assert(FunctionNum <= 32, "Override mask is limited to 32 events");
+		return GetMask(Class, FunctionNames, FunctionNum);
+	}
+
+	static void Invalidate();
+
+private:
+	static TMap<TPair<FObjectKey, const FName*>, uint32> Masks;
+};
@@ -5,6 +5,10 @@
 #include "CoreMinimal.h"
 #include "DialogueCondition.generated.h"
 
+class UDialogueCondition;
+class UDialogueConditionLibrary;
+struct FDialogueSharedCondition;
+
 
 /** Customized instanced condition */
 USTRUCT(BlueprintType)
@@ -17,6 +21,236 @@ struct DIALOGUEPLUGIN_API FDialogueConditionContainer
 };
 
 
+/**
+ * Base of struct conditions, alternative to UDialogueCondition without UObject per condition
+ * Native only. Struct is shared by all executors, check must not change it
+ */
+USTRUCT(BlueprintType)
+struct DIALOGUEPLUGIN_API FDialogueConditionStruct
+{
+	GENERATED_BODY()
+
+	/** Same as UDialogueCondition::bPure */
+	UPROPERTY(EditAnywhere, Category = Dialogue, AdvancedDisplay)
+	bool bPure = false;
+
+	virtual ~FDialogueConditionStruct() { }
+
+	virtual FString GetConditionDescription() const { return TEXT(""); }
+
+	virtual bool IsConditionMet(UObject* WorldContext) const { return true; }
+
+	/** Same as UDialogueCondition::GetBlackboardKeys */
+	virtual void GetBlackboardKeys(TArray<FName>& OutKeys) const { }
+};
+
+
+/**
+ * Owning instance of struct derived from FDialogueConditionStruct
+ * Costs one allocation instead of UObject, structs without object references add no GC work
+ */
+USTRUCT()
+struct DIALOGUEPLUGIN_API FDialogueInstancedCondition
+{
+	GENERATED_BODY()
+
+private:
+	const UScriptStruct* ScriptStruct;
+	uint8* Memory;
+
+public:
+	FDialogueInstancedCondition()
+		: ScriptStruct(nullptr)
+		, Memory(nullptr)
+	{ }
+
+	FDialogueInstancedCondition(const FDialogueInstancedCondition& Other);
+	FDialogueInstancedCondition(FDialogueInstancedCondition&& Other);
+	FDialogueInstancedCondition& operator=(const FDialogueInstancedCondition& Other);
+	FDialogueInstancedCondition& operator=(FDialogueInstancedCondition&& Other);
+	~FDialogueInstancedCondition();
+
+	/** Replace instance with default one of struct, nullptr clears */
+	void InitializeAs(const UScriptStruct* NewStruct);
+	void Reset();
+
+	bool IsValid() const { return Memory != nullptr; }
+	const UScriptStruct* GetScriptStruct() const { return ScriptStruct; }
+	const uint8* GetMemory() const { return Memory; }
+	uint8* GetMutableMemory() { return Memory; }
+
+	const FDialogueConditionStruct* Get() const { return (const FDialogueConditionStruct*)Memory; }
+
+	template<typename T>
+	const T* GetPtr() const
+	{
+		return (ScriptStruct && ScriptStruct->IsChildOf(T::StaticStruct())) ? (const T*)Memory : nullptr;
+	}
+
+	bool Serialize(FArchive& Ar);
+	bool Identical(const FDialogueInstancedCondition* Other, uint32 PortFlags) const;
+	void AddStructReferencedObjects(FReferenceCollector& Collector) const;
+
+	/** Text form is used by graph and details copy/paste */
+	bool ExportTextItem(FString& ValueStr, const FDialogueInstancedCondition& DefaultValue, UObject* Parent, int32 PortFlags, UObject* ExportRootScope) const;
+	bool ImportTextItem(const TCHAR*& Buffer, int32 PortFlags, UObject* Parent, FOutputDevice* ErrorText);
+};
+
+template<>
+struct TStructOpsTypeTraits<FDialogueInstancedCondition> : public TStructOpsTypeTraitsBase2<FDialogueInstancedCondition>
+{
+	enum
+	{
+		WithSerializer = true,
+		WithIdentical = true,
+		WithExportTextItem = true,
+		WithImportTextItem = true,
+		WithAddStructReferencedObjects = true,
+		WithCopy = true,
+	};
+};
+
+
+/** Reference to named condition of UDialogueConditionLibrary */
+USTRUCT(BlueprintType)
+struct DIALOGUEPLUGIN_API FDialogueConditionHandle
+{
+	GENERATED_BODY()
+
+	/** Library is loaded with dialogue, each library condition is stored once however many nodes use it */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	UDialogueConditionLibrary* Library = nullptr;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FName Name;
+
+public:
+	bool IsSet() const { return Library != nullptr && !Name.IsNone(); }
+
+	/** nullptr if library has no such condition */
+	const FDialogueSharedCondition* Resolve() const;
+
+	bool operator==(const FDialogueConditionHandle& Other) const { return Library == Other.Library && Name == Other.Name; }
+	bool operator!=(const FDialogueConditionHandle& Other) const { return !(*this == Other); }
+};
+
+
+UENUM()
+enum class EDialogueConditionOp : uint8
+{
+	/** Result = true */
+	True,
+	/** Result = false */
+	False,
+	/** Result = Leaves[Arg] native check */
+	CallNative,
+	/** Result = Leaves[Arg] native and blueprint check */
+	CallBlueprint,
+	/** Result = StructLeaves[Arg] check */
+	CallStruct,
+	/** Result = SharedLeaves[Arg] library condition */
+	CallShared,
+	/** Jump to Arg if Result is false */
+	JumpIfFalse,
+	/** Jump to Arg if Result is true */
+	JumpIfTrue,
+	/** Push Result to stack */
+	Push,
+	/** Result = Pop() == Result */
+	Equal,
+	/** Result = Pop() != Result */
+	NotEqual
+};
+
+USTRUCT()
+struct FDialogueConditionInstruction
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	EDialogueConditionOp Op = EDialogueConditionOp::True;
+
+	UPROPERTY()
+	int32 Arg = 0;
+};
+
+
+/** 
+ * Memoized results of pure conditions
+ * Results are dropped when epoch is bumped
+ */
+struct DIALOGUEPLUGIN_API FDialogueConditionCache
+{
+private:
+	uint32 Epoch = 0;
+	/** Keyed by condition object, condition struct or shared library condition */
+	TMap<const void*, bool> Results;
+
+public:
+	void Invalidate()
+	{
+		Epoch++;
+		Results.Reset();
+	}
+
+	uint32 GetEpoch() const { return Epoch; }
+
+	const bool* Find(const void* Condition) const { return Results.Find(Condition); }
+	void Add(const void* Condition, bool bResult) { Results.Add(Condition, bResult); }
+};
+
+
+/** 
+ * Flattened condition tree
+ * AND, OR and Equality conditions are compiled into short-circuit jumps, other conditions become leaf calls
+ * Condition structs and shared library conditions are leaves joined to root condition by AND
+ * Empty program is always met
+ */
+USTRUCT()
+struct DIALOGUEPLUGIN_API FDialogueConditionProgram
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FDialogueConditionInstruction> Instructions;
+
+	UPROPERTY()
+	TArray<UDialogueCondition*> Leaves;
+
+	/** Valid condition structs, copied on compile */
+	UPROPERTY()
+	TArray<FDialogueInstancedCondition> StructLeaves;
+
+	/** Set shared condition handles, library conditions are not copied */
+	UPROPERTY()
+	TArray<FDialogueConditionHandle> SharedLeaves;
+
+	/** Blackboard keys registered by leaves, changing any of them may change result */
+	UPROPERTY()
+	TArray<FName> BlackboardKeys;
+
+public:
+	/** Snapshot of condition tree, structs and handles. Must be recompiled if any of them is changed */
+	void Compile(UDialogueCondition* Root,
+		TArrayView<const FDialogueInstancedCondition> Structs = TArrayView<const FDialogueInstancedCondition>(),
+		TArrayView<const FDialogueConditionHandle> Shared = TArrayView<const FDialogueConditionHandle>());
+
+	/** @param	Cache	Optional, results of pure leaf conditions are read and stored there */
+	bool Execute(UObject* WorldContext, FDialogueConditionCache* Cache = nullptr) const;
+
+	bool IsEmpty() const { return Instructions.Num() == 0; }
+	void Reset();
+
+private:
+	void Emit(EDialogueConditionOp Op, int32 Arg = 0);
+	void CompileNode(UDialogueCondition* Condition);
+	void CompileJunction(const TArray<UDialogueCondition*>& Conditions, EDialogueConditionOp JumpOp, EDialogueConditionOp EmptyOp);
+	static bool CallLeaf(const UDialogueCondition* Leaf, bool bCallBlueprint, UObject* WorldContext, FDialogueConditionCache* Cache);
+	static bool CallStruct(const FDialogueInstancedCondition& Leaf, UObject* WorldContext, FDialogueConditionCache* Cache);
+	static bool CallShared(const FDialogueConditionHandle& Leaf, UObject* WorldContext, FDialogueConditionCache* Cache);
+};
+
+
 /**
  * Basic dialogue condition
  */
@@ -25,9 +259,33 @@ class DIALOGUEPLUGIN_API UDialogueCondition : public UObject
 {
 	GENERATED_BODY()
 
+	friend struct FDialogueConditionProgram;
+public:
+	/** 
+	 * Pure condition result changes only with executor participants, blackboard or explicit cache invalidation
+	 * Such results may be memoized by executors with condition cache enabled
+	 * Volatile conditions are evaluated on every check
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = Dialogue, AdvancedDisplay)
+	bool bPure = false;
+
 public:
 	bool CheckCondition(UObject* WorldContext);
 
+	bool IsPure() const { return bPure; }
+
+	/** Blueprint class implements IsConditionMet */
+	bool HasBlueprintCheck() const;
+
+	/** Blueprint conditions may set object variables while checked, they are kept out of dialogue GC cluster */
+	virtual bool CanBeInCluster() const override;
+
+	/** 
+	 * Blackboard keys result depends on, see UDialogueBlackboardSubsystem
+	 * Executors drop cached results and notify listeners when any of them changes, so pure condition is not polled
+	 */
+	virtual void GetBlackboardKeys(TArray<FName>& OutKeys) const { }
+
 protected:
 	virtual bool IsConditionMet(UObject* WorldContext) const
 	{ 
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "DialogueCondition.h"
+#include "DialogueConditionLibrary.generated.h"
+
+
+/** Named condition referenced by nodes through FDialogueConditionHandle */
+USTRUCT(BlueprintType)
+struct DIALOGUEPLUGIN_API FDialogueSharedCondition
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Condition)
+	FName Name;
+
+	/** Result is memoized by executors with condition cache enabled, so condition is checked once for all nodes using it */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Condition)
+	bool bPure = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Instanced, Category = Condition)
+	UDialogueCondition* Condition = nullptr;
+
+	/** Joined to Condition by AND */
+	UPROPERTY(EditAnywhere, Category = Condition)
+	TArray<FDialogueInstancedCondition> ConditionStructs;
+
+	/** Built by library on load and edit */
+	UPROPERTY(Transient)
+	FDialogueConditionProgram Program;
+};
+
+
+/**
+ * Conditions shared by dialogues
+ * Predicate used by many nodes, such as quest state check, is stored and loaded once instead of instanced per node
+ */
+UCLASS(BlueprintType)
+class DIALOGUEPLUGIN_API UDialogueConditionLibrary : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, Category = Conditions, meta = (TitleProperty = "Name"))
+	TArray<FDialogueSharedCondition> Conditions;
+
+private:
+	TMap<FName, int32> NameToIndex;
+
+public:
+	virtual void PostLoad() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif //WITH_EDITOR
+
+	/** Rebuild programs and name lookup. Needed only when conditions are changed at runtime */
+	void Compile();
+
+	const FDialogueSharedCondition* FindCondition(FName Name) const;
+
+	UFUNCTION(BlueprintCallable, Category = Dialogue)
+	TArray<FName> GetConditionNames() const;
+};
@@ -65,10 +65,174 @@ public:
 	virtual void OnNodeEntered_Implementation(UObject* WorldContextObject) { }
 	virtual void OnNodeLeft_Implementation(UObject* WorldContextObject) { }
 
+	/** Context has per executor state that must be written to executor snapshot */
+	virtual bool HasExecutorState() const { return false; }
+
+	/** 
+	 * Save or restore per executor state, called from UDialogueExecutor::SerializeState
+	 * Context is shared by all executors of dialogue, state must be stored outside of context
+	 */
+	virtual void SerializeExecutorState(UObject* WorldContextObject, FArchive& Ar) { }
+
+	/** Native contexts follow the shared state rule above and join dialogue GC cluster, blueprint ones stay outside */
+	virtual bool CanBeInCluster() const override;
+
 public:
 	UFUNCTION(BlueprintCallable, Category = Dialogue)
 	int32 GetNodeId() const;
 
 	UFUNCTION(BlueprintCallable, Category = Dialogue)
 	UDialogue* GetDialogue() const;
-};
\ No newline at end of file
+};
+
+
+
+/**
+ * Base of struct node contexts, alternative to UDialogueNodeContext without UObject per node
+ * Native only. Struct is shared by all executors of dialogue, hooks must not change it
+ */
+USTRUCT(BlueprintType)
+struct DIALOGUEPLUGIN_API FDialogueNodeContextStruct
+{
+	GENERATED_BODY()
+
+	virtual ~FDialogueNodeContextStruct() { }
+
+	virtual FString GetContextDescripton() const { return TEXT(""); }
+
+	virtual bool CanEnterNode(UObject* WorldContextObject, int32 NodeId, int32 FromNode) const { return true; }
+	virtual void OnNodeFinished(UObject* WorldContextObject, int32 NodeId) const { }
+	virtual void OnNodeEntered(UObject* WorldContextObject, int32 NodeId) const { }
+	virtual void OnNodeLeft(UObject* WorldContextObject, int32 NodeId) const { }
+
+	/** Same as UDialogueNodeContext::HasExecutorState */
+	virtual bool HasExecutorState() const { return false; }
+	virtual void SerializeExecutorState(UObject* WorldContextObject, int32 NodeId, FArchive& Ar) const { }
+};
+
+
+/**
+ * Owning instance of struct derived from FDialogueNodeContextStruct
+ * Costs one allocation instead of UObject, structs without object references add no GC work
+ */
+USTRUCT()
+struct DIALOGUEPLUGIN_API FDialogueInstancedContext
+{
+	GENERATED_BODY()
+
+private:
+	const UScriptStruct* ScriptStruct;
+	uint8* Memory;
+
+public:
+	FDialogueInstancedContext()
+		: ScriptStruct(nullptr)
+		, Memory(nullptr)
+	{ }
+
+	FDialogueInstancedContext(const FDialogueInstancedContext& Other);
+	FDialogueInstancedContext(FDialogueInstancedContext&& Other);
+	FDialogueInstancedContext& operator=(const FDialogueInstancedContext& Other);
+	FDialogueInstancedContext& operator=(FDialogueInstancedContext&& Other);
+	~FDialogueInstancedContext();
+
+	/** Replace instance with default one of struct, nullptr clears */
+	void InitializeAs(const UScriptStruct* NewStruct);
+	void Reset();
+
+	bool IsValid() const { return Memory != nullptr; }
+	const UScriptStruct* GetScriptStruct() const { return ScriptStruct; }
+	const uint8* GetMemory() const { return Memory; }
+	uint8* GetMutableMemory() { return Memory; }
+
+	const FDialogueNodeContextStruct* Get() const { return (const FDialogueNodeContextStruct*)Memory; }
+
+	template<typename T>
+	const T* GetPtr() const
+	{
+		return (ScriptStruct && ScriptStruct->IsChildOf(T::StaticStruct())) ? (const T*)Memory : nullptr;
+	}
+
+	bool Serialize(FArchive& Ar);
+	bool Identical(const FDialogueInstancedContext* Other, uint32 PortFlags) const;
+	void AddStructReferencedObjects(FReferenceCollector& Collector) const;
+
+	/** Text form is used by graph and details copy/paste */
+	bool ExportTextItem(FString& ValueStr, const FDialogueInstancedContext& DefaultValue, UObject* Parent, int32 PortFlags, UObject* ExportRootScope) const;
+	bool ImportTextItem(const TCHAR*& Buffer, int32 PortFlags, UObject* Parent, FOutputDevice* ErrorText);
+};
+
+template<>
+struct TStructOpsTypeTraits<FDialogueInstancedContext> : public TStructOpsTypeTraitsBase2<FDialogueInstancedContext>
+{
+	enum
+	{
+		WithSerializer = true,
+		WithIdentical = true,
+		WithExportTextItem = true,
+		WithImportTextItem = true,
+		WithAddStructReferencedObjects = true,
+		WithCopy = true,
+	};
+};
+
+
+/**
+ * Struct contexts of same type packed into one allocation, indexed by dense node index
+ * Used by node table when every node has struct context of same type
+ */
+USTRUCT()
+struct DIALOGUEPLUGIN_API FDialogueContextArray
+{
+	GENERATED_BODY()
+
+private:
+	const UScriptStruct* ScriptStruct;
+	uint8* Memory;
+	int32 Num;
+
+public:
+	FDialogueContextArray()
+		: ScriptStruct(nullptr)
+		, Memory(nullptr)
+		, Num(0)
+	{ }
+
+	FDialogueContextArray(const FDialogueContextArray& Other);
+	FDialogueContextArray& operator=(const FDialogueContextArray& Other);
+	~FDialogueContextArray();
+
+	/** Allocate NewNum default instances of struct */
+	void Init(const UScriptStruct* NewStruct, int32 NewNum);
+	void Reset();
+
+	/** Copy instance into element, instance must be of array struct */
+	void CopyFrom(int32 Index, const FDialogueInstancedContext& Instance);
+	/** Copy element into instance */
+	void CopyTo(int32 Index, FDialogueInstancedContext& Instance) const;
+
+	int32 Size() const { return Num; }
+	bool IsEmpty() const { return Num == 0; }
+	const UScriptStruct* GetScriptStruct() const { return ScriptStruct; }
+
+	FORCEINLINE const FDialogueNodeContextStruct* Get(int32 Index) const
+	{
+		return (Index >= 0 && Index < Num) ? (const FDialogueNodeContextStruct*)(Memory + Index * ScriptStruct->GetStructureSize()) : nullptr;
+	}
+
+	bool Serialize(FArchive& Ar);
+	bool Identical(const FDialogueContextArray* Other, uint32 PortFlags) const;
+	void AddStructReferencedObjects(FReferenceCollector& Collector) const;
+};
+
+template<>
+struct TStructOpsTypeTraits<FDialogueContextArray> : public TStructOpsTypeTraitsBase2<FDialogueContextArray>
+{
+	enum
+	{
+		WithSerializer = true,
+		WithIdentical = true,
+		WithAddStructReferencedObjects = true,
+		WithCopy = true,
+	};
+};
@@ -17,7 +17,7 @@ public:
 
 	virtual bool CanExecute(UObject* WorldContext, UDialogue* Dialogue, int32 NodeId)
 	{
-		if (GetClass()->HasAnyClassFlags(CLASS_CompiledFromBlueprint) || !GetClass()->HasAnyClassFlags(CLASS_Native))
+		if (HasBlueprintEvent(BPEvent_CanExecute))
 		{
 			return BP_CanExecute(WorldContext, Dialogue, NodeId);
 		}
@@ -26,13 +26,25 @@ public:
 
 	virtual void ExecuteEvent(UObject* WorldContext, UDialogue* Dialogue, int32 NodeId)
 	{
-		if (GetClass()->HasAnyClassFlags(CLASS_CompiledFromBlueprint) || !GetClass()->HasAnyClassFlags(CLASS_Native))
+		if (HasBlueprintEvent(BPEvent_ExecuteEvent))
 		{
 			BP_ExecuteEvent(WorldContext, Dialogue, NodeId);
 		}
 	}
 
+	/** Blueprint events often store what they spawned, such references are not tracked inside GC cluster */
+	virtual bool CanBeInCluster() const override;
+
 protected:
+	enum EBlueprintEvent
+	{
+		BPEvent_CanExecute,
+		BPEvent_ExecuteEvent,
+	};
+
+	/** Blueprint class implements event, see FDialogueBlueprintOverrides */
+	bool HasBlueprintEvent(EBlueprintEvent Event) const;
+
 	UFUNCTION(BlueprintNativeEvent, Category = Dialogue, meta = (DisplayName = "CanExecute"))
 	bool BP_CanExecute(UObject* WorldContext, UDialogue* Dialogue, int32 NodeId);
 	bool BP_CanExecute_Implementation(UObject* WorldContext, UDialogue* Dialogue, int32 NodeId)
@@ -4,13 +4,21 @@
 
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
+#include "Dialogue.h"
+#include "DialogueCondition.h"
+#include "DialogueBlackboard.h"
+#include "DialoguePrefetch.h"
 #include "DialogueExecutor.generated.h"
 
 class UDialogue;
 struct FDialogueNode;
+struct FDialogueExecutionRecording;
+enum class EDialogueRecordedQuery : uint8;
 
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FDialogueNodeEvent, int32, NodeId);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FDialogueNodeNativeEvent, class UDialogueExecutorBase& /*Executor*/, int32 /*NodeId*/);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FDialogueFactNativeEvent, class UDialogueExecutorBase& /*Executor*/, FName /*Key*/);
 
 
 
@@ -99,16 +107,82 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = Dialogue)
 	FDialogueNodeEvent OnDialogueExecutionFinished;
 
+	/** 
+	 * Blackboard key read by dialogue conditions changed, available nodes found before may be stale
+	 * Choice menus re-query FindAvailableNextNodes here instead of polling
+	 */
+	UPROPERTY(BlueprintAssignable, Category = Dialogue)
+	FDialogueFactEvent OnConditionsChanged;
 
-	UPROPERTY()
+
+	/** 
+	 * Native counterparts of dynamic events, broadcast before blueprint events and dynamic delegates
+	 * Cleared on ResetExecutor same as dynamic ones
+	 */
+	FDialogueNodeNativeEvent OnNodeEnterNative;
+	FDialogueNodeNativeEvent OnNodeLeaveNative;
+	FDialogueNodeNativeEvent OnNodeExecutionBeginNative;
+	FDialogueNodeNativeEvent OnNodeExecutionEndNative;
+	FDialogueNodeNativeEvent OnDialogueExecutionStartedNative;
+	FDialogueNodeNativeEvent OnDialogueExecutionFinishedNative;
+	FDialogueFactNativeEvent OnConditionsChangedNative;
+
+
+	UPROPERTY(ReplicatedUsing = OnRep_Dialogue)
 	UDialogue* Dialogue;
 
 	UPROPERTY()
 	TMap<FName, UObject*> Participants;
 
+	/** 
+	 * Memoize results of pure conditions until cache is invalidated
+	 * Cache is invalidated on dialogue or participant change and by InvalidateConditionCache
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = Dialogue)
+	bool bCacheConditions;
+
+	/** 
+	 * Node audio and jump target dialogues are loaded asynchronously for nodes this many transitions ahead of entered node
+	 * 1 - children, 2 - children and grandchildren. 0 disables prefetch
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = Dialogue, meta = (ClampMin = 0, ClampMax = 4))
+	int32 PrefetchDepth;
+
+protected:
+	FDialogueConditionCache ConditionCache;
+
+	/** 
+	 * Participants resolved for dialogue participant slots, parallel to FDialogueNodeTable::ParticipantKeys
+	 * Resolved on SetDialogue and SetParticipant, node hooks read slots instead of searching map
+	 */
+	UPROPERTY(Transient)
+	TArray<UObject*> ResolvedParticipants;
+
+	/** Node table revision slots were resolved against */
+	uint32 ResolvedParticipantsRevision;
+
+	FDialoguePrefetcher Prefetcher;
+
+	/** Captures inputs of current execution, see FDialogueExecutionRecording */
+	TSharedPtr<FDialogueExecutionRecording> Recording;
+
+	/** Condition results are taken from this recording in order instead of being evaluated */
+	TSharedPtr<const FDialogueExecutionRecording> ReplaySource;
+	int32 ReplayConditionIndex;
+	int32 ReplayConditionMismatchNum;
+
+	/** Recorded results at and after this index are not consumed, INDEX_NONE for no limit */
+	int32 ReplayConditionEnd;
+
+	/** Watch of dialogue blackboard keys, see FDialogueNodeTable::BlackboardKeys */
+	TWeakObjectPtr<UDialogueBlackboardSubsystem> WatchedBlackboard;
+	FDialogueBlackboardWatchHandle BlackboardWatch;
+
 public:
 	UDialogueExecutorBase();
 	class UWorld* GetWorld() const override;
+	virtual void BeginDestroy() override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
 	/** Deferred init call */
 	UFUNCTION(BlueprintCallable, Category = Dialogue)
@@ -149,12 +223,61 @@ public:
 	UFUNCTION(BlueprintCallable, Category = Dialogue, meta = (DeterminesOutputType = Class, DynamicOutputParam = OutParticipants))
 	void GetParticipantsOfClass(TSubclassOf<UObject> Class, TArray<UObject*>& OutParticipants);
 
+	/** 
+	 * Resolve all participant slots again
+	 * Call after changing Participants map directly or when ResolveParticipant override result changes
+	 */
+	UFUNCTION(BlueprintCallable, Category = Dialogue)
+	void RefreshParticipantSlots();
+
+	/** Participant of node at dense node table index */
+	UObject* ResolveNodeParticipant(int32 NodeIndex) const;
 
+	/** True when slot was resolved against current node table */
+	FORCEINLINE bool HasParticipantSlot(int32 Slot) const
+	{
+		return ResolvedParticipants.IsValidIndex(Slot) && Dialogue && Dialogue->GetNodeTable().Revision == ResolvedParticipantsRevision;
+	}
+
+
+
+	/** Drop memoized condition results. Call when world state used by pure conditions changes */
+	UFUNCTION(BlueprintCallable, Category = Dialogue)
+	void InvalidateConditionCache();
+
+	/** Incremented on each cache invalidation */
+	uint32 GetConditionCacheEpoch() const { return ConditionCache.GetEpoch(); }
+
+	/** Watch blackboard keys of current dialogue conditions, called when dialogue changes */
+	void UpdateBlackboardWatch();
+
+	UFUNCTION()
+	void OnRep_Dialogue();
+
+	/** Sound and dialogue wave of node are loaded or not set */
+	UFUNCTION(BlueprintCallable, Category = Dialogue)
+	bool IsNodeAudioReady(int32 NodeId) const;
+
+	/** Release prefetched audio and jump targets, called when execution ends or dialogue changes */
+	void ReleasePrefetchedAssets();
 
 	/** Check conditions on node without entering */
 	UFUNCTION(BlueprintCallable, Category = Dialogue)
 	bool CheckNodeCondition(int32 NodeId);
 
+	/** Capture inputs of following executions. Null stops recording */
+	void SetRecording(TSharedPtr<FDialogueExecutionRecording> InRecording);
+	TSharedPtr<FDialogueExecutionRecording> GetRecording() const { return Recording; }
+
+	/** Feed recorded condition results instead of evaluating conditions. Null stops replay */
+	void SetReplaySource(TSharedPtr<const FDialogueExecutionRecording> InReplaySource);
+
+	/** Consume recorded results from Begin up to End only, keeps mismatch in one step from shifting following ones */
+	void SetReplayConditionRange(int32 Begin, int32 End);
+
+	/** Condition checks that didn't match replay source order */
+	int32 GetReplayConditionMismatchNum() const { return ReplayConditionMismatchNum; }
+
 
 	/** 
 	 * Check available nodes to enter from supplied one 
@@ -201,6 +324,12 @@ public:
 	/** Before initialization function */
 	virtual void HandleCreated();
 
+	/** 
+	 * Return executor to just constructed state: clears dialogue, participants, flags and delegate bindings
+	 * Used by executor pool on release
+	 */
+	virtual void ResetExecutor();
+
 
 protected:
 	/** Main initialization function */
@@ -209,6 +338,10 @@ protected:
 	/** Main initialization function */
 	UFUNCTION(BlueprintImplementableEvent, meta = (DisplayName = "OnInit"))
 	void ReceiveOnInit();
+
+	/** Executor is returned to pool, reset blueprint state here */
+	UFUNCTION(BlueprintImplementableEvent, meta = (DisplayName = "OnReset"))
+	void ReceiveOnReset();
 	
 
 	/** Called from MoveToNode */
@@ -231,10 +364,37 @@ protected:
 	virtual void HandleNodeExecutionEnd(int32 NodeId);
 
 
+	/** 
+	 * Take next condition result from replay source 
+	 * @return false if not replaying or recorded check doesn't match node, condition must be evaluated then
+	 */
+	bool ConsumeReplayCondition(int32 NodeId, bool& bOutResult);
+
+	void RecordCondition(int32 NodeId, bool bResult);
+	void RecordQuery(int32 NodeId, EDialogueRecordedQuery Type);
+
+	/** Invalidates condition cache and broadcasts OnConditionsChanged */
+	virtual void HandleBlackboardFactChanged(FName Key, const FDialogueFact& Value);
+
+
+	enum EBlueprintEvent
+	{
+		BPEvent_Init,
+		BPEvent_Reset,
+		BPEvent_NodeLeave,
+		BPEvent_NodeEnter,
+	};
+
+	/** Blueprint class implements event, see FDialogueBlueprintOverrides */
+	bool HasBlueprintEvent(EBlueprintEvent Event) const;
+
+
 	// Debugger log
 public:
 
 #if WITH_EDITOR
+	struct FDialogueExecutionLog;
+
 	struct FDialogueExecutionStep
 	{
 		int32 NodeId;
@@ -270,66 +430,145 @@ public:
 		}
 
 
-		void PushToLog(TArray<FDialogueExecutionStep>& Log, FSimpleMulticastDelegate& NotifyEvent)
+		void PushToLog(FDialogueExecutionLog& Log, FSimpleMulticastDelegate& NotifyEvent);
+	};
+
+	/** 
+	 * Fixed capacity ring buffer of execution steps, oldest steps are overwritten
+	 * Capacity is set by dialogue.ExecutionLogCapacity
+	 * Entry states following last Active/Finished step are indexed by node, repeated checks update existing entry
+	 */
+	struct DIALOGUEPLUGIN_API FDialogueExecutionLog
+	{
+	private:
+		TArray<FDialogueExecutionStep> Buffer;
+		int32 Capacity;
+		int32 Head;
+		int32 Count;
+
+		/** Total steps ever added, used as stable step position */
+		int64 TotalAdded;
+
+		/** NodeId to position of entry step in trailing entry run */
+		TMap<int32, int64> PendingEntries;
+
+	public:
+		FDialogueExecutionLog();
+
+		/** Oldest step is at index 0 */
+		int32 Num() const { return Count; }
+		int32 GetCapacity() const { return Capacity; }
+
+		const FDialogueExecutionStep& operator[](int32 Index) const
 		{
-			bool bChanged = false;
-			switch (Action)
-			{
-			
-			case Active:
-			case Finished:
-				if (Log.Num() == 0 || Log.Last() != *this)
-				{
-					Log.Add(*this);
-					bChanged = true;
-				}
-				break;
-			
-			case EntryUnknown:
-			case EntryAllowed:
-			case EntryDenied:
-			{
-				bool bShouldAdd = true;
-				for (int32 Index = Log.Num() - 1; Index >= 0 ; Index--)
-				{
-					FDialogueExecutionStep& Entry = Log[Index];
-					if (Entry.Action < EExecutionAction::EntryUnknown )
-					{
-						break;
-					}
-					if (Entry.NodeId == NodeId)
-					{
-						Entry.Action = this->Action;
-						bChanged = true;
-					}
-				}
-				if (bShouldAdd)
-				{
-					Log.Add(*this);
-					bChanged = true;
-				}
-				break;
-			}
-
-			case None:
-			default:
-				break;
-			}
-
-			if (bChanged)
-			{
-				NotifyEvent.Broadcast();
-			}
+			check(Index >= 0 && Index < Count);
+			return Buffer[(Head + Index) % Capacity];
 		}
+
+		const FDialogueExecutionStep& Last() const { return (*this)[Count - 1]; }
+
+		/** @return true if log was changed */
+		bool Push(const FDialogueExecutionStep& Step);
+
+		/** Clear and apply current capacity setting */
+		void Empty();
+
+	private:
+		FDialogueExecutionStep* FindByPosition(int64 Position);
+		void Add(const FDialogueExecutionStep& Step);
 	};
 
 	FSimpleMulticastDelegate OnLogChanged;
-	TArray<FDialogueExecutionStep> ExecutionLog;
+	FDialogueExecutionLog ExecutionLog;
 
 #endif
 };
 
 
+/**
+ * Replicated execution path: entry and transitions encoded relative to previous node
+ * Transition code: 0 - execution end, 1 - jump to node that is not a child, followed by node id, N - child at index N - 2
+ * Only last few transitions are kept, older half of window is dropped when it is full. Update size doesn't grow with path length
+ * Clients that fell behind the window skip to server node without events
+ * Followed jump restarts path in target dialogue with new serial
+ */
+USTRUCT()
+struct DIALOGUEPLUGIN_API FDialogueReplicatedPath
+{
+	GENERATED_BODY()
+
+	enum 
+	{ 
+		Code_End = 0, 
+		Code_Jump = 1, 
+		Code_FirstChild = 2,
+		/** Older transitions are dropped when exceeded */
+		MaxCodes = 16
+	};
+
+	/** Incremented on each execution begin so equal paths of different executions replicate */
+	UPROPERTY()
+	uint8 Serial;
+
+	/** Dialogue node ids and codes refer to, differs from executor dialogue after jump on server */
+	UPROPERTY()
+	UDialogue* Dialogue;
+
+	UPROPERTY()
+	FName EntryPoint;
+
+	UPROPERTY()
+	int32 StartNodeId;
+
+	/** Transitions made since execution begin before StartNodeId was reached */
+	UPROPERTY()
+	int32 BaseStep;
+
+	UPROPERTY()
+	TArray<uint32> Codes;
+
+	FDialogueReplicatedPath()
+		: Serial(0)
+		, Dialogue(nullptr)
+		, StartNodeId(INDEX_NONE)
+		, BaseStep(0)
+	{ }
+
+	void Begin(UDialogue* InDialogue, FName InEntryPoint, int32 NodeId);
+	void AddTransition(const FDialogueNodeTable& NodeTable, int32 FromNodeId, int32 ToNodeId);
+
+	/** @param	LastNodeId	Node execution ended at */
+	void AddEnd(const FDialogueNodeTable& NodeTable, int32 LastNodeId);
+
+	/** Transitions encoded in Codes */
+	int32 GetStepNum() const;
+
+	/** 
+	 * Decode node sequence using dialogue table
+	 * @return false if path doesn't match table
+	 */
+	bool Decode(const FDialogueNodeTable& NodeTable, TArray<int32>& OutNodes, bool& bOutFinished) const;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+private:
+	/** 
+	 * Drop older half of transitions, step count is kept
+	 * @param	CurrentNodeId	Path restarts here if it can't be decoded
+	 */
+	void Trim(const FDialogueNodeTable& NodeTable, int32 CurrentNodeId);
+};
+
+template<>
+struct TStructOpsTypeTraits<FDialogueReplicatedPath> : public TStructOpsTypeTraitsBase2<FDialogueReplicatedPath>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
+
 /**
  * Standard dialogue execution
  * Executes nodes one by one until encounters dead end(no available children)
@@ -360,10 +599,31 @@ private:
 	uint8 bNodeExecutionInProgress : 1;
 	uint8 bNodeExecutionCleanupInProgress : 1;
 
+	/** Recording was started by dialogue.RecordExecutions and is saved when execution ends */
+	uint8 bAutoRecording : 1;
+
+	/** Client side: serial and step in replicated path of current node */
+	uint8 AppliedPathSerial;
+	int32 AppliedPathStep;
+
 protected:
 	UPROPERTY()
 	int32 CurrentNodeId;
 
+	/** Entry point of current execution, None when started at node */
+	UPROPERTY()
+	FName CurrentEntryPoint;
+
+	/** 
+	 * Replicate execution path to clients when executor is replicated as subobject of its owner
+	 * Owner must replicate executor in ReplicateSubobjects. Clients follow server transitions firing regular events
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Dialogue)
+	bool bReplicateExecution;
+
+	UPROPERTY(ReplicatedUsing = OnRep_ReplicatedPath)
+	FDialogueReplicatedPath ReplicatedPath;
+
 
 
 public:
@@ -371,6 +631,12 @@ public:
 
 	virtual void SetDialogue(UDialogue* NewDialogue) override;
 
+	virtual bool IsSupportedForNetworking() const override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/** Replication is enabled and owner has authority */
+	bool HasReplicationAuthority() const;
+
 	/** 
 	 * Start execution at entry point node
 	 * Will force initialization if it wasn't called
@@ -393,9 +659,16 @@ public:
 	/** 
 	 * Start node execution and fire events.
 	 * Called automatically on BeginExecution or FinishExecution
+	 * Jump nodes are not executed, execution continues at their target entry
 	 */
 	void ExecuteCurrentNode();
 
+	/** 
+	 * Leave current jump node and enter target entry in jump dialogue
+	 * @return	false if current node is not a jump or its target is invalid
+	 */
+	bool FollowJump();
+
 	/** 
 	 * Called manually.
 	 * Finish execution of current node and continue to the next one
@@ -404,6 +677,13 @@ public:
 	UFUNCTION(BlueprintCallable, Category = Dialogue)
 	void FinishNodeExecution(int32 NextNodeId);
 
+	/** 
+	 * Same as FinishNodeExecution, but transition is made during dialogue subsystem batch pass
+	 * Calls FinishNodeExecution immediately if there is no subsystem
+	 */
+	UFUNCTION(BlueprintCallable, Category = Dialogue)
+	void QueueFinishNodeExecution(int32 NextNodeId);
+
 	/** Finish executing current node and stop */
 	UFUNCTION(BlueprintCallable, Category = Dialogue)
 	void StopExecution();
@@ -416,6 +696,33 @@ public:
 	UFUNCTION(BlueprintCallable, Category = Dialogue)
 	int32 GetCurrentNodeId() const;
 
+	UFUNCTION(BlueprintCallable, Category = Dialogue)
+	FName GetCurrentEntryPoint() const;
+
+	virtual void ResetExecutor() override;
+
+
+	/** 
+	 * Write compact versioned snapshot of execution position: current node, entry, participant keys and context state
+	 * Participants are not saved, only their keys. Owner is responsible for binding them again
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dialogue|State")
+	void SaveState(TArray<uint8>& OutState);
+
+	/** 
+	 * Restore snapshot written by SaveState. Execution must not be in progress
+	 * Dialogue active at save is set again, after followed jump it differs from dialogue executor was started with
+	 * Node enter and execution begin events are not fired, NodeExecutionRestored is called instead
+	 * @return	true if state was restored
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dialogue|State")
+	bool RestoreState(const TArray<uint8>& State);
+
+	/** 
+	 * Save or restore snapshot using existing archive, used to write many executors into single buffer
+	 * Snapshot is always read completely, so archive stays valid when restore is rejected
+	 */
+	virtual bool SerializeState(FArchive& Ar);
 
 
 protected:
@@ -439,10 +746,39 @@ protected:
 		
 	}
 
+	/** 
+	 * Called instead of NodeExecutionBegin when current node is restored from snapshot
+	 * Restore presentation here without one-time node effects
+	 */
+	UFUNCTION(BlueprintNativeEvent, Category = Dialogue)
+	void NodeExecutionRestored();
+	virtual void NodeExecutionRestored_Implementation()
+	{
+		
+	}
+
 protected:
 	UFUNCTION(BlueprintImplementableEvent, meta = (DisplayName = "DialoueExecutionBegin"))
 	void ReceiveDialoueExecutionBegin(int32 NodeId, FName Entry);
 
 	UFUNCTION(BlueprintImplementableEvent, meta = (DisplayName = "DialoueExecutionEnd"))
 	void ReceiveDialoueExecutionEnd(int32 NodeId);
+
+	UFUNCTION()
+	void OnRep_ReplicatedPath();
+
+	enum EExecutorBlueprintEvent
+	{
+		BPEvent_ExecutionBegin,
+		BPEvent_ExecutionEnd,
+		BPEvent_NodeExecutionBegin,
+		BPEvent_NodeExecutionEnd,
+		BPEvent_NodeExecutionRestored,
+	};
+
+	/** Native events are called directly when blueprint doesn't implement them */
+	bool HasExecutorBlueprintEvent(EExecutorBlueprintEvent Event) const;
+
+	/** Jump to node without events, used when client can't follow path transitions */
+	void ApplyNodeWithoutEvents(int32 NodeId, FName EntryPoint);
 };
\ No newline at end of file
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dialogue.h"
+#include "DialoguePrefetch.h"
+
+class FReferenceCollector;
+
+
+/** Stable reference to executor in FDialogueLiteExecutorList */
+struct FDialogueLiteExecutorHandle
+{
+	int32 Index = INDEX_NONE;
+	uint32 Serial = 0;
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+
+	FORCEINLINE bool operator==(const FDialogueLiteExecutorHandle& Other) const
+	{
+		return Index == Other.Index && Serial == Other.Serial;
+	}
+};
+
+
+/**
+ * Plain dialogue traversal state without UObject overhead
+ * Follows UDialogueExecutor rules: first child allowed by context and condition is entered, jump nodes switch dialogue
+ * Has no delegates and blueprint events. Participant and context node hooks are optional
+ */
+struct DIALOGUEPLUGIN_API FDialogueLiteExecutor
+{
+	UDialogue* Dialogue = nullptr;
+
+	/** Dense index in dialogue node table */
+	int32 NodeIndex = INDEX_NONE;
+
+	/** World time of automatic advance. Absolute time keeps batches correct when list is processed over several frames */
+	float AdvanceTime = 0.0f;
+
+	uint32 Serial = 0;
+
+	/** Call participant and context OnNodeEntered/OnNodeLeft */
+	bool bNotifyNodes = false;
+
+	/** Parked on jump node whose target dialogue is still loading, jump is retried on next advance */
+	bool bWaitingForJump = false;
+
+	TArray<TPair<FName, TWeakObjectPtr<UObject>>, TInlineAllocator<2>> Participants;
+
+	/** Audio and jump targets of current node and its children, filled by owning list */
+	FDialoguePrefetcher Prefetcher;
+
+public:
+	bool IsRunning() const { return Dialogue != nullptr && NodeIndex != INDEX_NONE; }
+
+	int32 GetNodeId() const;
+	FDialogueNodeView GetNodeView() const;
+
+	void SetParticipant(FName Name, UObject* Participant);
+	UObject* ResolveParticipant(const FDialogueParticipant& Participant) const;
+
+	/** Enter node without condition check, same as UDialogueExecutor::BeginExecutionAtNode */
+	bool Begin(UDialogue* InDialogue, int32 NodeId, UObject* WorldContext);
+
+	/** Move to first available child, or retry pending jump. Returns false when there is none and execution finished */
+	bool Advance(UObject* WorldContext);
+
+	void Stop(UObject* WorldContext);
+
+private:
+	void MoveTo(int32 NewIndex, UObject* WorldContext);
+
+	/** Continue at target entry while current node is a jump. Stops at jump whose target isn't loaded */
+	void FollowJumps(UObject* WorldContext);
+};
+
+
+/**
+ * Contiguous storage of lite executors, stepped in batches
+ * Owner must report references with AddReferencedObjects
+ */
+struct DIALOGUEPLUGIN_API FDialogueLiteExecutorList
+{
+	DECLARE_MULTICAST_DELEGATE_TwoParams(FOnLiteNodeEvent, FDialogueLiteExecutorHandle, const FDialogueNodeView&);
+
+	/** Called after node is entered. Listener may override executor AdvanceTime */
+	FOnLiteNodeEvent OnNodeEntered;
+
+	/** Node time when node has no sound or its sound is not loaded yet */
+	float DefaultNodeDuration = 3.0f;
+
+	/** Transitions ahead of current node whose audio and jump targets are prefetched. 0 disables prefetch */
+	int32 PrefetchDepth = 1;
+
+private:
+	TArray<FDialogueLiteExecutor> Executors;
+	TArray<int32> FreeIndices;
+	uint32 NextSerial = 1;
+	int32 RunningNum = 0;
+
+public:
+	/** Start new executor at entry, node time starts at world Time. Returns invalid handle if entry is missing */
+	FDialogueLiteExecutorHandle Add(UDialogue* Dialogue, FName EntryPoint, float Time, UObject* WorldContext, bool bNotifyNodes = false);
+
+	void Remove(FDialogueLiteExecutorHandle Handle, UObject* WorldContext);
+
+	FDialogueLiteExecutor* Find(FDialogueLiteExecutorHandle Handle);
+	const FDialogueLiteExecutor* Find(FDialogueLiteExecutorHandle Handle) const;
+
+	/** Advance single executor immediately, next node time starts at world Time */
+	bool Advance(FDialogueLiteExecutorHandle Handle, float Time, UObject* WorldContext);
+
+	/** Advance all executors whose node time is over. Finished executors are removed */
+	void Tick(float Time, UObject* WorldContext);
+
+	/** Advance executors from StartIndex until MaxNum slots are processed. Returns index to continue from, 0 when list end is reached */
+	int32 TickRange(int32 StartIndex, int32 MaxNum, float Time, UObject* WorldContext);
+
+	int32 Num() const { return RunningNum; }
+	int32 GetSlotNum() const { return Executors.Num(); }
+
+	void Empty();
+
+	void AddReferencedObjects(FReferenceCollector& Collector, const UObject* Referencer);
+
+private:
+	FDialogueLiteExecutorHandle MakeHandle(int32 Index) const;
+	void EnterNode(int32 Index, float Time);
+	void RemoveAt(int32 Index);
+};
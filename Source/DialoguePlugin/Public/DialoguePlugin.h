@@ -4,6 +4,7 @@
 
 #include "Modules/ModuleManager.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
+#include "Dialogue.h"
 #include "DialoguePlugin.generated.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(LogDialogue, Log, All);
@@ -12,6 +13,8 @@ DECLARE_LOG_CATEGORY_EXTERN(LogDialogue, Log, All);
 
 class FDialoguePlugin : public IModuleInterface
 {
+public:
+	virtual void ShutdownModule() override;
 };
 
 
@@ -28,6 +31,56 @@ public:
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Dialogue", meta = (DynamicOutputParam = OutExecutor, DeterminesOutputType = Class))
 	static void CreateDialogueExecutor(TSubclassOf<UDialogueExecutorBase> Class, UObject* Owner, UDialogue* Dialogue, bool bDeferInitialization, UDialogueExecutorBase*& OutExecutor);
-		
+
+	/**  
+	 * Same as CreateDialogueExecutor, but reuses released executor from world pool when available
+	 * Return executor with ReleaseDialogueExecutor when it's no longer needed
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dialogue", meta = (DynamicOutputParam = OutExecutor, DeterminesOutputType = Class))
+	static void AcquireDialogueExecutor(TSubclassOf<UDialogueExecutorBase> Class, UObject* Owner, UDialogue* Dialogue, bool bDeferInitialization, UDialogueExecutorBase*& OutExecutor);
+
+	/** Stop and reset executor, then return it to world pool. Executor must not be used after release */
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	static void ReleaseDialogueExecutor(UDialogueExecutorBase* Executor);
+
+
+	// Node handle accessors. Read single fields without copying whole node
+
+	UFUNCTION(BlueprintCallable, Category = "Dialogue|Node")
+	static bool IsNodeHandleValid(const FDialogueNodeHandle& Handle);
+
+	/** Returns default constructed node if handle is invalid */
+	UFUNCTION(BlueprintCallable, Category = "Dialogue|Node")
+	static FDialogueNode GetHandleNode(const FDialogueNodeHandle& Handle);
+
+	UFUNCTION(BlueprintCallable, Category = "Dialogue|Node")
+	static FName GetHandleNodeType(const FDialogueNodeHandle& Handle);
+
+	UFUNCTION(BlueprintCallable, Category = "Dialogue|Node")
+	static FText GetHandleText(const FDialogueNodeHandle& Handle);
+
+	UFUNCTION(BlueprintCallable, Category = "Dialogue|Node")
+	static FDialogueParticipant GetHandleParticipant(const FDialogueNodeHandle& Handle);
+
+	/** Node has no audio or all of its audio is loaded. Sound and dialogue wave accessors return null until then */
+	UFUNCTION(BlueprintCallable, Category = "Dialogue|Node")
+	static bool IsHandleAudioReady(const FDialogueNodeHandle& Handle);
+
+	/** Null if sound isn't loaded yet, see IsHandleAudioReady */
+	UFUNCTION(BlueprintCallable, Category = "Dialogue|Node")
+	static USoundBase* GetHandleSound(const FDialogueNodeHandle& Handle);
+
+	/** Null if dialogue wave isn't loaded yet, see IsHandleAudioReady */
+	UFUNCTION(BlueprintCallable, Category = "Dialogue|Node")
+	static UDialogueWave* GetHandleDialogueWave(const FDialogueNodeHandle& Handle);
+
+	UFUNCTION(BlueprintCallable, Category = "Dialogue|Node")
+	static UDialogueNodeContext* GetHandleContext(const FDialogueNodeHandle& Handle);
+
+	UFUNCTION(BlueprintCallable, Category = "Dialogue|Node")
+	static int32 GetHandleChildrenNum(const FDialogueNodeHandle& Handle);
+
+	UFUNCTION(BlueprintCallable, Category = "Dialogue|Node")
+	static FDialogueNodeHandle GetHandleChild(const FDialogueNodeHandle& Handle, int32 ChildIndex);
 
 };
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UDialogue;
+struct FDialogueNode;
+struct FStreamableHandle;
+
+
+/**
+ * Keeps soft assets of nodes reachable from current one loaded: node audio and jump target dialogues
+ * Each Update requests async loads of newly reachable assets and releases assets that are no longer reachable
+ */
+struct DIALOGUEPLUGIN_API FDialoguePrefetcher
+{
+private:
+	TMap<FSoftObjectPath, TSharedPtr<FStreamableHandle>> Handles;
+
+public:
+	~FDialoguePrefetcher();
+
+	/**
+	 * Prefetch assets of node at dense index and nodes up to Depth transitions away from it
+	 * Assets outside of this range are released
+	 */
+	void Update(const UDialogue* Dialogue, int32 NodeIndex, int32 Depth);
+
+	/** Release all prefetched assets */
+	void Reset();
+
+	int32 Num() const { return Handles.Num(); }
+
+	/** Node has no audio or all of its audio is loaded */
+	static bool IsNodeAudioReady(const FDialogueNode& Node);
+
+	/** Asset manager streamable manager, dialogue loads share its handles and priorities with game loads */
+	static struct FStreamableManager& GetStreamableManager();
+};
@@ -0,0 +1,215 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DialogueExecutor.h"
+#include "DialogueRecording.generated.h"
+
+class UDialogue;
+
+
+struct FDialogueRecordedCondition
+{
+	int32 NodeId;
+	bool bResult;
+
+	FDialogueRecordedCondition()
+		: NodeId(INDEX_NONE)
+		, bResult(false)
+	{ }
+
+	FDialogueRecordedCondition(int32 NodeId, bool bResult)
+		: NodeId(NodeId)
+		, bResult(bResult)
+	{ }
+
+	friend FArchive& operator<<(FArchive& Ar, FDialogueRecordedCondition& Condition)
+	{
+		Ar << Condition.NodeId << Condition.bResult;
+		return Ar;
+	}
+};
+
+enum class EDialogueRecordedQuery : uint8
+{
+	/** FindAvailableNextNodes(NodeId, false) */
+	AllChildren,
+	/** FindAvailableNextNodes(NodeId, true) */
+	FirstChild,
+	/** CheckNodeCondition(NodeId) */
+	Node,
+};
+
+/** Condition query made by executor user, replay repeats same queries so recorded results line up */
+struct FDialogueRecordedQuery
+{
+	int32 NodeId;
+	EDialogueRecordedQuery Type;
+
+	FDialogueRecordedQuery()
+		: NodeId(INDEX_NONE)
+		, Type(EDialogueRecordedQuery::AllChildren)
+	{ }
+
+	FDialogueRecordedQuery(int32 NodeId, EDialogueRecordedQuery Type)
+		: NodeId(NodeId)
+		, Type(Type)
+	{ }
+
+	friend FArchive& operator<<(FArchive& Ar, FDialogueRecordedQuery& Query)
+	{
+		uint8 TypeValue = (uint8)Query.Type;
+		Ar << Query.NodeId << TypeValue;
+		Query.Type = (EDialogueRecordedQuery)TypeValue;
+		return Ar;
+	}
+};
+
+struct FDialogueRecordedParticipant
+{
+	FName Name;
+	FString ObjectPath;
+	FString ClassPath;
+
+	friend FArchive& operator<<(FArchive& Ar, FDialogueRecordedParticipant& Participant)
+	{
+		Ar << Participant.Name << Participant.ObjectPath << Participant.ClassPath;
+		return Ar;
+	}
+};
+
+/** Dialogue entered by followed jump */
+struct FDialogueRecordedSwitch
+{
+	/** Choices.Num() when jump was followed, 0 when entry node itself jumped */
+	int32 ChoiceIndex;
+
+	/** Target node in new dialogue */
+	int32 NodeId;
+
+	FName EntryPoint;
+	FString DialoguePath;
+
+	FDialogueRecordedSwitch()
+		: ChoiceIndex(0)
+		, NodeId(INDEX_NONE)
+	{ }
+
+	friend FArchive& operator<<(FArchive& Ar, FDialogueRecordedSwitch& Switch)
+	{
+		Ar << Switch.ChoiceIndex << Switch.NodeId << Switch.EntryPoint << Switch.DialoguePath;
+		return Ar;
+	}
+};
+
+/**
+ * Nondeterministic inputs of single UDialogueExecutor execution
+ * Recorded when executor has recording set or dialogue.RecordExecutions is enabled
+ */
+struct DIALOGUEPLUGIN_API FDialogueExecutionRecording
+{
+	enum
+	{
+		Version = 5,
+		/** Earlier files were written without names or condition queries and can't be replayed */
+		MinVersion = 5,
+	};
+
+	/** Dialogue execution began in */
+	FString DialoguePath;
+	FName EntryPoint;
+	int32 EntryNodeId;
+
+	/** Participant bindings at execution begin */
+	TArray<FDialogueRecordedParticipant> Participants;
+
+	/** NextNodeId of each FinishNodeExecution call */
+	TArray<int32> Choices;
+
+	/** Condition results in evaluation order */
+	TArray<FDialogueRecordedCondition> Conditions;
+
+	/** Conditions.Num() when each choice was made, condition results of step N lie between choices N-1 and N */
+	TArray<int32> ChoiceConditionNum;
+
+	/** Condition queries in order, their evaluations produced Conditions */
+	TArray<FDialogueRecordedQuery> Queries;
+
+	/** Queries.Num() when each choice was made, same layout as ChoiceConditionNum */
+	TArray<int32> ChoiceQueryNum;
+
+	/** Executed nodes in order, expected replay result. Node ids after switch belong to switched dialogue */
+	TArray<int32> NodeSequence;
+
+	/** Jumps to other dialogues in order */
+	TArray<FDialogueRecordedSwitch> DialogueSwitches;
+
+	FDialogueExecutionRecording()
+		: EntryNodeId(INDEX_NONE)
+	{ }
+
+	/** Reset and capture execution start state */
+	void BeginExecution(const UDialogueExecutorBase& Executor, int32 NodeId, FName InEntryPoint);
+
+	/** Executor followed jump to other dialogue */
+	void SwitchDialogue(const UDialogue* Dialogue, int32 NodeId, FName InEntryPoint);
+
+	void Serialize(FArchive& Ar);
+
+	bool SaveToFile(const FString& FilePath);
+	bool LoadFromFile(const FString& FilePath);
+
+	/** dialogue.RecordExecutions */
+	static bool IsAutoRecordEnabled();
+
+	/** Default file for automatically recorded execution */
+	static FString MakeAutoRecordPath(const UDialogueExecutorBase& Executor);
+};
+
+
+struct DIALOGUEPLUGIN_API FDialogueReplayResult
+{
+	TArray<int32> ExpectedSequence;
+	TArray<int32> NodeSequence;
+
+	/** First index where node sequences differ, INDEX_NONE when identical */
+	int32 DivergenceIndex;
+
+	/** Condition checks that didn't match recorded order and were evaluated instead. Recorded queries are repeated, so this counts asset changes only */
+	int32 ConditionMismatchNum;
+
+	/** Participants that couldn't be found, replay runs without them */
+	TArray<FName> UnresolvedParticipants;
+
+	TArray<FString> Errors;
+
+	FDialogueReplayResult()
+		: DivergenceIndex(INDEX_NONE)
+		, ConditionMismatchNum(0)
+	{ }
+
+	bool IsIdentical() const { return DivergenceIndex == INDEX_NONE && ConditionMismatchNum == 0 && Errors.Num() == 0; }
+
+	FString ToString() const;
+};
+
+
+/**
+ * Headless executor used by replayer
+ * Does nothing on node execution, transitions are driven by recorded choices
+ */
+UCLASS(Transient, NotBlueprintable)
+class DIALOGUEPLUGIN_API UDialogueReplayExecutor : public UDialogueExecutor
+{
+	GENERATED_BODY()
+};
+
+
+struct DIALOGUEPLUGIN_API FDialogueExecutionReplayer
+{
+	/**
+	 * Run recorded execution without world and compare node sequence with recorded one
+	 * @param Dialogue	Dialogue to run recording against, loaded from recorded path when null
+	 * @return false if replay couldn't start
+	 */
+	static bool Replay(const FDialogueExecutionRecording& Recording, FDialogueReplayResult& OutResult, UDialogue* Dialogue = nullptr);
+};
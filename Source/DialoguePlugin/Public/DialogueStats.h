@@ -0,0 +1,68 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+
+DECLARE_STATS_GROUP(TEXT("Dialogue"), STATGROUP_Dialogue, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find Available Next Nodes"), STAT_Dialogue_FindAvailableNextNodes, STATGROUP_Dialogue, DIALOGUEPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Check Node Condition"), STAT_Dialogue_CheckNodeCondition, STATGROUP_Dialogue, DIALOGUEPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Condition"), STAT_Dialogue_Condition, STATGROUP_Dialogue, DIALOGUEPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Format Text"), STAT_Dialogue_FormatText, STATGROUP_Dialogue, DIALOGUEPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Execute Node Events"), STAT_Dialogue_ExecuteNodeEvents, STATGROUP_Dialogue, DIALOGUEPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Move To Node"), STAT_Dialogue_MoveToNode, STATGROUP_Dialogue, DIALOGUEPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Participant Callback"), STAT_Dialogue_ParticipantCallback, STATGROUP_Dialogue, DIALOGUEPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Context Callback"), STAT_Dialogue_ContextCallback, STATGROUP_Dialogue, DIALOGUEPLUGIN_API);
+
+UE_TRACE_CHANNEL_EXTERN(DialogueChannel, DIALOGUEPLUGIN_API);
+
+
+#if CPUPROFILERTRACE_ENABLED
+
+/**
+ * Insights timing scope on DialogueChannel
+ * Event name carries object and node id: "FormatText DLG_Intro #12"
+ * Name is built only while channel is enabled
+ */
+class DIALOGUEPLUGIN_API FDialogueInsightsScope
+{
+	bool bEnabled;
+
+public:
+	FORCEINLINE FDialogueInsightsScope(const TCHAR* Name, const UObject* Object, int32 NodeId)
+		: bEnabled(UE_TRACE_CHANNELEXPR_IS_ENABLED(DialogueChannel))
+	{
+		if (bEnabled)
+		{
+			Begin(Name, Object, NodeId);
+		}
+	}
+
+	FORCEINLINE ~FDialogueInsightsScope()
+	{
+		if (bEnabled)
+		{
+			FCpuProfilerTrace::OutputEndEvent();
+		}
+	}
+
+private:
+	static void Begin(const TCHAR* Name, const UObject* Object, int32 NodeId);
+};
+
+/**
+ * Cycle stat in STATGROUP_Dialogue and Insights scope on DialogueChannel
+ * @param	Object	Dialogue asset or condition class whose name is added to Insights event
+ */
+#define DIALOGUE_SCOPE_CYCLE_COUNTER(Stat, Name, Object, NodeId) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	FDialogueInsightsScope ANONYMOUS_VARIABLE(DialogueInsightsScope_)(TEXT(Name), Object, NodeId)
+
+#else
+
+#define DIALOGUE_SCOPE_CYCLE_COUNTER(Stat, Name, Object, NodeId) SCOPE_CYCLE_COUNTER(Stat)
+
+#endif // CPUPROFILERTRACE_ENABLED
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "DialogueLiteExecutor.h"
+#include "DialogueSubsystem.generated.h"
+
+class UDialogueExecutorBase;
+class UDialogueExecutor;
+
+
+USTRUCT()
+struct FDialogueExecutorPoolList
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<UDialogueExecutorBase*> Executors;
+};
+
+
+/** Deferred work item processed by subsystem batch pass */
+struct FDialoguePendingOperation
+{
+	enum class EType : uint8
+	{
+		/** UDialogueExecutor::FinishNodeExecution(NodeId) */
+		Transition,
+		/** UDialogueExecutorBase::FindAvailableNextNodes(NodeId) and Callback */
+		AvailableNodes,
+		/** UDialogueExecutorBase::ExecuteNodeEvents(NodeId) */
+		NodeEvents
+	};
+
+	EType Type;
+	TWeakObjectPtr<UDialogueExecutorBase> Executor;
+	int32 NodeId;
+	bool bStopOnFirst;
+	TFunction<void(const TArray<int32>&)> Callback;
+};
+
+
+/**
+ * World level owner of dialogue executors
+ * Keeps pool of released executors to reuse them instead of creating new objects
+ * Processes queued transitions, condition queries, event dispatch and lite executors in one batched pass per frame
+ */
+UCLASS()
+class DIALOGUEPLUGIN_API UDialogueSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	/** Released executors above this number are left to GC */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Dialogue)
+	int32 MaxPooledPerClass;
+
+	/** Time allowed for batch pass each frame. Work over budget continues next frame. Non-positive is unlimited */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Dialogue)
+	float FrameBudgetMs;
+
+	/** Lite executors processed between budget checks */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Dialogue)
+	int32 LiteExecutorBatchSize;
+
+private:
+	/** Released executors by class */
+	UPROPERTY()
+	TMap<UClass*, FDialogueExecutorPoolList> Pool;
+
+	/** Executors created through subsystem. Unreleased executors are left to GC, their entries are pruned on register */
+	TSet<TWeakObjectPtr<UDialogueExecutorBase>> RegisteredExecutors;
+
+	/** Registered number that triggers next prune, grows with live executors so pruning stays amortized */
+	int32 RegisteredPruneNum;
+
+	TArray<FDialoguePendingOperation> PendingOperations;
+
+	FDialogueLiteExecutorList LiteExecutors;
+
+	/** Lite executor list position to continue from */
+	int32 LiteExecutorCursor;
+
+public:
+	UDialogueSubsystem();
+
+	virtual void Deinitialize() override;
+
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
+
+	static UDialogueSubsystem* Get(const UObject* WorldContextObject);
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual TStatId GetStatId() const override;
+	// FTickableGameObject end
+
+public:
+	/** 
+	 * Take executor from pool or create new one
+	 * Executor is created and registered, but not initialized
+	 */
+	UDialogueExecutorBase* AcquireExecutor(TSubclassOf<UDialogueExecutorBase> Class, UObject* Owner);
+
+	/** Reset executor state and return it to pool. Executor must not be used after release */
+	void ReleaseExecutor(UDialogueExecutorBase* Executor);
+
+	/** Drop all pooled executors */
+	void EmptyPool();
+
+	int32 GetPooledNum(TSubclassOf<UDialogueExecutorBase> Class) const;
+
+
+	void RegisterExecutor(UDialogueExecutorBase* Executor);
+	void UnregisterExecutor(UDialogueExecutorBase* Executor);
+	const TSet<TWeakObjectPtr<UDialogueExecutorBase>>& GetRegisteredExecutors() const { return RegisteredExecutors; }
+
+
+	/** FinishNodeExecution is called during next batch pass */
+	void QueueTransition(UDialogueExecutor* Executor, int32 NextNodeId);
+
+	/** Available children are evaluated during next batch pass and passed to callback */
+	void QueueAvailableNodesQuery(UDialogueExecutorBase* Executor, int32 NodeId, bool bStopOnFirst, TFunction<void(const TArray<int32>&)> Callback);
+
+	/** Node events are executed during next batch pass */
+	void QueueNodeEvents(UDialogueExecutorBase* Executor, int32 NodeId);
+
+	int32 GetPendingNum() const { return PendingOperations.Num(); }
+
+	/** Process all pending work ignoring budget */
+	void Flush();
+
+
+	FDialogueLiteExecutorList& GetLiteExecutors() { return LiteExecutors; }
+
+private:
+	/** @return	true if all work was processed */
+	bool ProcessBatch(double BudgetSeconds);
+};
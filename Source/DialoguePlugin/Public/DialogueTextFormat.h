@@ -0,0 +1,96 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/** Object that provides argument value */
+enum class EDialogueFormatTarget : uint8
+{
+	Executor,
+	Dialogue,
+	Participant,
+	Context,
+	/** Participant from executor map */
+	ParticipantKey
+};
+
+/** Supported function return types */
+enum class EDialogueFormatReturn : uint8
+{
+	None,
+	String,
+	Text,
+	Name,
+	Float,
+	Integer
+};
+
+
+/** Function resolved for specific target class */
+struct FDialogueFormatBinding
+{
+	TWeakObjectPtr<UClass> Class;
+	TWeakObjectPtr<UFunction> Function;
+	EDialogueFormatReturn ReturnType = EDialogueFormatReturn::None;
+
+	/** Invalid bindings are cached too, so errors are reported once per class */
+	bool IsValid() const { return ReturnType != EDialogueFormatReturn::None && Function.IsValid(); }
+};
+
+
+/** Argument in format {TargetName.FunctionName} */
+struct FDialogueFormatArgument
+{
+	FString Name;
+	EDialogueFormatTarget Target = EDialogueFormatTarget::ParticipantKey;
+	FName TargetName;
+	FName FunctionName;
+
+	/** Dialogue participant slot of TargetName, filled when plan is owned by dialogue */
+	int32 ParticipantSlot = INDEX_NONE;
+
+	TArray<FDialogueFormatBinding, TInlineAllocator<2>> Bindings;
+
+	/** Returns nullptr if class was never resolved */
+	FDialogueFormatBinding* FindBinding(const UClass* Class)
+	{
+		for (FDialogueFormatBinding& Binding : Bindings)
+		{
+			if (Binding.Class.Get() == Class)
+			{
+				return &Binding;
+			}
+		}
+		return nullptr;
+	}
+};
+
+
+/** 
+ * Parsed text with pre-split arguments and cached function bindings
+ * Only function calls and final FText::Format are left to do at runtime
+ */
+struct DIALOGUEPLUGIN_API FDialogueFormatPlan
+{
+	FText SourceText;
+	FTextFormat Format;
+	uint16 TextRevision = 0;
+
+	TArray<FDialogueFormatArgument> Arguments;
+
+	/** Arguments that are not in format {TargetName.FunctionName} */
+	TArray<FString> InvalidArguments;
+	bool bErrorsReported = false;
+
+public:
+	FDialogueFormatPlan() { }
+	explicit FDialogueFormatPlan(const FText& InText) { Build(InText); }
+
+	void Build(const FText& InText);
+
+	/** Plan is rebuilt when text or active culture changes */
+	bool IsBuiltFor(const FText& InText) const;
+
+	/** Resolve function on target class and classify its return type */
+	static FDialogueFormatBinding MakeBinding(UClass* Class, FName FunctionName, bool& bOutHasInput, int32& OutReturnNum);
+};
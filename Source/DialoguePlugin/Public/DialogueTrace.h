@@ -0,0 +1,190 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Atomic.h"
+
+#ifndef DIALOGUE_TRACE_ENABLED
+	#define DIALOGUE_TRACE_ENABLED !UE_BUILD_SHIPPING
+#endif
+
+class UDialogueExecutorBase;
+
+
+enum class EDialogueTraceEvent : uint8
+{
+	None,
+	ExecutionBegin,
+	ExecutionEnd,
+	NodeEnter,
+	NodeLeave,
+	NodeExecutionBegin,
+	NodeExecutionEnd,
+	/** Value is check result, Duration is time spent in condition */
+	Condition,
+	/** Jump to other dialogue was followed, NodeId is target node. Described by FDialogueTraceExecution with same cycles */
+	DialogueSwitch,
+};
+
+/** Single fixed size trace event */
+struct FDialogueTraceRecord
+{
+	/** Bytes written by operator<< */
+	static const int32 SerializedSize = sizeof(uint64) + sizeof(uint32) * 2 + sizeof(int32) + sizeof(uint8) * 2;
+
+	/** FPlatformTime::Cycles64 when event was recorded */
+	uint64 Cycles;
+
+	/** Cycles spent by traced operation, saturated */
+	uint32 Duration;
+
+	/** UniqueID of executor */
+	uint32 ExecutorId;
+
+	int32 NodeId;
+
+	EDialogueTraceEvent Event;
+
+	uint8 Value;
+
+	FDialogueTraceRecord()
+		: Cycles(0)
+		, Duration(0)
+		, ExecutorId(0)
+		, NodeId(INDEX_NONE)
+		, Event(EDialogueTraceEvent::None)
+		, Value(0)
+	{ }
+
+	friend FArchive& operator<<(FArchive& Ar, FDialogueTraceRecord& Record)
+	{
+		uint8 EventValue = (uint8)Record.Event;
+		Ar << Record.Cycles << Record.Duration << Record.ExecutorId << Record.NodeId << EventValue << Record.Value;
+		Record.Event = (EDialogueTraceEvent)EventValue;
+		return Ar;
+	}
+};
+
+/** Executor description, written once per execution and once per dialogue switch */
+struct FDialogueTraceExecution
+{
+	/** Bytes written by operator<< when all strings are empty */
+	static const int32 MinSerializedSize = sizeof(uint32) + sizeof(uint64) + sizeof(int32) * 3;
+
+	uint32 ExecutorId;
+
+	/** Cycles of matching ExecutionBegin record */
+	uint64 Cycles;
+
+	FString ExecutorName;
+	FString DialoguePath;
+	FName EntryPoint;
+
+	FDialogueTraceExecution()
+		: ExecutorId(0)
+		, Cycles(0)
+	{ }
+
+	friend FArchive& operator<<(FArchive& Ar, FDialogueTraceExecution& Execution)
+	{
+		// File archives don't serialize names, entry point is written as string
+		FString EntryPointString = Execution.EntryPoint.ToString();
+		Ar << Execution.ExecutorId << Execution.Cycles << Execution.ExecutorName << Execution.DialoguePath << EntryPointString;
+		if (Ar.IsLoading())
+		{
+			Execution.EntryPoint = FName(*EntryPointString);
+		}
+		return Ar;
+	}
+};
+
+
+#if DIALOGUE_TRACE_ENABLED
+
+/**
+ * Opt-in binary execution trace, enabled by dialogue.Trace
+ * Records are pushed to lock-free queue and written to file by background thread
+ * Records are dropped when queue is full, drop count is reported when trace stops
+ * Producers may run on any thread, Start and Stop are game thread only
+ */
+class DIALOGUEPLUGIN_API FDialogueTrace
+{
+public:
+	static FORCEINLINE bool IsEnabled() { return bEnabled.Load(EMemoryOrder::Relaxed); }
+
+	/** Start writing trace. Uses dialogue.TraceFile or default file in profiling dir when FilePath is empty */
+	static bool Start(const FString& FilePath = FString());
+	static void Stop();
+
+	static FString GetFilePath();
+
+	static void Record(EDialogueTraceEvent Event, const UDialogueExecutorBase* Executor, int32 NodeId, uint8 Value = 0, uint64 StartCycles = 0);
+	static void RecordExecutionBegin(const UDialogueExecutorBase* Executor, int32 NodeId, FName EntryPoint);
+
+	/** Executor dialogue must already be switched */
+	static void RecordDialogueSwitch(const UDialogueExecutorBase* Executor, int32 NodeId, FName EntryPoint);
+
+private:
+	/** Event record together with executor description */
+	static void RecordExecution(EDialogueTraceEvent Event, const UDialogueExecutorBase* Executor, int32 NodeId, FName EntryPoint);
+
+	static TAtomic<bool> bEnabled;
+};
+
+
+/** Execution of single executor from ExecutionBegin to ExecutionEnd */
+struct DIALOGUEPLUGIN_API FDialogueTraceSession
+{
+	FDialogueTraceExecution Execution;
+	TArray<FDialogueTraceRecord> Records;
+
+	/** Descriptions of DialogueSwitch records in order */
+	TArray<FDialogueTraceExecution> DialogueSwitches;
+
+	/** Execution began in or jumped to dialogue */
+	bool HasDialogue(const FString& DialoguePath) const;
+
+	/** Total cycles spent in conditions */
+	uint64 GetConditionCycles() const;
+};
+
+/** Loaded trace file */
+struct DIALOGUEPLUGIN_API FDialogueTraceFile
+{
+	static const uint32 Magic = 0x54474C44; // DLGT
+	static const uint32 Version = 3;
+
+	/** Earlier files were written without entry points */
+	static const uint32 MinVersion = 3;
+
+	enum EChunkType : uint8
+	{
+		Chunk_Records = 1,
+		Chunk_Executions = 2,
+	};
+
+	double SecondsPerCycle;
+	TArray<FDialogueTraceSession> Sessions;
+
+	FDialogueTraceFile()
+		: SecondsPerCycle(0.0)
+	{ }
+
+	bool Load(const FString& FilePath, FString* OutError = nullptr);
+};
+
+
+#define DIALOGUE_TRACE(Event, NodeId) do { if (FDialogueTrace::IsEnabled()) { FDialogueTrace::Record(EDialogueTraceEvent::Event, this, NodeId); } } while (0)
+#define DIALOGUE_TRACE_EXECUTION_BEGIN(NodeId, EntryPoint) do { if (FDialogueTrace::IsEnabled()) { FDialogueTrace::RecordExecutionBegin(this, NodeId, EntryPoint); } } while (0)
+#define DIALOGUE_TRACE_DIALOGUE_SWITCH(NodeId, EntryPoint) do { if (FDialogueTrace::IsEnabled()) { FDialogueTrace::RecordDialogueSwitch(this, NodeId, EntryPoint); } } while (0)
+#define DIALOGUE_TRACE_TIMER(Timer) const uint64 Timer = FDialogueTrace::IsEnabled() ? FPlatformTime::Cycles64() : 0
+#define DIALOGUE_TRACE_CONDITION(NodeId, bResult, Timer) do { if (FDialogueTrace::IsEnabled()) { FDialogueTrace::Record(EDialogueTraceEvent::Condition, this, NodeId, (bResult) ? 1 : 0, Timer); } } while (0)
+
+#else
+
+#define DIALOGUE_TRACE(Event, NodeId)
+#define DIALOGUE_TRACE_EXECUTION_BEGIN(NodeId, EntryPoint)
+#define DIALOGUE_TRACE_DIALOGUE_SWITCH(NodeId, EntryPoint)
+#define DIALOGUE_TRACE_TIMER(Timer)
+#define DIALOGUE_TRACE_CONDITION(NodeId, bResult, Timer)
+
+#endif // DIALOGUE_TRACE_ENABLED
@@ -38,6 +38,8 @@ public class DialoguePluginEditor : ModuleRules
                 "GraphEditor",
 				"ApplicationCore",
 				"ToolMenus",
+				"DesktopPlatform",
+				"Json",
 			}
 			);	
 		
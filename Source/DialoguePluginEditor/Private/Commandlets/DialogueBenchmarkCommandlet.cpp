@@ -0,0 +1,532 @@
+#include "DialogueBenchmarkCommandlet.h"
+#include "Dialogue.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/MemoryBase.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Math/RandomStream.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "UObject/Package.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogDialogueBenchmark, Log, All);
+
+
+int64 UDialogueBenchmarkCondition::EvaluationNum = 0;
+
+bool UDialogueBenchmarkCondition::IsConditionMet(UObject* WorldContext) const
+{
+	EvaluationNum++;
+	return bResult;
+}
+
+
+int32 UDialogueBenchmarkExecutor::GetBenchmarkInt() const
+{
+	return CurrentNodeId;
+}
+
+float UDialogueBenchmarkExecutor::GetBenchmarkFloat() const
+{
+	return CurrentNodeId * 0.5f;
+}
+
+FString UDialogueBenchmarkExecutor::GetBenchmarkString() const
+{
+	return GetName();
+}
+
+FText UDialogueBenchmarkExecutor::GetBenchmarkText() const
+{
+	return FText::AsCultureInvariant(GetName());
+}
+
+void UDialogueBenchmarkExecutor::NodeExecutionBegin_Implementation()
+{
+	if (Dialogue)
+	{
+		FText Text;
+		FormatText(Dialogue->GetNodeText(CurrentNodeId), CurrentNodeId, Text);
+		FormatNum++;
+	}
+}
+
+
+
+namespace DialogueBenchmark
+{
+	struct FCounters
+	{
+		int64 TransitionNum = 0;
+		int64 FindNum = 0;
+		int64 ConditionNum = 0;
+		int64 FormatNum = 0;
+		uint64 AllocationNum = 0;
+		double Seconds = 0.0;
+	};
+
+
+	/**
+	 * Forwards to wrapped allocator and counts allocations of measuring thread
+	 * Installed on first use and never removed or freed, other threads may be inside it or hold GMalloc read before swap
+	 */
+	class FCountingMalloc final : public FMalloc
+	{
+		FMalloc* Inner;
+
+		/** Thread allocations are counted on, 0 when not counting */
+		TAtomic<uint32> CountingThreadId;
+
+		/** Only written by counting thread */
+		uint64 AllocationNum;
+
+		explicit FCountingMalloc(FMalloc* InInner)
+			: Inner(InInner)
+			, CountingThreadId(0)
+			, AllocationNum(0)
+		{ }
+
+		FORCEINLINE void Count()
+		{
+			if (CountingThreadId.Load(EMemoryOrder::Relaxed) == FPlatformTLS::GetCurrentThreadId())
+			{
+				AllocationNum++;
+			}
+		}
+
+	public:
+		static FCountingMalloc& Get()
+		{
+			check(IsInGameThread());
+			static FCountingMalloc* Instance = nullptr;
+			if (!Instance)
+			{
+				Instance = new FCountingMalloc(GMalloc);
+				FPlatformMisc::MemoryBarrier();
+				GMalloc = Instance;
+			}
+			return *Instance;
+		}
+
+		/** Count allocations of calling thread until EndCounting */
+		void BeginCounting()
+		{
+			AllocationNum = 0;
+			CountingThreadId = FPlatformTLS::GetCurrentThreadId();
+		}
+
+		uint64 EndCounting()
+		{
+			CountingThreadId = 0;
+			return AllocationNum;
+		}
+
+		virtual void* Malloc(SIZE_T Size, uint32 Alignment) override
+		{
+			Count();
+			return Inner->Malloc(Size, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Size, uint32 Alignment) override
+		{
+			if (Size > 0)
+			{
+				Count();
+			}
+			return Inner->Realloc(Original, Size, Alignment);
+		}
+
+		virtual void Free(void* Original) override { Inner->Free(Original); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+		virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+		virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+		virtual const TCHAR* GetDescriptiveName() override { return TEXT("DialogueBenchmark"); }
+	};
+
+
+	void FParams::Parse(const TCHAR* Params)
+	{
+		FParse::Value(Params, TEXT("Dialogues="), DialogueNum);
+		FParse::Value(Params, TEXT("Nodes="), NodeNum);
+		FParse::Value(Params, TEXT("Branching="), Branching);
+		FParse::Value(Params, TEXT("ConditionDepth="), ConditionDepth);
+		FParse::Value(Params, TEXT("FormatArgs="), FormatArgNum);
+		FParse::Value(Params, TEXT("Participants="), ParticipantNum);
+		FParse::Value(Params, TEXT("Walks="), WalkNum);
+		FParse::Value(Params, TEXT("Warmup="), WarmupWalkNum);
+		FParse::Value(Params, TEXT("MaxSteps="), MaxSteps);
+		FParse::Value(Params, TEXT("Seed="), Seed);
+		FParse::Value(Params, TEXT("Output="), OutputPath);
+		bCountAllocations = !FParse::Param(Params, TEXT("NoAllocCount"));
+		FParse::Value(Params, TEXT("Baseline="), BaselinePath);
+		FParse::Value(Params, TEXT("Threshold="), Threshold);
+		bWriteBaseline = FParse::Param(Params, TEXT("WriteBaseline"));
+
+		DialogueNum = FMath::Max(1, DialogueNum);
+		NodeNum = FMath::Max(1, NodeNum);
+		Branching = FMath::Max(0, Branching);
+		ConditionDepth = FMath::Max(0, ConditionDepth);
+		ParticipantNum = FMath::Max(0, ParticipantNum);
+	}
+
+
+	FName MakeParticipantKey(int32 Index)
+	{
+		return FName(TEXT("Speaker"), Index + 1);
+	}
+
+	/** Junction types alternate by depth so both short-circuit paths are exercised */
+	UDialogueCondition* MakeCondition(UDialogue* Dialogue, int32 Depth, FRandomStream& Random)
+	{
+		if (Depth <= 0)
+		{
+			return nullptr;
+		}
+
+		if (Depth == 1)
+		{
+			UDialogueBenchmarkCondition* Leaf = NewObject<UDialogueBenchmarkCondition>(Dialogue);
+			Leaf->bResult = Random.FRand() < 0.8f;
+			return Leaf;
+		}
+
+		TArray<UDialogueCondition*> Conditions;
+		Conditions.Add(MakeCondition(Dialogue, Depth - 1, Random));
+		Conditions.Add(MakeCondition(Dialogue, Depth - 1, Random));
+
+		if (Depth % 2 == 0)
+		{
+			UDialogueCondition_AND* Junction = NewObject<UDialogueCondition_AND>(Dialogue);
+			Junction->Conditions = Conditions;
+			return Junction;
+		}
+
+		UDialogueCondition_OR* Junction = NewObject<UDialogueCondition_OR>(Dialogue);
+		Junction->Conditions = Conditions;
+		return Junction;
+	}
+
+	UDialogue* MakeDialogue(const FParams& Params, int32 DialogueIndex, FRandomStream& Random)
+	{
+		static const TCHAR* ArgumentTemplates[] =
+		{
+			TEXT("{Executor.GetBenchmarkInt}"),
+			TEXT("{Executor.GetBenchmarkFloat}"),
+			TEXT("{Executor.GetBenchmarkString}"),
+			TEXT("{Executor.GetBenchmarkText}"),
+			TEXT("{Participant.GetParticipantName}"),
+		};
+		const int32 TemplateNum = Params.ParticipantNum > 0 ? UE_ARRAY_COUNT(ArgumentTemplates) : UE_ARRAY_COUNT(ArgumentTemplates) - 1;
+
+		UDialogue* Dialogue = NewObject<UDialogue>(GetTransientPackage(), *FString::Printf(TEXT("DialogueBenchmark_%d"), DialogueIndex), RF_Transient);
+
+		// Children are ahead of node, graph is acyclic and walks end near last nodes
+		const int32 ChildWindow = FMath::Max(Params.Branching * 4, 8);
+
+		TMap<int32, FDialogueNode> Nodes;
+		Nodes.Reserve(Params.NodeNum);
+		for (int32 NodeId = 0; NodeId < Params.NodeNum; NodeId++)
+		{
+			FDialogueNode& Node = Nodes.Add(NodeId);
+			Node.NodeID = NodeId;
+
+			FString Text = FString::Printf(TEXT("Line %d"), NodeId);
+			for (int32 ArgIndex = 0; ArgIndex < FMath::Min(Params.FormatArgNum, TemplateNum); ArgIndex++)
+			{
+				Text += TEXT(" ");
+				Text += ArgumentTemplates[ArgIndex];
+			}
+			Node.Text = FText::AsCultureInvariant(Text);
+
+			if (Params.ParticipantNum > 0)
+			{
+				Node.Participant = FDialogueParticipant(MakeParticipantKey(Random.RandHelper(Params.ParticipantNum)));
+			}
+
+			if (NodeId > 0)
+			{
+				Node.Condition = MakeCondition(Dialogue, Params.ConditionDepth, Random);
+			}
+
+			for (int32 ChildIndex = 0; ChildIndex < Params.Branching; ChildIndex++)
+			{
+				const int32 ChildId = NodeId + 1 + Random.RandHelper(ChildWindow);
+				if (ChildId < Params.NodeNum)
+				{
+					Node.Children.AddUnique(ChildId);
+				}
+			}
+		}
+
+		TMap<FName, int32> Entries;
+		Entries.Add(NAME_None, 0);
+
+		FDialogueEditorStruct(Dialogue).SetNodes(Nodes, Entries);
+		return Dialogue;
+	}
+
+	bool CompareWithBaseline(const FJsonObject& Report, const FJsonObject& Baseline, double Threshold)
+	{
+		const TSharedPtr<FJsonObject>* BaselineConfig = nullptr;
+		if (!Baseline.TryGetObjectField(TEXT("config"), BaselineConfig))
+		{
+			UE_LOG(LogDialogueBenchmark, Error, TEXT("Baseline has no config"));
+			return false;
+		}
+
+		for (const auto& Pair : Report.GetObjectField(TEXT("config"))->Values)
+		{
+			double BaselineValue = 0.0;
+			if (!(*BaselineConfig)->TryGetNumberField(Pair.Key, BaselineValue) || BaselineValue != Pair.Value->AsNumber())
+			{
+				UE_LOG(LogDialogueBenchmark, Error, TEXT("Baseline was recorded with different %s"), *Pair.Key);
+				return false;
+			}
+		}
+
+		struct FMetric
+		{
+			const TCHAR* Name;
+			bool bHigherIsBetter;
+		};
+		static const FMetric Metrics[] =
+		{
+			{ TEXT("transitionsPerSec"), true },
+			{ TEXT("conditionEvalsPerSec"), true },
+			{ TEXT("formatTextPerSec"), true },
+			{ TEXT("allocationsPerTransition"), false },
+		};
+
+		bool bPassed = true;
+		for (const FMetric& Metric : Metrics)
+		{
+			double Current = 0.0;
+			double Expected = 0.0;
+			if (!Report.TryGetNumberField(Metric.Name, Current) || !Baseline.TryGetNumberField(Metric.Name, Expected))
+			{
+				continue;
+			}
+
+			bool bRegressed;
+			if (Expected > 0.0)
+			{
+				const double Change = (Current - Expected) / Expected;
+				bRegressed = Metric.bHigherIsBetter ? Change < -Threshold : Change > Threshold;
+			}
+			else
+			{
+				bRegressed = !Metric.bHigherIsBetter && Current > 0.0;
+			}
+
+			if (bRegressed)
+			{
+				UE_LOG(LogDialogueBenchmark, Error, TEXT("%s regressed: %.3f, baseline %.3f"), Metric.Name, Current, Expected);
+				bPassed = false;
+			}
+			else
+			{
+				UE_LOG(LogDialogueBenchmark, Display, TEXT("%s: %.3f, baseline %.3f"), Metric.Name, Current, Expected);
+			}
+		}
+
+		return bPassed;
+	}
+
+	bool CheckBaseline(const TSharedRef<FJsonObject>& Report, const FString& BaselinePath, double Threshold, bool bWriteBaseline)
+	{
+		if (bWriteBaseline)
+		{
+			FString Json;
+			FJsonSerializer::Serialize(Report, TJsonWriterFactory<>::Create(&Json));
+			if (!FFileHelper::SaveStringToFile(Json, *BaselinePath))
+			{
+				UE_LOG(LogDialogueBenchmark, Error, TEXT("Failed to write benchmark baseline to %s"), *BaselinePath);
+				return false;
+			}
+			return true;
+		}
+
+		FString BaselineJson;
+		TSharedPtr<FJsonObject> Baseline;
+		if (!FFileHelper::LoadFileToString(BaselineJson, *BaselinePath)
+			|| !FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(BaselineJson), Baseline) || !Baseline.IsValid())
+		{
+			UE_LOG(LogDialogueBenchmark, Error, TEXT("Failed to read benchmark baseline %s"), *BaselinePath);
+			return false;
+		}
+		return CompareWithBaseline(*Report, *Baseline, Threshold);
+	}
+
+	void RunWalks(UDialogueBenchmarkExecutor* Executor, const TArray<UDialogue*>& Dialogues, int32 WalkNum, int32 MaxSteps, FRandomStream& Random, FCounters& Counters)
+	{
+		for (int32 WalkIndex = 0; WalkIndex < WalkNum; WalkIndex++)
+		{
+			Executor->SetDialogue(Dialogues[Random.RandHelper(Dialogues.Num())]);
+			if (!Executor->BeginExecution(NAME_None))
+			{
+				continue;
+			}
+
+			for (int32 Step = 0; Step < MaxSteps && Executor->IsExecutionInProgress(); Step++)
+			{
+				const TArray<int32> Available = Executor->FindAvailableNextNodes(Executor->GetCurrentNodeId(), false);
+				Counters.FindNum++;
+
+				const int32 NextNodeId = Available.Num() > 0 ? Available[Random.RandHelper(Available.Num())] : INDEX_NONE;
+				Executor->FinishNodeExecution(NextNodeId);
+
+				if (NextNodeId != INDEX_NONE)
+				{
+					Counters.TransitionNum++;
+				}
+			}
+
+			Executor->StopExecution();
+		}
+	}
+
+	TSharedRef<FJsonObject> Run(const FParams& Settings)
+	{
+		FRandomStream Random(Settings.Seed);
+
+		TArray<UDialogue*> Dialogues;
+		for (int32 Index = 0; Index < Settings.DialogueNum; Index++)
+		{
+			UDialogue* Dialogue = MakeDialogue(Settings, Index, Random);
+			Dialogue->AddToRoot();
+			Dialogues.Add(Dialogue);
+		}
+
+		UDialogueBenchmarkExecutor* Executor = NewObject<UDialogueBenchmarkExecutor>(GetTransientPackage());
+		Executor->HandleCreated();
+		Executor->Initialize();
+		Executor->AddToRoot();
+
+		TArray<UDialogueBenchmarkParticipant*> Participants;
+		for (int32 Index = 0; Index < Settings.ParticipantNum; Index++)
+		{
+			UDialogueBenchmarkParticipant* Participant = NewObject<UDialogueBenchmarkParticipant>(GetTransientPackage());
+			Participant->Key = MakeParticipantKey(Index);
+			Participant->AddToRoot();
+			Participants.Add(Participant);
+
+			Executor->SetParticipant(Participant->Key, Participant);
+		}
+
+		// Warmup builds format plans and function bindings
+		FCounters Warmup;
+		RunWalks(Executor, Dialogues, Settings.WarmupWalkNum, Settings.MaxSteps, Random, Warmup);
+
+		FCounters Counters;
+		Executor->FormatNum = 0;
+		UDialogueBenchmarkCondition::EvaluationNum = 0;
+
+		FCountingMalloc* CountingMalloc = Settings.bCountAllocations ? &FCountingMalloc::Get() : nullptr;
+		if (CountingMalloc)
+		{
+			CountingMalloc->BeginCounting();
+		}
+
+		const double StartTime = FPlatformTime::Seconds();
+		RunWalks(Executor, Dialogues, Settings.WalkNum, Settings.MaxSteps, Random, Counters);
+		Counters.Seconds = FPlatformTime::Seconds() - StartTime;
+
+		if (CountingMalloc)
+		{
+			Counters.AllocationNum = CountingMalloc->EndCounting();
+		}
+
+		Counters.ConditionNum = UDialogueBenchmarkCondition::EvaluationNum;
+		Counters.FormatNum = Executor->FormatNum;
+
+		Executor->ResetExecutor();
+		Executor->RemoveFromRoot();
+		for (UDialogueBenchmarkParticipant* Participant : Participants)
+		{
+			Participant->RemoveFromRoot();
+		}
+		for (UDialogue* Dialogue : Dialogues)
+		{
+			Dialogue->RemoveFromRoot();
+		}
+
+		auto PerSecond = [&Counters](int64 Value)
+		{
+			return Counters.Seconds > 0.0 ? Value / Counters.Seconds : 0.0;
+		};
+
+		TSharedRef<FJsonObject> Config = MakeShared<FJsonObject>();
+		Config->SetNumberField(TEXT("dialogues"), Settings.DialogueNum);
+		Config->SetNumberField(TEXT("nodes"), Settings.NodeNum);
+		Config->SetNumberField(TEXT("branching"), Settings.Branching);
+		Config->SetNumberField(TEXT("conditionDepth"), Settings.ConditionDepth);
+		Config->SetNumberField(TEXT("formatArgs"), Settings.FormatArgNum);
+		Config->SetNumberField(TEXT("participants"), Settings.ParticipantNum);
+		Config->SetNumberField(TEXT("walks"), Settings.WalkNum);
+		Config->SetNumberField(TEXT("maxSteps"), Settings.MaxSteps);
+		Config->SetNumberField(TEXT("seed"), Settings.Seed);
+
+		TSharedRef<FJsonObject> Report = MakeShared<FJsonObject>();
+		Report->SetObjectField(TEXT("config"), Config);
+		Report->SetNumberField(TEXT("seconds"), Counters.Seconds);
+		Report->SetNumberField(TEXT("transitions"), Counters.TransitionNum);
+		Report->SetNumberField(TEXT("childSearches"), Counters.FindNum);
+		Report->SetNumberField(TEXT("conditionEvals"), Counters.ConditionNum);
+		Report->SetNumberField(TEXT("formatTexts"), Counters.FormatNum);
+		Report->SetNumberField(TEXT("transitionsPerSec"), PerSecond(Counters.TransitionNum));
+		Report->SetNumberField(TEXT("conditionEvalsPerSec"), PerSecond(Counters.ConditionNum));
+		Report->SetNumberField(TEXT("formatTextPerSec"), PerSecond(Counters.FormatNum));
+		if (Settings.bCountAllocations)
+		{
+			Report->SetNumberField(TEXT("allocations"), (double)Counters.AllocationNum);
+			Report->SetNumberField(TEXT("allocationsPerTransition"), Counters.TransitionNum > 0 ? (double)Counters.AllocationNum / Counters.TransitionNum : 0.0);
+		}
+
+		return Report;
+	}
+}
+
+
+UDialogueBenchmarkCommandlet::UDialogueBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UDialogueBenchmarkCommandlet::Main(const FString& Params)
+{
+	using namespace DialogueBenchmark;
+
+	FParams Settings;
+	Settings.Parse(*Params);
+
+	TSharedRef<FJsonObject> Report = Run(Settings);
+
+	FString Json;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(Report, Writer);
+
+	UE_LOG(LogDialogueBenchmark, Display, TEXT("%s"), *Json);
+
+	int32 Result = 0;
+	if (!Settings.OutputPath.IsEmpty() && !FFileHelper::SaveStringToFile(Json, *Settings.OutputPath))
+	{
+		UE_LOG(LogDialogueBenchmark, Error, TEXT("Failed to write benchmark report to %s"), *Settings.OutputPath);
+		Result = 1;
+	}
+
+	if (!Settings.BaselinePath.IsEmpty() && !CheckBaseline(Report, Settings.BaselinePath, Settings.Threshold, Settings.bWriteBaseline))
+	{
+		Result = 1;
+	}
+
+	return Result;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DialogueExecutor.h"
+#include "DialogueCondition.h"
+#include "DialogueParticipantInterface.h"
+#include "DialogueBenchmarkCommandlet.generated.h"
+
+class FJsonObject;
+
+
+/** Generated dialogue walks shared by benchmark commandlet and automation perf tests */
+namespace DialogueBenchmark
+{
+	struct FParams
+	{
+		int32 DialogueNum = 4;
+		int32 NodeNum = 1000;
+		int32 Branching = 3;
+		int32 ConditionDepth = 2;
+		int32 FormatArgNum = 2;
+		int32 ParticipantNum = 4;
+		int32 WalkNum = 1000;
+		int32 WarmupWalkNum = 50;
+		int32 MaxSteps = 200;
+		int32 Seed = 1;
+		bool bCountAllocations = true;
+		FString OutputPath;
+
+		FString BaselinePath;
+		float Threshold = 0.15f;
+		bool bWriteBaseline = false;
+
+		void Parse(const TCHAR* Params);
+	};
+
+	/** Dialogue with Params.NodeNum nodes, condition trees and format arguments. Children are ahead of node, so graph is acyclic */
+	UDialogue* MakeDialogue(const FParams& Params, int32 DialogueIndex, FRandomStream& Random);
+
+	/** Run warmup and measured walks, returns report with config and per second metrics */
+	TSharedRef<FJsonObject> Run(const FParams& Params);
+
+	/**
+	 * Compare report with stored one, baseline must be recorded with same config
+	 * @return false if any metric regressed beyond threshold
+	 */
+	bool CompareWithBaseline(const FJsonObject& Report, const FJsonObject& Baseline, double Threshold);
+
+	/** Compare report with baseline file, or store report as new baseline when bWriteBaseline is set */
+	bool CheckBaseline(const TSharedRef<FJsonObject>& Report, const FString& BaselinePath, double Threshold, bool bWriteBaseline);
+}
+
+
+/**
+ * Headless traversal benchmark over generated dialogues
+ * Usage: -run=DialogueBenchmark -nullrhi [-Dialogues=4] [-Nodes=1000] [-Branching=3] [-ConditionDepth=2] [-FormatArgs=2]
+ *        [-Participants=4] [-Walks=1000] [-MaxSteps=200] [-Seed=1] [-Output=File.json] [-NoAllocCount]
+ *        [-Baseline=Baseline.json [-Threshold=0.15] [-WriteBaseline]]
+ * Prints JSON report with transitions/sec, condition evaluations/sec, FormatText/sec and allocations per transition
+ * With baseline: fails when any metric regressed by more than Threshold fraction, -WriteBaseline stores current report instead
+ */
+UCLASS()
+class UDialogueBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UDialogueBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
+
+
+/** Executor driven by benchmark, formats node text on each node like presentation would */
+UCLASS(Transient, NotBlueprintable)
+class UDialogueBenchmarkExecutor : public UDialogueExecutor
+{
+	GENERATED_BODY()
+
+public:
+	int32 FormatNum = 0;
+
+	UFUNCTION()
+	int32 GetBenchmarkInt() const;
+
+	UFUNCTION()
+	float GetBenchmarkFloat() const;
+
+	UFUNCTION()
+	FString GetBenchmarkString() const;
+
+	UFUNCTION()
+	FText GetBenchmarkText() const;
+
+protected:
+	virtual void NodeExecutionBegin_Implementation() override;
+};
+
+
+/** Native leaf with fixed result, counts evaluations */
+UCLASS(NotBlueprintable, Transient)
+class UDialogueBenchmarkCondition : public UDialogueCondition
+{
+	GENERATED_BODY()
+
+public:
+	bool bResult = true;
+
+	static int64 EvaluationNum;
+
+protected:
+	virtual bool IsConditionMet(UObject* WorldContext) const override;
+};
+
+
+UCLASS(Transient)
+class UDialogueBenchmarkParticipant : public UObject, public IDialogueParticipantInterface
+{
+	GENERATED_BODY()
+
+public:
+	FName Key;
+
+protected:
+	virtual FName GetParticipantKey_Implementation() const override { return Key; }
+	virtual FText GetParticipantName_Implementation() const override { return FText::FromName(Key); }
+};
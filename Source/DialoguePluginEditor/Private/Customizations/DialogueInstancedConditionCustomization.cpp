@@ -0,0 +1,173 @@
+#include "DialogueInstancedConditionCustomization.h"
+#include "DialogueCondition.h"
+
+#include "PropertyEditing.h"
+#include "IPropertyUtilities.h"
+#include "UObject/StructOnScope.h"
+#include "UObject/UObjectIterator.h"
+#include "Framework/MultiBox/MultiBoxBuilder.h"
+#include "Widgets/Input/SComboButton.h"
+
+
+
+#define LOCTEXT_NAMESPACE "DialogueInstancedConditionCustomization"
+
+
+void FDialogueInstancedConditionCustomization::CustomizeHeader(TSharedRef<IPropertyHandle> PropertyHandle, FDetailWidgetRow& HeaderRow, IPropertyTypeCustomizationUtils& CustomizationUtils)
+{
+	StructPropertyHandle = PropertyHandle;
+	PropertyUtilities = CustomizationUtils.GetPropertyUtilities();
+	Condition = nullptr;
+	{
+		// Fields are edited only when all selected nodes share one instance
+		TArray<void*> RawStructData;
+		PropertyHandle->AccessRawData(RawStructData);
+		if (RawStructData.Num() == 1)
+		{
+			Condition = (FDialogueInstancedCondition*)(RawStructData[0]);
+		}
+	}
+
+	HeaderRow
+	.NameContent()
+	[
+		PropertyHandle->CreatePropertyNameWidget()
+	]
+	.ValueContent()
+	.MinDesiredWidth(200)
+	.MaxDesiredWidth(4096)
+	[
+		SNew(SComboButton)
+		.OnGetMenuContent(this, &FDialogueInstancedConditionCustomization::OnGetStructMenu)
+		.ButtonContent()
+		[
+			SNew(STextBlock)
+			.Font(CustomizationUtils.GetRegularFont())
+			.Text(this, &FDialogueInstancedConditionCustomization::GetStructText)
+		]
+	];
+}
+
+void FDialogueInstancedConditionCustomization::CustomizeChildren(TSharedRef<IPropertyHandle> PropertyHandle, IDetailChildrenBuilder& ChildBuilder, IPropertyTypeCustomizationUtils& CustomizationUtils)
+{
+	if (!Condition || !Condition->IsValid())
+	{
+		return;
+	}
+
+	const UScriptStruct* Struct = Condition->GetScriptStruct();
+	TSharedRef<FStructOnScope> StructData = MakeShared<FStructOnScope>(Struct, Condition->GetMutableMemory());
+
+	for (TFieldIterator<FProperty> It(Struct); It; ++It)
+	{
+		if (!It->HasAnyPropertyFlags(CPF_Edit))
+		{
+			continue;
+		}
+
+		IDetailPropertyRow* Row = ChildBuilder.AddExternalStructureProperty(StructData, It->GetFName());
+		if (Row && Row->GetPropertyHandle().IsValid())
+		{
+			Row->GetPropertyHandle()->SetOnPropertyValueChanged(FSimpleDelegate::CreateSP(this, &FDialogueInstancedConditionCustomization::OnChildChanged));
+			Row->GetPropertyHandle()->SetOnChildPropertyValueChanged(FSimpleDelegate::CreateSP(this, &FDialogueInstancedConditionCustomization::OnChildChanged));
+		}
+	}
+}
+
+TSharedRef<SWidget> FDialogueInstancedConditionCustomization::OnGetStructMenu()
+{
+	FMenuBuilder MenuBuilder(true, NULL);
+
+	FUIAction ClearAction(FExecuteAction::CreateSP(this, &FDialogueInstancedConditionCustomization::OnStructSelected, (const UScriptStruct*)nullptr));
+	MenuBuilder.AddMenuEntry(LOCTEXT("NoConditionStruct", "None"), TAttribute<FText>(), FSlateIcon(), ClearAction);
+
+	// Same rule as runtime container: only native structs derived from condition base
+	const UScriptStruct* BaseStruct = FDialogueConditionStruct::StaticStruct();
+	TArray<const UScriptStruct*> Structs;
+	for (TObjectIterator<UScriptStruct> It; It; ++It)
+	{
+		if (*It != BaseStruct && It->IsChildOf(BaseStruct) && It->GetCppStructOps() != nullptr)
+		{
+			Structs.Add(*It);
+		}
+	}
+	Structs.Sort([](const UScriptStruct& A, const UScriptStruct& B) { return A.GetDisplayNameText().CompareTo(B.GetDisplayNameText()) < 0; });
+
+	for (const UScriptStruct* Struct : Structs)
+	{
+		FUIAction ItemAction(FExecuteAction::CreateSP(this, &FDialogueInstancedConditionCustomization::OnStructSelected, Struct));
+		MenuBuilder.AddMenuEntry(Struct->GetDisplayNameText(), Struct->GetToolTipText(), FSlateIcon(), ItemAction);
+	}
+
+	return MenuBuilder.MakeWidget();
+}
+
+void FDialogueInstancedConditionCustomization::OnStructSelected(const UScriptStruct* NewStruct)
+{
+	if (!StructPropertyHandle.IsValid())
+	{
+		return;
+	}
+
+	StructPropertyHandle->NotifyPreChange();
+	{
+		TArray<void*> RawStructData;
+		StructPropertyHandle->AccessRawData(RawStructData);
+		for (void* Data : RawStructData)
+		{
+			FDialogueInstancedCondition* Instance = (FDialogueInstancedCondition*)Data;
+			if (Instance && Instance->GetScriptStruct() != NewStruct)
+			{
+				Instance->InitializeAs(NewStruct);
+			}
+		}
+	}
+	StructPropertyHandle->NotifyPostChange();
+	StructPropertyHandle->NotifyFinishedChangingProperties();
+
+	if (PropertyUtilities.IsValid())
+	{
+		PropertyUtilities->ForceRefresh();
+	}
+}
+
+FText FDialogueInstancedConditionCustomization::GetStructText() const
+{
+	if (!StructPropertyHandle.IsValid())
+	{
+		return FText::GetEmpty();
+	}
+
+	TArray<const void*> RawStructData;
+	StructPropertyHandle->AccessRawData(RawStructData);
+
+	const UScriptStruct* Struct = nullptr;
+	for (int32 Index = 0; Index < RawStructData.Num(); Index++)
+	{
+		const UScriptStruct* InstanceStruct = RawStructData[Index] ? ((const FDialogueInstancedCondition*)RawStructData[Index])->GetScriptStruct() : nullptr;
+		if (Index > 0 && InstanceStruct != Struct)
+		{
+			return LOCTEXT("MultipleConditionStructs", "Multiple Values");
+		}
+		Struct = InstanceStruct;
+	}
+
+	return Struct ? Struct->GetDisplayNameText() : LOCTEXT("NoConditionStruct", "None");
+}
+
+void FDialogueInstancedConditionCustomization::OnChildChanged()
+{
+	// Struct memory is edited directly, let owner node refresh and mark package dirty
+	if (StructPropertyHandle.IsValid())
+	{
+		TArray<UObject*> Outers;
+		StructPropertyHandle->GetOuterObjects(Outers);
+		for (UObject* Outer : Outers)
+		{
+			Outer->MarkPackageDirty();
+		}
+		StructPropertyHandle->NotifyFinishedChangingProperties();
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
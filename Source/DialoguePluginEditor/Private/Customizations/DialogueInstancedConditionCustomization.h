@@ -0,0 +1,33 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IDetailCustomization.h"
+
+class IPropertyHandle;
+class IPropertyUtilities;
+
+/** Picks struct condition type and shows its fields inline */
+class FDialogueInstancedConditionCustomization : public IPropertyTypeCustomization
+{
+public:
+	static TSharedRef< IPropertyTypeCustomization > MakeInstance()
+	{
+		return MakeShareable(new FDialogueInstancedConditionCustomization);
+	}
+
+	//~ Begin IPropertyTypeCustomization Interface
+	virtual void CustomizeHeader(TSharedRef<IPropertyHandle> PropertyHandle, FDetailWidgetRow& HeaderRow, IPropertyTypeCustomizationUtils& CustomizationUtils) override;
+	virtual void CustomizeChildren(TSharedRef<IPropertyHandle> PropertyHandle, IDetailChildrenBuilder& ChildBuilder, IPropertyTypeCustomizationUtils& CustomizationUtils) override;
+	//~ End IPropertyTypeCustomization Interface
+
+protected:
+	TSharedRef<SWidget> OnGetStructMenu();
+	void OnStructSelected(const UScriptStruct* NewStruct);
+	FText GetStructText() const;
+	void OnChildChanged();
+
+	TSharedPtr<IPropertyHandle> StructPropertyHandle;
+	TSharedPtr<IPropertyUtilities> PropertyUtilities;
+
+	struct FDialogueInstancedCondition* Condition;
+};
@@ -0,0 +1,84 @@
+#include "DialogueInstancedContextCustomization.h"
+#include "DialogueContext.h"
+
+#include "PropertyEditing.h"
+#include "UObject/StructOnScope.h"
+
+
+
+#define LOCTEXT_NAMESPACE "DialogueInstancedContextCustomization"
+
+
+void FDialogueInstancedContextCustomization::CustomizeHeader(TSharedRef<IPropertyHandle> PropertyHandle, FDetailWidgetRow& HeaderRow, IPropertyTypeCustomizationUtils& CustomizationUtils)
+{
+	StructPropertyHandle = PropertyHandle;
+	Context = nullptr;
+	{
+		// Fields are edited only when all selected nodes share one instance
+		TArray<void*> RawStructData;
+		PropertyHandle->AccessRawData(RawStructData);
+		if (RawStructData.Num() == 1)
+		{
+			Context = (FDialogueInstancedContext*)(RawStructData[0]);
+		}
+	}
+
+	const UScriptStruct* Struct = Context ? Context->GetScriptStruct() : nullptr;
+
+	HeaderRow
+	.NameContent()
+	[
+		PropertyHandle->CreatePropertyNameWidget()
+	]
+	.ValueContent()
+	.MinDesiredWidth(200)
+	.MaxDesiredWidth(4096)
+	[
+		SNew(STextBlock)
+		.Font(CustomizationUtils.GetRegularFont())
+		.Text(Struct ? Struct->GetDisplayNameText() : LOCTEXT("NoContextStruct", "None"))
+	];
+}
+
+void FDialogueInstancedContextCustomization::CustomizeChildren(TSharedRef<IPropertyHandle> PropertyHandle, IDetailChildrenBuilder& ChildBuilder, IPropertyTypeCustomizationUtils& CustomizationUtils)
+{
+	if (!Context || !Context->IsValid())
+	{
+		return;
+	}
+
+	const UScriptStruct* Struct = Context->GetScriptStruct();
+	TSharedRef<FStructOnScope> StructData = MakeShared<FStructOnScope>(Struct, Context->GetMutableMemory());
+
+	for (TFieldIterator<FProperty> It(Struct); It; ++It)
+	{
+		if (!It->HasAnyPropertyFlags(CPF_Edit))
+		{
+			continue;
+		}
+
+		IDetailPropertyRow* Row = ChildBuilder.AddExternalStructureProperty(StructData, It->GetFName());
+		if (Row && Row->GetPropertyHandle().IsValid())
+		{
+			Row->GetPropertyHandle()->SetOnPropertyValueChanged(FSimpleDelegate::CreateSP(this, &FDialogueInstancedContextCustomization::OnChildChanged));
+			Row->GetPropertyHandle()->SetOnChildPropertyValueChanged(FSimpleDelegate::CreateSP(this, &FDialogueInstancedContextCustomization::OnChildChanged));
+		}
+	}
+}
+
+void FDialogueInstancedContextCustomization::OnChildChanged()
+{
+	// Struct memory is edited directly, let owner node refresh and mark package dirty
+	if (StructPropertyHandle.IsValid())
+	{
+		TArray<UObject*> Outers;
+		StructPropertyHandle->GetOuterObjects(Outers);
+		for (UObject* Outer : Outers)
+		{
+			Outer->MarkPackageDirty();
+		}
+		StructPropertyHandle->NotifyFinishedChangingProperties();
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
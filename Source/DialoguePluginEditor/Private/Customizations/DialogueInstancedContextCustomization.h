@@ -0,0 +1,28 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IDetailCustomization.h"
+
+class IPropertyHandle;
+
+/** Shows struct node context fields inline. Struct type is set by dialogue NodeContextStruct */
+class FDialogueInstancedContextCustomization : public IPropertyTypeCustomization
+{
+public:
+	static TSharedRef< IPropertyTypeCustomization > MakeInstance()
+	{
+		return MakeShareable(new FDialogueInstancedContextCustomization);
+	}
+	
+	//~ Begin IPropertyTypeCustomization Interface
+	virtual void CustomizeHeader(TSharedRef<IPropertyHandle> PropertyHandle, FDetailWidgetRow& HeaderRow, IPropertyTypeCustomizationUtils& CustomizationUtils) override;
+	virtual void CustomizeChildren(TSharedRef<IPropertyHandle> PropertyHandle, IDetailChildrenBuilder& ChildBuilder, IPropertyTypeCustomizationUtils& CustomizationUtils) override;
+	//~ End IPropertyTypeCustomization Interface
+
+protected:
+	void OnChildChanged();
+
+	TSharedPtr<IPropertyHandle> StructPropertyHandle;
+
+	struct FDialogueInstancedContext* Context;
+};
@@ -91,8 +91,11 @@ void FDialogueNodeCustomization::CustomizeDetails(IDetailLayoutBuilder& DetailBu
 	}
 
 	MainCat.AddProperty(DetailBuilder.GetProperty("Node.Condition"));
+	MainCat.AddProperty(DetailBuilder.GetProperty("Node.ConditionStructs"));
+	MainCat.AddProperty(DetailBuilder.GetProperty("Node.SharedConditions"));
 	MainCat.AddProperty(DetailBuilder.GetProperty("Node.Events"));
 	MainCat.AddProperty(DetailBuilder.GetProperty("Node.Context")).Visibility(EVisibility::Collapsed);	
+	MainCat.AddProperty(DetailBuilder.GetProperty("Node.ContextStruct"));
 
 	if (Dialogue.IsValid() && !Dialogue->bUniformContext)
 	{
@@ -19,6 +19,11 @@
 #include "Customizations/DialogueParticipantCustomization.h"
 #include "DialogueParticipantRegistry.h"
 #include "Customizations/ExecutorSetupCustomization.h"
+#include "Customizations/DialogueInstancedContextCustomization.h"
+#include "Customizations/DialogueInstancedConditionCustomization.h"
+#include "DialogueBlueprintOverrides.h"
+#include "Editor.h"
+#include "Misc/CoreDelegates.h"
 
 
 
@@ -68,6 +73,16 @@ public:
 		// Register commands
 		FDialogueEditorCommands::Register();
 
+		// Blueprint event overrides may change on compile, editor is not created yet when module is loaded early
+		if (GEditor)
+		{
+			RegisterBlueprintCompileHook();
+		}
+		else
+		{
+			FCoreDelegates::OnPostEngineInit.AddRaw(this, &FDialoguePluginEditor::RegisterBlueprintCompileHook);
+		}
+
 		//GraphPanelNodeFactory_Dialogue = MakeShareable(new FGraphPanelNodeFactory_Dialogue());
 		//FEdGraphUtilities::RegisterVisualNodeFactory(GraphPanelNodeFactory_Dialogue);
 
@@ -86,6 +101,8 @@ public:
 			FPropertyEditorModule& PropertyModule = FModuleManager::LoadModuleChecked< FPropertyEditorModule >("PropertyEditor");
 			REG_CUSTOMIZATION(PropertyModule, FDialogueParticipant, FDialogueParticipantCustomization);
 			REG_CUSTOMIZATION(PropertyModule, FExecutorSetup, FExecutorSetupCustomization);
+			REG_CUSTOMIZATION(PropertyModule, FDialogueInstancedContext, FDialogueInstancedContextCustomization);
+			REG_CUSTOMIZATION(PropertyModule, FDialogueInstancedCondition, FDialogueInstancedConditionCustomization);
 			REG_CLASS_CUSTOMIZATION(PropertyModule, UEdGraphNode_DialogueNode, FDialogueNodeCustomization);
 		}
 	}
@@ -121,6 +138,12 @@ public:
 
 		RegisteredAssetActions.Empty();
 
+		FCoreDelegates::OnPostEngineInit.RemoveAll(this);
+		if (GEditor)
+		{
+			GEditor->OnBlueprintCompiled().RemoveAll(this);
+		}
+
 		// Unregister commands
 		FDialogueEditorCommands::Unregister();
 
@@ -130,6 +153,19 @@ public:
 
 private:
 
+	void RegisterBlueprintCompileHook()
+	{
+		if (GEditor)
+		{
+			GEditor->OnBlueprintCompiled().AddRaw(this, &FDialoguePluginEditor::OnBlueprintCompiled);
+		}
+	}
+
+	void OnBlueprintCompiled()
+	{
+		FDialogueBlueprintOverrides::Invalidate();
+	}
+
 	TSharedPtr<FDialogueParticipantRegistry> GetParticipantRegistry()
 	{
 		if (!ParticipantRegistry.IsValid())
@@ -531,6 +531,15 @@ void FAssetEditor_Dialogue::BindDebuggerCommands()
 		Commands.StepToEnd,
 		FExecuteAction::CreateSP(DebuggerOb, &FDialogueDebugger::StepToEnd),
 		FCanExecuteAction::CreateSP(DebuggerOb, &FDialogueDebugger::CanStepToEnd));
+
+	ToolkitCommands->MapAction(
+		Commands.OpenTrace,
+		FExecuteAction::CreateSP(DebuggerOb, &FDialogueDebugger::OpenTrace));
+
+	ToolkitCommands->MapAction(
+		Commands.UnloadTrace,
+		FExecuteAction::CreateSP(DebuggerOb, &FDialogueDebugger::UnloadTrace),
+		FCanExecuteAction::CreateSP(DebuggerOb, &FDialogueDebugger::CanUnloadTrace));
 }
 
 void FAssetEditor_Dialogue::ExtendToolbar()
@@ -544,6 +553,12 @@ void FAssetEditor_Dialogue::ExtendToolbar()
 
 			ToolbarBuilder.BeginSection("Debugger");
 			{			
+				ToolbarBuilder.AddToolBarButton(FDialogueDebuggerCommands::Get().OpenTrace);
+				if (EditorPtr->IsDebuggerTraceLoaded())
+				{
+					ToolbarBuilder.AddToolBarButton(FDialogueDebuggerCommands::Get().UnloadTrace);
+				}
+
 				const bool bCanShowDebugger = EditorPtr->IsDebuggerReady();
 				if (bCanShowDebugger)
 				{
@@ -699,6 +714,11 @@ bool FAssetEditor_Dialogue::IsDebuggerReady() const
 	return Debugger.IsValid() && Debugger->IsDebuggerReady();
 }
 
+bool FAssetEditor_Dialogue::IsDebuggerTraceLoaded() const
+{
+	return Debugger.IsValid() && Debugger->IsTraceLoaded();
+}
+
 FText FAssetEditor_Dialogue::GetDebuggerDesc() const
 {
 	return Debugger.IsValid() ? FText::FromString(Debugger->GetDebuggedInstanceDesc()) : FText::GetEmpty();
@@ -726,8 +746,24 @@ TSharedRef<class SWidget> FAssetEditor_Dialogue::OnGetDebuggerActorsMenu()
 			}
 		}
 
+		TArray<int32> MatchingSessions;
+		Debugger->GetMatchingTraceSessions(MatchingSessions);
+
+		if (MatchingSessions.Num() > 0)
+		{
+			MenuBuilder.BeginSection("Trace", LOCTEXT("TraceSessions", "Trace"));
+			for (int32 SessionIndex : MatchingSessions)
+			{
+				const FText Desc = FText::FromString(Debugger->DescribeTraceSession(SessionIndex));
+
+				FUIAction ItemAction(FExecuteAction::CreateSP(this, &FAssetEditor_Dialogue::OnDebuggerTraceSessionSelected, SessionIndex));
+				MenuBuilder.AddMenuEntry(Desc, TAttribute<FText>(), FSlateIcon(), ItemAction);
+			}
+			MenuBuilder.EndSection();
+		}
+
 		// Failsafe when no match
-		if (MatchingInstances.Num() == 0)
+		if (MatchingInstances.Num() == 0 && MatchingSessions.Num() == 0)
 		{
 			const FText Desc = LOCTEXT("NoMatchForDebug", "Can't find matching executors");
 			TWeakObjectPtr<UDialogueExecutorBase> InstancePtr;
@@ -748,6 +784,14 @@ void FAssetEditor_Dialogue::OnDebuggerActorSelected(TWeakObjectPtr<UDialogueExec
 	}
 }
 
+void FAssetEditor_Dialogue::OnDebuggerTraceSessionSelected(int32 SessionIndex)
+{
+	if (Debugger.IsValid())
+	{
+		Debugger->OnTraceSessionSelected(SessionIndex);
+	}
+}
+
 FText FAssetEditor_Dialogue::GetDebuggerVerbosityDesc() const
 {
 	if (Debugger.IsValid())
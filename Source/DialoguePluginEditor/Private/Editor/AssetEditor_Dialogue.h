@@ -68,9 +68,11 @@ private:
 	FGraphPanelSelectionSet GetSelectedNodes() const;
 
 	bool IsDebuggerReady() const;
+	bool IsDebuggerTraceLoaded() const;
 	FText GetDebuggerDesc() const;
 	TSharedRef<class SWidget> OnGetDebuggerActorsMenu();
 	void OnDebuggerActorSelected(TWeakObjectPtr<class UDialogueExecutorBase> InstanceToDebug);
+	void OnDebuggerTraceSessionSelected(int32 SessionIndex);
 
 	FText GetDebuggerVerbosityDesc() const;
 	TSharedRef<class SWidget> OnGetDebuggerVerbosityMenu();
@@ -7,6 +7,11 @@
 #include "Engine/Selection.h"
 #include "EdGraph_Dialogue.h"
 #include "EdGraphNode_DialogueBase.h"
+#include "DesktopPlatformModule.h"
+#include "IDesktopPlatform.h"
+#include "Framework/Application/SlateApplication.h"
+#include "Misc/Paths.h"
+#include "Misc/MessageDialog.h"
 
 
 #define LOCTEXT_NAMESPACE "DialogueDebugger"
@@ -18,6 +23,7 @@ FDialogueDebugger::FDialogueDebugger()
 	FEditorDelegates::EndPIE.AddRaw(this, &FDialogueDebugger::OnEndPIE);
 
 	ExecutionStep = -1;
+	TraceSessionIndex = INDEX_NONE;
 
 	VerbosityLevels.Add(MakeShared<FDDSV_Activation>());
 	VerbosityLevels.Add(MakeShared<FDDSV_Full>());
@@ -103,6 +109,8 @@ void FDialogueDebugger::OnObjectSelected(UObject* Object)
 			if (Executor->GetDialogue() == Asset)
 			{
 				ClearDebuggerState();
+				TraceLog.Reset();
+				TraceSessionIndex = INDEX_NONE;
 				ExecutorInstance = Executor;
 				InitDebuggerState();
 				
@@ -130,11 +138,16 @@ void FDialogueDebugger::OnExecutorCreated(const UDialogueExecutorBase& Executor)
 
 bool FDialogueDebugger::IsDebuggerReady() const
 {
-	return bIsPIEActive;
+	return bIsPIEActive || IsTraceLoaded();
 }
 
 FString FDialogueDebugger::GetDebuggedInstanceDesc() const
 {
+	if (TraceLog.IsValid())
+	{
+		return DescribeTraceSession(TraceSessionIndex);
+	}
+
 	UDialogueExecutorBase* Executor = ExecutorInstance.Get();
 	return Executor ? DescribeInstance(*Executor) : NSLOCTEXT("BlueprintEditor", "DebugActorNothingSelected", "No debug object selected").ToString();
 }
@@ -191,6 +204,8 @@ void FDialogueDebugger::OnInstanceSelectedInDropdown(UDialogueExecutorBase* Sele
 	if (SelectedInstance)
 	{
 		ClearDebuggerState();
+		TraceLog.Reset();
+		TraceSessionIndex = INDEX_NONE;
 		ExecutorInstance = SelectedInstance;
 		InitDebuggerState();
 
@@ -224,6 +239,149 @@ TSharedRef<FDialogueDebuggerStepVerbosity> FDialogueDebugger::GetCurrentVerbosit
 	return CurrentVerbosity.ToSharedRef();
 }
 
+bool FDialogueDebugger::LoadTrace(const FString& FilePath)
+{
+	TSharedPtr<FDialogueTraceFile> NewTraceFile = MakeShared<FDialogueTraceFile>();
+
+	FString Error;
+	if (!NewTraceFile->Load(FilePath, &Error))
+	{
+		FMessageDialog::Open(EAppMsgType::Ok, FText::Format(LOCTEXT("LoadTraceFailed", "Failed to load dialogue trace: {0}"), FText::FromString(Error)));
+		return false;
+	}
+
+	TraceFile = NewTraceFile;
+	TraceFilePath = FilePath;
+	TraceLog.Reset();
+	TraceSessionIndex = INDEX_NONE;
+
+	TArray<int32> MatchingSessions;
+	GetMatchingTraceSessions(MatchingSessions);
+	if (MatchingSessions.Num() > 0)
+	{
+		OnTraceSessionSelected(MatchingSessions[0]);
+	}
+	else
+	{
+		FMessageDialog::Open(EAppMsgType::Ok, LOCTEXT("LoadTraceNoMatch", "Trace has no executions of this dialogue"));
+	}
+
+	if (EditorOwner.IsValid())
+	{
+		EditorOwner.Pin()->RegenerateMenusAndToolbars();
+	}
+
+	return true;
+}
+
+bool FDialogueDebugger::IsTraceLoaded() const
+{
+	return TraceFile.IsValid();
+}
+
+void FDialogueDebugger::GetMatchingTraceSessions(TArray<int32>& OutSessionIndices) const
+{
+	if (!TraceFile.IsValid() || !Asset)
+	{
+		return;
+	}
+
+	const FString AssetPath = Asset->GetPathName();
+	for (int32 Index = 0; Index < TraceFile->Sessions.Num(); Index++)
+	{
+		if (TraceFile->Sessions[Index].HasDialogue(AssetPath))
+		{
+			OutSessionIndices.Add(Index);
+		}
+	}
+}
+
+FString FDialogueDebugger::DescribeTraceSession(int32 SessionIndex) const
+{
+	if (!TraceFile.IsValid() || !TraceFile->Sessions.IsValidIndex(SessionIndex))
+	{
+		return FString();
+	}
+
+	const FDialogueTraceSession& Session = TraceFile->Sessions[SessionIndex];
+
+	FString ExecutorName = Session.Execution.ExecutorName;
+	int32 SeparatorIndex;
+	if (ExecutorName.FindLastChar(TEXT('.'), SeparatorIndex))
+	{
+		ExecutorName = ExecutorName.RightChop(SeparatorIndex + 1);
+	}
+
+	const double ConditionMs = Session.GetConditionCycles() * TraceFile->SecondsPerCycle * 1000.0;
+
+	return FString::Printf(TEXT("[Trace %s] %s: %s (%d events, %.3f ms in conditions)"), 
+		*FPaths::GetBaseFilename(TraceFilePath), *ExecutorName, *Session.Execution.EntryPoint.ToString(), Session.Records.Num(), ConditionMs);
+}
+
+void FDialogueDebugger::OnTraceSessionSelected(int32 SessionIndex)
+{
+	if (!TraceFile.IsValid() || !TraceFile->Sessions.IsValidIndex(SessionIndex))
+	{
+		return;
+	}
+
+	typedef UDialogueExecutorBase::FDialogueExecutionStep FDebuggerStep;
+
+	ClearDebuggerState();
+	ExecutorInstance.Reset();
+
+	TraceSessionIndex = SessionIndex;
+	TraceLog = MakeShared<FDebuggerLog>();
+
+	const FDialogueTraceSession& Session = TraceFile->Sessions[SessionIndex];
+	const FString AssetPath = Asset ? Asset->GetPathName() : FString();
+
+	// Only part of session spent in this dialogue is shown, jumps switch active dialogue
+	FString ActiveDialoguePath = Session.Execution.DialoguePath;
+	int32 SwitchIndex = 0;
+
+	// Replay records through log so entry checks are merged the same way as in live session
+	for (const FDialogueTraceRecord& Record : Session.Records)
+	{
+		if (Record.Event == EDialogueTraceEvent::DialogueSwitch && Session.DialogueSwitches.IsValidIndex(SwitchIndex))
+		{
+			ActiveDialoguePath = Session.DialogueSwitches[SwitchIndex++].DialoguePath;
+		}
+		if (ActiveDialoguePath != AssetPath)
+		{
+			continue;
+		}
+
+		switch (Record.Event)
+		{
+		case EDialogueTraceEvent::NodeExecutionBegin:
+			TraceLog->Push(FDebuggerStep(Record.NodeId, FDebuggerStep::Active));
+			break;
+		case EDialogueTraceEvent::NodeExecutionEnd:
+			TraceLog->Push(FDebuggerStep(Record.NodeId, FDebuggerStep::Finished));
+			break;
+		case EDialogueTraceEvent::Condition:
+			TraceLog->Push(FDebuggerStep(Record.NodeId, Record.Value ? FDebuggerStep::EntryAllowed : FDebuggerStep::EntryDenied));
+			break;
+		default:
+			break;
+		}
+	}
+
+	Refresh();
+}
+
+const FDialogueDebugger::FDebuggerLog* FDialogueDebugger::GetDebuggedLog() const
+{
+	if (TraceLog.IsValid())
+	{
+		return TraceLog.Get();
+	}
+
+	UDialogueExecutorBase* Executor = ExecutorInstance.Get();
+	return Executor ? &Executor->ExecutionLog : nullptr;
+}
+
 void FDialogueDebugger::ClearDebuggerState()
 {
 	ActiveNodes.Empty();
@@ -254,15 +412,13 @@ void FDialogueDebugger::Refresh()
 		return;
 	}
 
-	if (!ExecutorInstance.IsValid() || !Asset)
+	const FDebuggerLog* LogPtr = GetDebuggedLog();
+	if (!LogPtr || !Asset)
 	{
 		return;
 	}	
 
-	typedef UDialogueExecutorBase::FDialogueExecutionStep FDebuggerStep;
-	typedef UDialogueExecutorBase::FDialogueExecutionStep::EExecutionAction EExecutionAction;
-
-	const TArray<FDebuggerStep>& Log = ExecutorInstance->ExecutionLog;
+	const FDebuggerLog& Log = *LogPtr;
 
 	StepIndices.Empty();
 	for (int32 Index = 0; Index < Log.Num(); )
@@ -297,15 +453,15 @@ void FDialogueDebugger::SetStep(int32 NewStep)
 		return;
 	}
 
-	if (!ExecutorInstance.IsValid() || !Asset)
+	const FDebuggerLog* LogPtr = GetDebuggedLog();
+	if (!LogPtr || !Asset)
 	{
 		return;
 	}
 
 	typedef UDialogueExecutorBase::FDialogueExecutionStep FDebuggerStep;
-	typedef UDialogueExecutorBase::FDialogueExecutionStep::EExecutionAction EExecutionAction;
 
-	const TArray<FDebuggerStep>& Log = ExecutorInstance->ExecutionLog;
+	const FDebuggerLog& Log = *LogPtr;
 
 	ActiveNodes.Empty();
 	CompletedNodes.Empty();
@@ -460,4 +616,51 @@ bool FDialogueDebugger::CanStepToEnd()
 	return CanStepForward();
 }
 
+void FDialogueDebugger::OpenTrace()
+{
+	IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get();
+	if (!DesktopPlatform)
+	{
+		return;
+	}
+
+	TArray<FString> OpenFilenames;
+	const bool bOpened = DesktopPlatform->OpenFileDialog(
+		FSlateApplication::Get().FindBestParentWindowHandleForDialogs(nullptr),
+		LOCTEXT("OpenTraceTitle", "Open Dialogue Trace").ToString(),
+		FPaths::ProfilingDir() / TEXT("Dialogue"),
+		TEXT(""),
+		TEXT("Dialogue Trace (*.dlgtrace)|*.dlgtrace"),
+		EFileDialogFlags::None,
+		OpenFilenames);
+
+	if (bOpened && OpenFilenames.Num() > 0)
+	{
+		LoadTrace(OpenFilenames[0]);
+	}
+}
+
+void FDialogueDebugger::UnloadTrace()
+{
+	TraceFile.Reset();
+	TraceFilePath.Empty();
+	TraceLog.Reset();
+	TraceSessionIndex = INDEX_NONE;
+
+	NodeConditionStates.Empty();
+	ClearDebuggerState();
+	StepIndices.Empty();
+	ExecutionStep = -1;
+
+	if (EditorOwner.IsValid())
+	{
+		EditorOwner.Pin()->RegenerateMenusAndToolbars();
+	}
+}
+
+bool FDialogueDebugger::CanUnloadTrace()
+{
+	return IsTraceLoaded();
+}
+
 #undef LOCTEXT_NAMESPACE
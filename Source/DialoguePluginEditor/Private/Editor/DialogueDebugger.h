@@ -2,6 +2,7 @@
 
 #include "CoreMinimal.h"
 #include "DialogueExecutor.h"
+#include "DialogueTrace.h"
 
 class UDialogue;
 class FAssetEditor_Dialogue;
@@ -12,6 +13,7 @@ struct FDialogueDebuggerStepVerbosity
 {	
 	typedef UDialogueExecutorBase::FDialogueExecutionStep FDebuggerStep;
 	typedef UDialogueExecutorBase::FDialogueExecutionStep::EExecutionAction EExecutionAction;
+	typedef UDialogueExecutorBase::FDialogueExecutionLog FDebuggerLog;
 
 	FName Name;
 	FString Description;
@@ -19,7 +21,7 @@ struct FDialogueDebuggerStepVerbosity
 	virtual ~FDialogueDebuggerStepVerbosity()
 	{ }
 	
-	virtual bool CheckStepImportant(const TArray<FDebuggerStep>& Steps, int32 Step, int32& OutWriteStep, int32& OutAdvanceBy) const
+	virtual bool CheckStepImportant(const FDebuggerLog& Steps, int32 Step, int32& OutWriteStep, int32& OutAdvanceBy) const
 	{
 		return false;
 	}
@@ -33,7 +35,7 @@ struct FDDSV_Full : public FDialogueDebuggerStepVerbosity
 		Description = TEXT("Maximally detailed verbosity");
 	}
 
-	virtual bool CheckStepImportant(const TArray<FDebuggerStep>& Steps, int32 Step, int32& OutWriteStep, int32& OutAdvanceBy) const override
+	virtual bool CheckStepImportant(const FDebuggerLog& Steps, int32 Step, int32& OutWriteStep, int32& OutAdvanceBy) const override
 	{
 		OutWriteStep = Step;
 		OutAdvanceBy = 1;
@@ -50,7 +52,7 @@ struct FDDSV_Activation : public FDialogueDebuggerStepVerbosity
 		Description = TEXT("Jump between steps where node was activated");
 	}
 
-	virtual bool CheckStepImportant(const TArray<FDebuggerStep>& Steps, int32 Step, int32& OutWriteStep, int32& OutAdvanceBy) const override
+	virtual bool CheckStepImportant(const FDebuggerLog& Steps, int32 Step, int32& OutWriteStep, int32& OutAdvanceBy) const override
 	{		
 		if (Steps[Step].Action == EExecutionAction::Active)
 		{
@@ -81,6 +83,8 @@ struct FDDSV_Activation : public FDialogueDebuggerStepVerbosity
 
 class FDialogueDebugger
 {
+	typedef UDialogueExecutorBase::FDialogueExecutionLog FDebuggerLog;
+
 private:
 	/** owning editor */
 	TWeakPtr<FAssetEditor_Dialogue> EditorOwner;
@@ -95,6 +99,14 @@ private:
 
 	uint32 bIsPIEActive : 1;
 
+	/** Trace loaded from file, debugged instead of executor when session is selected */
+	TSharedPtr<FDialogueTraceFile> TraceFile;
+	FString TraceFilePath;
+	int32 TraceSessionIndex;
+
+	/** Steps rebuilt from selected trace session */
+	TSharedPtr<FDebuggerLog> TraceLog;
+
 
 	/** -1 is last step */
 	int32 ExecutionStep;
@@ -135,6 +147,16 @@ public:
 
 	void OnVerbosityLevelSelectedInDropdown(FName Name);
 
+	bool LoadTrace(const FString& FilePath);
+	bool IsTraceLoaded() const;
+	/** Sessions of trace that executed debugged asset */
+	void GetMatchingTraceSessions(TArray<int32>& OutSessionIndices) const;
+	FString DescribeTraceSession(int32 SessionIndex) const;
+	void OnTraceSessionSelected(int32 SessionIndex);
+
+	/** Log of selected trace session or executor instance */
+	const FDebuggerLog* GetDebuggedLog() const;
+
 	TArray<TSharedRef<FDialogueDebuggerStepVerbosity>> GetVerbosityLevels() const;
 	TSharedRef<FDialogueDebuggerStepVerbosity> GetCurrentVerbosity() const;
 
@@ -164,4 +186,9 @@ public:
 
 	void StepToEnd();
 	bool CanStepToEnd();
+
+	void OpenTrace();
+
+	void UnloadTrace();
+	bool CanUnloadTrace();
 };
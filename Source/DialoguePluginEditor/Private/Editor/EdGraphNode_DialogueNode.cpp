@@ -86,12 +86,16 @@ FText UEdGraphNode_DialogueNode::GetBodyText() const
 
 FText UEdGraphNode_DialogueNode::GetContextText() const
 {
-	return Node.Context ? FText::FromString(Node.Context->GetContextDescripton()) : FText::GetEmpty();
+	if (Node.Context)
+	{
+		return FText::FromString(Node.Context->GetContextDescripton());
+	}
+	return Node.ContextStruct.IsValid() ? FText::FromString(Node.ContextStruct.Get()->GetContextDescripton()) : FText::GetEmpty();
 }
 
 bool UEdGraphNode_DialogueNode::GetHasContext() const
 {
-	return Node.Context != nullptr;
+	return Node.Context != nullptr || Node.ContextStruct.IsValid();
 }
 
 FLinearColor UEdGraphNode_DialogueNode::GetNodeBodyTintColor() const
@@ -26,6 +26,9 @@ void FDialogueDebuggerCommands::RegisterCommands()
 	UI_COMMAND(StepForward, "StepForward", "Step Forward", EUserInterfaceActionType::Button, FInputChord());
 	UI_COMMAND(StepToBegin, "StepToBegin", "Step To Begin", EUserInterfaceActionType::Button, FInputChord());
 	UI_COMMAND(StepToEnd, "StepToEnd", "Step To End", EUserInterfaceActionType::Button, FInputChord());
+
+	UI_COMMAND(OpenTrace, "OpenTrace", "Load execution trace file recorded with dialogue.Trace", EUserInterfaceActionType::Button, FInputChord());
+	UI_COMMAND(UnloadTrace, "CloseTrace", "Close loaded execution trace", EUserInterfaceActionType::Button, FInputChord());
 }
 
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
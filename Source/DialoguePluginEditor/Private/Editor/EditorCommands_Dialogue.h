@@ -36,4 +36,7 @@ public:
 
 	TSharedPtr<FUICommandInfo> StepToBegin;
 	TSharedPtr<FUICommandInfo> StepToEnd;
+
+	TSharedPtr<FUICommandInfo> OpenTrace;
+	TSharedPtr<FUICommandInfo> UnloadTrace;
 };
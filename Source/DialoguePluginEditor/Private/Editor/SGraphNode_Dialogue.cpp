@@ -807,7 +807,8 @@ EVisibility SGraphNode_Dialogue::GetIconVisibility() const
 EVisibility SGraphNode_Dialogue::GetConditionVisibility() const
 {
 	UEdGraphNode_DialogueNode* Node = Cast<UEdGraphNode_DialogueNode>(GraphNode);
-	return (Node && Node->Node.Condition != nullptr) ? EVisibility::Visible : EVisibility::Hidden;
+	const bool bHasCondition = Node && (Node->Node.Condition != nullptr || Node->Node.ConditionStructs.Num() > 0 || Node->Node.SharedConditions.Num() > 0);
+	return bHasCondition ? EVisibility::Visible : EVisibility::Hidden;
 }
 
 EVisibility SGraphNode_Dialogue::GetEventVisibility() const
@@ -819,7 +820,7 @@ EVisibility SGraphNode_Dialogue::GetEventVisibility() const
 EVisibility SGraphNode_Dialogue::GetSoundVisibility() const
 {
 	UEdGraphNode_DialogueNode* Node = Cast<UEdGraphNode_DialogueNode>(GraphNode);
-	return (Node && Node->Node.Sound != nullptr) ? EVisibility::Visible : EVisibility::Hidden;
+	return (Node && !Node->Node.Sound.IsNull()) ? EVisibility::Visible : EVisibility::Hidden;
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -0,0 +1,185 @@
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Tests/DialogueTestUtils.h"
+#include "DialogueBlackboard.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDialogueAccessorsTest, "Dialogue.Asset.Accessors", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FDialogueAccessorsTest::RunTest(const FString& Parameters)
+{
+	UDialogue* Dialogue = DialogueTests::MakeDialogue();
+
+	TestTrue(TEXT("Has node"), Dialogue->HasNode(1));
+	TestFalse(TEXT("Has missing node"), Dialogue->HasNode(42));
+	TestFalse(TEXT("Has negative node"), Dialogue->HasNode(INDEX_NONE));
+
+	TestEqual(TEXT("Node id"), Dialogue->GetNode(1).NodeID, 1);
+	TestEqual(TEXT("Node text"), Dialogue->GetNodeText(1).ToString(), FString(TEXT("Line 1")));
+	TestTrue(TEXT("Node children"), Dialogue->GetNode(0).Children == TArray<int32>({ 1, 2 }));
+	TestEqual(TEXT("Missing node"), Dialogue->GetNode(42).NodeID, (int32)INDEX_NONE);
+	TestFalse(TEXT("Node is empty"), Dialogue->IsNodeEmpty(1));
+	TestTrue(TEXT("Missing node is empty"), Dialogue->IsNodeEmpty(42));
+
+	TestTrue(TEXT("Has children"), Dialogue->HasChildren(0));
+	TestFalse(TEXT("Leaf has children"), Dialogue->HasChildren(3));
+	TestEqual(TEXT("Children num"), Dialogue->GetChildrenNum(0), 2);
+	TestEqual(TEXT("Missing node children num"), Dialogue->GetChildrenNum(42), 0);
+	TestTrue(TEXT("Children ids"), Dialogue->GetChildrenIds(0) == TArray<int32>({ 1, 2 }));
+	TestEqual(TEXT("Child id"), Dialogue->GetChildId(0, 1), 2);
+	TestEqual(TEXT("Child id out of range"), Dialogue->GetChildId(0, 2), (int32)INDEX_NONE);
+	TestEqual(TEXT("Child node"), Dialogue->GetChildNode(1, 0).NodeID, 3);
+	TestEqual(TEXT("Children nodes"), Dialogue->GetChildrenNodes(0).Num(), 2);
+
+	const TArray<FDialogueNodeHandle> Handles = Dialogue->GetChildrenHandles(0);
+	if (TestEqual(TEXT("Children handles"), Handles.Num(), 2))
+	{
+		TestEqual(TEXT("Child handle id"), Handles[1].NodeId, 2);
+	}
+	TestEqual(TEXT("Node handle"), Dialogue->GetNodeHandle(3).NodeId, 3);
+
+	TestEqual(TEXT("Node view"), Dialogue->FindNodeView(1).GetNodeId(), 1);
+	TestEqual(TEXT("Child view"), Dialogue->FindChildView(0, 1).GetNodeId(), 2);
+	TestFalse(TEXT("Missing node view"), Dialogue->FindNodeView(42).IsValid());
+	TestFalse(TEXT("Child view out of range"), Dialogue->FindChildView(3, 0).IsValid());
+
+	TestTrue(TEXT("Has default entry"), Dialogue->HasEntry(NAME_None));
+	TestTrue(TEXT("Has entry"), Dialogue->HasEntry(TEXT("Side")));
+	TestFalse(TEXT("Has missing entry"), Dialogue->HasEntry(TEXT("Missing")));
+	TestEqual(TEXT("Entry id"), Dialogue->GetEntryId(TEXT("Side")), 2);
+	TestEqual(TEXT("Missing entry id"), Dialogue->GetEntryId(TEXT("Missing")), (int32)INDEX_NONE);
+	TestEqual(TEXT("Entry node"), Dialogue->GetEntryNode(TEXT("Side")).NodeID, 2);
+	TestEqual(TEXT("Entry handle"), Dialogue->GetEntryHandle(TEXT("Side")).NodeId, 2);
+	TestEqual(TEXT("Entry view"), Dialogue->FindEntryView(TEXT("Side")).GetNodeId(), 2);
+	TestEqual(TEXT("Entries"), Dialogue->GetEntries().Num(), 2);
+
+	TestEqual(TEXT("Participants"), Dialogue->GetAllParticipants().Num(), 2);
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDialogueIdAllocationTest, "Dialogue.Asset.IdAllocation", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FDialogueIdAllocationTest::RunTest(const FString& Parameters)
+{
+	// New dialogue has root node 0
+	UDialogue* Dialogue = NewObject<UDialogue>(GetTransientPackage(), NAME_None, RF_Transient);
+	FDialogueEditorStruct Editor(Dialogue);
+
+	TestEqual(TEXT("First id"), Editor.AddNewNode(FDialogueNode()), 1);
+	TestEqual(TEXT("Second id"), Editor.AddNewNode(FDialogueNode()), 2);
+	TestEqual(TEXT("Third id"), Editor.AddNewNode(FDialogueNode()), 3);
+	TestTrue(TEXT("Added node in table"), Dialogue->HasNode(3));
+
+	Editor.RemoveNode(2);
+	TestFalse(TEXT("Removed node in table"), Dialogue->HasNode(2));
+	TestEqual(TEXT("Removed id is reused"), Editor.AddNewNode(FDialogueNode()), 2);
+	TestEqual(TEXT("Id after last"), Editor.AddNewNode(FDialogueNode()), 4);
+
+	FDialogueNode SelfReferencing;
+	SelfReferencing.Children = { 5, 1 };
+	const int32 SelfId = Editor.AddNewNode(SelfReferencing);
+	TestEqual(TEXT("Self referencing id"), SelfId, 5);
+	TestTrue(TEXT("Self reference removed"), Dialogue->GetNode(SelfId).Children == TArray<int32>({ 1 }));
+
+	TestTrue(TEXT("Entry to existing node"), Editor.SetEntry(TEXT("Entry"), 4));
+	TestFalse(TEXT("Entry to missing node"), Editor.SetEntry(TEXT("Missing"), 42));
+	TestEqual(TEXT("Entry id"), Dialogue->GetEntryId(TEXT("Entry")), 4);
+
+	// Gaps in replaced node map are free ids, new ids continue after largest one
+	TMap<int32, FDialogueNode> Nodes;
+	Nodes.Add(0).NodeID = 0;
+	Nodes.Add(1).NodeID = 1;
+	Nodes.Add(5).NodeID = 5;
+	TMap<FName, int32> Entries;
+	Entries.Add(NAME_None, 0);
+	Editor.SetNodes(Nodes, Entries);
+
+	TArray<int32> GapIds;
+	for (int32 Index = 0; Index < 3; Index++)
+	{
+		GapIds.Add(Editor.AddNewNode(FDialogueNode()));
+	}
+	GapIds.Sort();
+	TestTrue(TEXT("Gap ids"), GapIds == TArray<int32>({ 2, 3, 4 }));
+	TestEqual(TEXT("Id after gaps"), Editor.AddNewNode(FDialogueNode()), 6);
+	TestEqual(TEXT("Node num"), Dialogue->GetNodeMap().Num(), 7);
+
+	// Editor struct created over existing dialogue continues after its nodes
+	FDialogueEditorStruct OtherEditor(Dialogue);
+	TestEqual(TEXT("Id from new editor struct"), OtherEditor.AddNewNode(FDialogueNode()), 7);
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDialogueConditionTextTest, "Dialogue.Asset.ConditionText", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FDialogueConditionTextTest::RunTest(const FString& Parameters)
+{
+	// Copy/paste goes through text export of struct condition
+	FDialogueInstancedCondition Condition;
+	Condition.InitializeAs(FDialogueBlackboardCondition::StaticStruct());
+	FDialogueBlackboardCondition* Blackboard = (FDialogueBlackboardCondition*)Condition.GetMutableMemory();
+	Blackboard->Key = TEXT("Quest.Stage");
+	Blackboard->Type = EDialogueFactType::Int;
+	Blackboard->IntValue = 3;
+
+	FString Text;
+	Condition.ExportTextItem(Text, FDialogueInstancedCondition(), nullptr, PPF_Copy, nullptr);
+
+	FDialogueInstancedCondition Pasted;
+	const TCHAR* Buffer = *Text;
+	TestTrue(TEXT("Imported"), Pasted.ImportTextItem(Buffer, PPF_Copy, nullptr, GWarn));
+	TestTrue(TEXT("Identical"), Pasted.Identical(&Condition, PPF_None));
+
+	const FDialogueBlackboardCondition* PastedBlackboard = Pasted.GetPtr<FDialogueBlackboardCondition>();
+	if (TestNotNull(TEXT("Struct"), PastedBlackboard))
+	{
+		TestEqual(TEXT("Key"), PastedBlackboard->Key, Blackboard->Key);
+		TestEqual(TEXT("Value"), PastedBlackboard->IntValue, 3);
+	}
+
+	FString EmptyText;
+	FDialogueInstancedCondition().ExportTextItem(EmptyText, FDialogueInstancedCondition(), nullptr, PPF_Copy, nullptr);
+	Buffer = *EmptyText;
+	TestTrue(TEXT("Imported empty"), Pasted.ImportTextItem(Buffer, PPF_Copy, nullptr, GWarn));
+	TestFalse(TEXT("Empty"), Pasted.IsValid());
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDialogueBlackboardWatcherTest, "Dialogue.Blackboard.Watchers", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FDialogueBlackboardWatcherTest::RunTest(const FString& Parameters)
+{
+	FDialogueBlackboard Blackboard;
+	const FName Key = TEXT("Quest.Stage");
+
+	int32 FirstCalls = 0;
+	int32 SecondCalls = 0;
+	const FDialogueBlackboardWatchHandle First = Blackboard.AddWatcher({ Key }, FOnDialogueFactChanged::FDelegate::CreateLambda([&FirstCalls](FName, const FDialogueFact&) { FirstCalls++; }));
+	Blackboard.SetInt(Key, 1);
+	TestEqual(TEXT("Watcher called"), FirstCalls, 1);
+
+	// Second watcher takes slot of removed one, stale handle must not remove it
+	Blackboard.RemoveWatcher(First);
+	const FDialogueBlackboardWatchHandle Second = Blackboard.AddWatcher({ Key }, FOnDialogueFactChanged::FDelegate::CreateLambda([&SecondCalls](FName, const FDialogueFact&) { SecondCalls++; }));
+	TestEqual(TEXT("Slot reused"), Second.Index, First.Index);
+	Blackboard.RemoveWatcher(First);
+
+	Blackboard.SetInt(Key, 2);
+	TestEqual(TEXT("Removed watcher not called"), FirstCalls, 1);
+	TestEqual(TEXT("New watcher called"), SecondCalls, 1);
+
+	Blackboard.RemoveWatcher(Second);
+	Blackboard.SetInt(Key, 3);
+	TestEqual(TEXT("Watcher removed"), SecondCalls, 1);
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,402 @@
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Engine/World.h"
+#include "DialogueSubsystem.h"
+#include "DialogueRecording.h"
+#include "Tests/DialogueTestUtils.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+BEGIN_DEFINE_SPEC(FDialogueExecutorSpec, "Dialogue.Executor", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+	UDialogue* Dialogue = nullptr;
+	UDialogueBenchmarkExecutor* Executor = nullptr;
+	UDialogue* JumpTarget = nullptr;
+	TArray<FString> Events;
+
+	void BindEvents()
+	{
+		Executor->OnDialogueExecutionStartedNative.AddLambda([this](UDialogueExecutorBase&, int32 NodeId) { Events.Add(FString::Printf(TEXT("Started %d"), NodeId)); });
+		Executor->OnDialogueExecutionFinishedNative.AddLambda([this](UDialogueExecutorBase&, int32 NodeId) { Events.Add(FString::Printf(TEXT("Finished %d"), NodeId)); });
+		Executor->OnNodeEnterNative.AddLambda([this](UDialogueExecutorBase&, int32 NodeId) { Events.Add(FString::Printf(TEXT("Enter %d"), NodeId)); });
+		Executor->OnNodeLeaveNative.AddLambda([this](UDialogueExecutorBase&, int32 NodeId) { Events.Add(FString::Printf(TEXT("Leave %d"), NodeId)); });
+		Executor->OnNodeExecutionBeginNative.AddLambda([this](UDialogueExecutorBase&, int32 NodeId) { Events.Add(FString::Printf(TEXT("Begin %d"), NodeId)); });
+		Executor->OnNodeExecutionEndNative.AddLambda([this](UDialogueExecutorBase&, int32 NodeId) { Events.Add(FString::Printf(TEXT("End %d"), NodeId)); });
+	}
+END_DEFINE_SPEC(FDialogueExecutorSpec)
+
+void FDialogueExecutorSpec::Define()
+{
+	BeforeEach([this]()
+	{
+		Dialogue = DialogueTests::MakeDialogue();
+		Dialogue->AddToRoot();
+
+		Executor = NewObject<UDialogueBenchmarkExecutor>(GetTransientPackage());
+		Executor->AddToRoot();
+		Executor->HandleCreated();
+		Executor->SetDialogue(Dialogue);
+
+		Events.Reset();
+	});
+
+	AfterEach([this]()
+	{
+		Executor->ResetExecutor();
+		Executor->RemoveFromRoot();
+		Executor = nullptr;
+
+		Dialogue->RemoveFromRoot();
+		Dialogue = nullptr;
+	});
+
+	Describe("Lifecycle", [this]()
+	{
+		It("should begin at default entry", [this]()
+		{
+			TestTrue(TEXT("Begin"), Executor->BeginExecution(NAME_None));
+			TestTrue(TEXT("In progress"), Executor->IsExecutionInProgress());
+			TestEqual(TEXT("Current node"), Executor->GetCurrentNodeId(), 0);
+			TestEqual(TEXT("Current entry"), Executor->GetCurrentEntryPoint(), FName(NAME_None));
+		});
+
+		It("should begin at named entry", [this]()
+		{
+			TestTrue(TEXT("Begin"), Executor->BeginExecution(TEXT("Side")));
+			TestEqual(TEXT("Current node"), Executor->GetCurrentNodeId(), 2);
+			TestEqual(TEXT("Current entry"), Executor->GetCurrentEntryPoint(), FName(TEXT("Side")));
+		});
+
+		It("should begin at node", [this]()
+		{
+			TestTrue(TEXT("Begin"), Executor->BeginExecutionAtNode(1));
+			TestEqual(TEXT("Current node"), Executor->GetCurrentNodeId(), 1);
+		});
+
+		It("should not begin without valid start", [this]()
+		{
+			TestFalse(TEXT("Missing entry"), Executor->BeginExecution(TEXT("Missing")));
+			TestFalse(TEXT("Missing node"), Executor->BeginExecutionAtNode(42));
+			TestFalse(TEXT("In progress"), Executor->IsExecutionInProgress());
+
+			Executor->SetDialogue(nullptr);
+			TestFalse(TEXT("No dialogue"), Executor->BeginExecution(NAME_None));
+		});
+
+		It("should not begin twice", [this]()
+		{
+			Executor->BeginExecution(NAME_None);
+			Executor->FinishNodeExecution(1);
+
+			TestFalse(TEXT("Second begin"), Executor->BeginExecution(TEXT("Side")));
+			TestEqual(TEXT("Current node"), Executor->GetCurrentNodeId(), 1);
+		});
+
+		It("should not switch dialogue during execution", [this]()
+		{
+			Executor->BeginExecution(NAME_None);
+			Executor->SetDialogue(DialogueTests::MakeDialogue());
+			TestEqual(TEXT("Dialogue"), Executor->GetDialogue(), Dialogue);
+		});
+
+		It("should broadcast events in order until finish", [this]()
+		{
+			BindEvents();
+
+			Executor->BeginExecution(NAME_None);
+			Executor->FinishNodeExecution(1);
+			Executor->FinishNodeExecution(3);
+			Executor->FinishNodeExecution(INDEX_NONE);
+
+			const TArray<FString> Expected =
+			{
+				TEXT("Started 0"), TEXT("Begin 0"),
+				TEXT("End 0"), TEXT("Leave 0"), TEXT("Enter 1"), TEXT("Begin 1"),
+				TEXT("End 1"), TEXT("Leave 1"), TEXT("Enter 3"), TEXT("Begin 3"),
+				TEXT("End 3"), TEXT("Leave 3"), TEXT("Finished -1"),
+			};
+			TestEqual(TEXT("Event num"), Events.Num(), Expected.Num());
+			for (int32 Index = 0; Index < FMath::Min(Events.Num(), Expected.Num()); Index++)
+			{
+				TestEqual(FString::Printf(TEXT("Event %d"), Index), Events[Index], Expected[Index]);
+			}
+
+			TestFalse(TEXT("In progress"), Executor->IsExecutionInProgress());
+			TestEqual(TEXT("Format num"), Executor->FormatNum, 3);
+		});
+
+		It("should ignore finish when not executing", [this]()
+		{
+			BindEvents();
+			Executor->FinishNodeExecution(1);
+			TestEqual(TEXT("Event num"), Events.Num(), 0);
+		});
+
+		It("should finish on stop", [this]()
+		{
+			Executor->BeginExecution(NAME_None);
+			BindEvents();
+			Executor->StopExecution();
+
+			TestFalse(TEXT("In progress"), Executor->IsExecutionInProgress());
+			TestEqual(TEXT("Current node"), Executor->GetCurrentNodeId(), (int32)INDEX_NONE);
+			TestTrue(TEXT("Finished"), Events.Contains(TEXT("Finished -1")));
+		});
+
+		It("should restart after finish", [this]()
+		{
+			Executor->BeginExecution(NAME_None);
+			Executor->StopExecution();
+
+			TestTrue(TEXT("Begin"), Executor->BeginExecution(TEXT("Side")));
+			TestEqual(TEXT("Current node"), Executor->GetCurrentNodeId(), 2);
+		});
+
+		It("should return to constructed state on reset", [this]()
+		{
+			UDialogueBenchmarkParticipant* Participant = DialogueTests::MakeParticipant(TEXT("Alice"));
+			Executor->SetParticipant(TEXT("Alice"), Participant);
+			Executor->BeginExecution(NAME_None);
+			BindEvents();
+
+			Executor->ResetExecutor();
+
+			TestTrue(TEXT("Finish notified before reset"), Events.Contains(TEXT("Finished -1")));
+			TestFalse(TEXT("In progress"), Executor->IsExecutionInProgress());
+			TestNull(TEXT("Dialogue"), Executor->GetDialogue());
+			TestNull(TEXT("Participant"), Executor->GetParticipant(TEXT("Alice")));
+			TestFalse(TEXT("Native bindings"), Executor->OnNodeEnterNative.IsBound());
+			TestEqual(TEXT("Current entry"), Executor->GetCurrentEntryPoint(), FName(NAME_None));
+		});
+	});
+
+	Describe("Conditions", [this]()
+	{
+		It("should list available children", [this]()
+		{
+			TestTrue(TEXT("Available"), Executor->FindAvailableNextNodes(0, false) == TArray<int32>({ 1, 2 }));
+			TestTrue(TEXT("First available"), Executor->FindAvailableNextNodes(0, true) == TArray<int32>({ 1 }));
+			TestEqual(TEXT("Leaf"), Executor->FindAvailableNextNodes(3, false).Num(), 0);
+		});
+
+		It("should skip children with failed condition", [this]()
+		{
+			Executor->SetDialogue(DialogueTests::MakeDialogue(false));
+			TestTrue(TEXT("Available"), Executor->FindAvailableNextNodes(0, false) == TArray<int32>({ 1 }));
+		});
+	});
+
+	Describe("Jump", [this]()
+	{
+		BeforeEach([this]()
+		{
+			JumpTarget = DialogueTests::MakeDialogue();
+			JumpTarget->AddToRoot();
+
+			// Leaf 3 continues at Side entry of target
+			FDialogueNode JumpNode = Dialogue->GetNode(3);
+			JumpNode.Jump.Dialogue = JumpTarget;
+			JumpNode.Jump.Entry = TEXT("Side");
+			FDialogueEditorStruct(Dialogue).SetNode(3, JumpNode);
+		});
+
+		AfterEach([this]()
+		{
+			JumpTarget->RemoveFromRoot();
+			JumpTarget = nullptr;
+		});
+
+		It("should continue in target dialogue", [this]()
+		{
+			Executor->BeginExecution(NAME_None);
+			Executor->FinishNodeExecution(1);
+			Executor->FinishNodeExecution(3);
+
+			TestEqual(TEXT("Dialogue"), Executor->GetDialogue(), JumpTarget);
+			TestEqual(TEXT("Current node"), Executor->GetCurrentNodeId(), 2);
+			TestEqual(TEXT("Current entry"), Executor->GetCurrentEntryPoint(), FName(TEXT("Side")));
+		});
+
+		It("should record dialogue switch", [this]()
+		{
+			TSharedRef<FDialogueExecutionRecording> Recording = MakeShared<FDialogueExecutionRecording>();
+			Executor->SetRecording(Recording);
+
+			Executor->BeginExecution(NAME_None);
+			Executor->FinishNodeExecution(1);
+			Executor->FinishNodeExecution(3);
+
+			TestEqual(TEXT("Start dialogue"), Recording->DialoguePath, Dialogue->GetPathName());
+			if (TestEqual(TEXT("Switches"), Recording->DialogueSwitches.Num(), 1))
+			{
+				TestEqual(TEXT("Switch dialogue"), Recording->DialogueSwitches[0].DialoguePath, JumpTarget->GetPathName());
+				TestEqual(TEXT("Switch choice"), Recording->DialogueSwitches[0].ChoiceIndex, 2);
+				TestEqual(TEXT("Switch node"), Recording->DialogueSwitches[0].NodeId, 2);
+			}
+			TestTrue(TEXT("Node sequence"), Recording->NodeSequence == TArray<int32>({ 0, 1, 2 }));
+		});
+
+		It("should restore state saved after jump", [this]()
+		{
+			Executor->BeginExecution(NAME_None);
+			Executor->FinishNodeExecution(1);
+			Executor->FinishNodeExecution(3);
+
+			TArray<uint8> State;
+			Executor->SaveState(State);
+
+			Executor->ResetExecutor();
+			Executor->SetDialogue(Dialogue);
+
+			TestTrue(TEXT("Restored"), Executor->RestoreState(State));
+			TestEqual(TEXT("Dialogue"), Executor->GetDialogue(), JumpTarget);
+			TestEqual(TEXT("Current node"), Executor->GetCurrentNodeId(), 2);
+			TestEqual(TEXT("Current entry"), Executor->GetCurrentEntryPoint(), FName(TEXT("Side")));
+		});
+	});
+
+	Describe("FormatText", [this]()
+	{
+		BeforeEach([this]()
+		{
+			Executor->SetParticipant(TEXT("Alice"), DialogueTests::MakeParticipant(TEXT("Alice")));
+			Executor->SetParticipant(TEXT("Bob"), DialogueTests::MakeParticipant(TEXT("Bob")));
+			Executor->BeginExecution(NAME_None);
+		});
+
+		It("should keep text without arguments", [this]()
+		{
+			FText Text;
+			Executor->FormatText(FText::AsCultureInvariant(TEXT("Plain line")), 0, Text);
+			TestEqual(TEXT("Text"), Text.ToString(), FString(TEXT("Plain line")));
+		});
+
+		It("should resolve executor and node participant arguments", [this]()
+		{
+			const FText Source = FText::AsCultureInvariant(TEXT("Line {Executor.GetBenchmarkInt} by {Participant.GetParticipantName}"));
+
+			FText Text;
+			Executor->FormatText(Source, 1, Text);
+			TestEqual(TEXT("Node participant"), Text.ToString(), FString(TEXT("Line 0 by Bob")));
+
+			Executor->FormatText(Source, 2, Text);
+			TestEqual(TEXT("Other node participant"), Text.ToString(), FString(TEXT("Line 0 by Alice")));
+		});
+
+		It("should follow executor state on repeated format", [this]()
+		{
+			const FText Source = FText::AsCultureInvariant(TEXT("Node {Executor.GetBenchmarkInt}"));
+
+			FText Text;
+			Executor->FormatText(Source, 0, Text);
+			TestEqual(TEXT("First"), Text.ToString(), FString(TEXT("Node 0")));
+
+			Executor->FinishNodeExecution(1);
+			Executor->FormatText(Source, 0, Text);
+			TestEqual(TEXT("Cached plan"), Text.ToString(), FString(TEXT("Node 1")));
+		});
+
+		It("should replan changed text", [this]()
+		{
+			FText Text;
+			Executor->FormatText(FText::AsCultureInvariant(TEXT("A {Executor.GetBenchmarkInt}")), 1, Text);
+			Executor->FormatText(FText::AsCultureInvariant(TEXT("B {Executor.GetBenchmarkString}")), 1, Text);
+			TestEqual(TEXT("Text"), Text.ToString(), FString::Printf(TEXT("B %s"), *Executor->GetName()));
+		});
+
+		It("should format without dialogue", [this]()
+		{
+			Executor->ResetExecutor();
+
+			FText Text;
+			Executor->FormatText(FText::AsCultureInvariant(TEXT("Name {Executor.GetBenchmarkString}")), INDEX_NONE, Text);
+			TestEqual(TEXT("Text"), Text.ToString(), FString::Printf(TEXT("Name %s"), *Executor->GetName()));
+		});
+	});
+}
+
+
+BEGIN_DEFINE_SPEC(FDialogueExecutorPoolSpec, "Dialogue.Subsystem.Pool", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+	UWorld* World = nullptr;
+	UDialogueSubsystem* Subsystem = nullptr;
+END_DEFINE_SPEC(FDialogueExecutorPoolSpec)
+
+void FDialogueExecutorPoolSpec::Define()
+{
+	BeforeEach([this]()
+	{
+		World = UWorld::CreateWorld(EWorldType::Game, false);
+		Subsystem = World->GetSubsystem<UDialogueSubsystem>();
+		TestNotNull(TEXT("Subsystem"), Subsystem);
+	});
+
+	AfterEach([this]()
+	{
+		World->DestroyWorld(false);
+		World = nullptr;
+		Subsystem = nullptr;
+	});
+
+	It("should create executor owned by requester", [this]()
+	{
+		UDialogueExecutorBase* Executor = Subsystem->AcquireExecutor(UDialogueBenchmarkExecutor::StaticClass(), World);
+		if (TestNotNull(TEXT("Executor"), Executor))
+		{
+			TestEqual(TEXT("Outer"), Executor->GetOuter(), (UObject*)World);
+			TestTrue(TEXT("Registered"), Subsystem->GetRegisteredExecutors().Contains(Executor));
+		}
+	});
+
+	It("should not create abstract executor", [this]()
+	{
+		TestNull(TEXT("Abstract"), Subsystem->AcquireExecutor(UDialogueExecutor::StaticClass(), World));
+		TestNull(TEXT("No owner"), Subsystem->AcquireExecutor(UDialogueBenchmarkExecutor::StaticClass(), nullptr));
+	});
+
+	It("should reuse released executor", [this]()
+	{
+		UDialogueExecutorBase* Executor = Subsystem->AcquireExecutor(UDialogueBenchmarkExecutor::StaticClass(), World);
+		Subsystem->ReleaseExecutor(Executor);
+
+		TestEqual(TEXT("Pooled"), Subsystem->GetPooledNum(UDialogueBenchmarkExecutor::StaticClass()), 1);
+		TestFalse(TEXT("Registered"), Subsystem->GetRegisteredExecutors().Contains(Executor));
+
+		UDialogueExecutorBase* Reused = Subsystem->AcquireExecutor(UDialogueBenchmarkExecutor::StaticClass(), World);
+		TestEqual(TEXT("Reused"), Reused, Executor);
+		TestEqual(TEXT("Pooled after acquire"), Subsystem->GetPooledNum(UDialogueBenchmarkExecutor::StaticClass()), 0);
+		TestEqual(TEXT("Outer"), Reused->GetOuter(), (UObject*)World);
+	});
+
+	It("should reset released executor", [this]()
+	{
+		UDialogue* Dialogue = DialogueTests::MakeDialogue();
+		UDialogueExecutor* Executor = Cast<UDialogueExecutor>(Subsystem->AcquireExecutor(UDialogueBenchmarkExecutor::StaticClass(), World));
+		Executor->SetDialogue(Dialogue);
+		Executor->BeginExecution(NAME_None);
+
+		Subsystem->ReleaseExecutor(Executor);
+		TestFalse(TEXT("In progress"), Executor->IsExecutionInProgress());
+		TestNull(TEXT("Dialogue"), Executor->GetDialogue());
+	});
+
+	It("should not pool more than limit", [this]()
+	{
+		Subsystem->MaxPooledPerClass = 1;
+
+		UDialogueExecutorBase* First = Subsystem->AcquireExecutor(UDialogueBenchmarkExecutor::StaticClass(), World);
+		UDialogueExecutorBase* Second = Subsystem->AcquireExecutor(UDialogueBenchmarkExecutor::StaticClass(), World);
+		Subsystem->ReleaseExecutor(First);
+		Subsystem->ReleaseExecutor(Second);
+		Subsystem->ReleaseExecutor(First);
+
+		TestEqual(TEXT("Pooled"), Subsystem->GetPooledNum(UDialogueBenchmarkExecutor::StaticClass()), 1);
+	});
+
+	It("should empty pool", [this]()
+	{
+		Subsystem->ReleaseExecutor(Subsystem->AcquireExecutor(UDialogueBenchmarkExecutor::StaticClass(), World));
+		Subsystem->EmptyPool();
+		TestEqual(TEXT("Pooled"), Subsystem->GetPooledNum(UDialogueBenchmarkExecutor::StaticClass()), 0);
+	});
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,78 @@
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "Interfaces/IPluginManager.h"
+#include "Dom/JsonObject.h"
+#include "Tests/DialogueTestUtils.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/**
+ * Timed walks over generated dialogues compared with baselines checked in to plugin Test/PerfBaselines, one file per spec
+ * Baselines are recorded on CI machine with -DialogueWritePerfBaseline, missing baseline fails the spec
+ * Command line: [-DialoguePerfBaselineDir=Dir] [-DialoguePerfThreshold=0.15] [-DialogueWritePerfBaseline]
+ */
+BEGIN_DEFINE_SPEC(FDialoguePerfSpec, "Dialogue.Perf", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+	void RunAgainstBaseline(const FString& Name, DialogueBenchmark::FParams Params);
+END_DEFINE_SPEC(FDialoguePerfSpec)
+
+void FDialoguePerfSpec::RunAgainstBaseline(const FString& Name, DialogueBenchmark::FParams Params)
+{
+	FString BaselineDir;
+	if (TSharedPtr<IPlugin> Plugin = IPluginManager::Get().FindPlugin(TEXT("DialoguePlugin")))
+	{
+		BaselineDir = Plugin->GetBaseDir() / TEXT("Test") / TEXT("PerfBaselines");
+	}
+	FParse::Value(FCommandLine::Get(), TEXT("DialoguePerfBaselineDir="), BaselineDir);
+	FParse::Value(FCommandLine::Get(), TEXT("DialoguePerfThreshold="), Params.Threshold);
+	Params.bWriteBaseline = FParse::Param(FCommandLine::Get(), TEXT("DialogueWritePerfBaseline"));
+	Params.BaselinePath = BaselineDir / Name + TEXT(".json");
+
+	// Counting allocator stays installed for rest of process once used, only commandlet installs it
+	Params.bCountAllocations = false;
+
+	const TSharedRef<FJsonObject> Report = DialogueBenchmark::Run(Params);
+	TestTrue(TEXT("Transitions"), Report->GetNumberField(TEXT("transitions")) > 0.0);
+
+	if (!Params.bWriteBaseline && !IFileManager::Get().FileExists(*Params.BaselinePath))
+	{
+		AddError(FString::Printf(TEXT("No baseline for %s at %s, record it with -DialogueWritePerfBaseline"), *Name, *Params.BaselinePath));
+		return;
+	}
+
+	TestTrue(TEXT("Within baseline"), DialogueBenchmark::CheckBaseline(Report, Params.BaselinePath, Params.Threshold, Params.bWriteBaseline));
+}
+
+void FDialoguePerfSpec::Define()
+{
+	It("should keep traversal speed", [this]()
+	{
+		DialogueBenchmark::FParams Params;
+		Params.WalkNum = 500;
+		RunAgainstBaseline(TEXT("Traversal"), Params);
+	});
+
+	It("should keep condition evaluation speed", [this]()
+	{
+		DialogueBenchmark::FParams Params;
+		Params.Branching = 6;
+		Params.ConditionDepth = 4;
+		Params.FormatArgNum = 0;
+		Params.WalkNum = 300;
+		RunAgainstBaseline(TEXT("Conditions"), Params);
+	});
+
+	It("should keep large dialogue speed", [this]()
+	{
+		DialogueBenchmark::FParams Params;
+		Params.DialogueNum = 1;
+		Params.NodeNum = 12000;
+		Params.FormatArgNum = 5;
+		Params.WalkNum = 200;
+		RunAgainstBaseline(TEXT("LargeDialogue"), Params);
+	});
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
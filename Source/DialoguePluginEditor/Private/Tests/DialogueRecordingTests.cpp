@@ -0,0 +1,89 @@
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "DialogueRecording.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDialogueRecordingRoundTripTest, "Dialogue.Recording.RoundTrip", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FDialogueRecordingRoundTripTest::RunTest(const FString& Parameters)
+{
+	FDialogueExecutionRecording Recording;
+	Recording.DialoguePath = TEXT("/Game/Dialogue/DLG_Test.DLG_Test");
+	Recording.EntryPoint = TEXT("Greeting");
+	Recording.EntryNodeId = 4;
+
+	FDialogueRecordedParticipant& Participant = Recording.Participants.AddDefaulted_GetRef();
+	Participant.Name = TEXT("Merchant");
+	Participant.ObjectPath = TEXT("/Game/Maps/Town.Town:PersistentLevel.Merchant_2");
+	Participant.ClassPath = TEXT("/Game/Characters/BP_Merchant.BP_Merchant_C");
+
+	Recording.Choices = { 5, INDEX_NONE };
+	Recording.Conditions.Emplace(5, true);
+	Recording.Conditions.Emplace(6, false);
+	Recording.ChoiceConditionNum = { 2, 2 };
+	Recording.Queries.Emplace(4, EDialogueRecordedQuery::AllChildren);
+	Recording.Queries.Emplace(5, EDialogueRecordedQuery::FirstChild);
+	Recording.ChoiceQueryNum = { 1, 2 };
+	Recording.NodeSequence = { 4, 5 };
+
+	FDialogueRecordedSwitch& Switch = Recording.DialogueSwitches.AddDefaulted_GetRef();
+	Switch.ChoiceIndex = 1;
+	Switch.NodeId = 0;
+	Switch.EntryPoint = TEXT("Shop");
+	Switch.DialoguePath = TEXT("/Game/Dialogue/DLG_Shop.DLG_Shop");
+
+	const FString FilePath = FPaths::AutomationTransientDir() / TEXT("DialogueRecordingRoundTrip.dlgrec");
+	if (!TestTrue(TEXT("Saved"), Recording.SaveToFile(FilePath)))
+	{
+		return false;
+	}
+
+	FDialogueExecutionRecording Loaded;
+	const bool bLoaded = Loaded.LoadFromFile(FilePath);
+	IFileManager::Get().Delete(*FilePath);
+	if (!TestTrue(TEXT("Loaded"), bLoaded))
+	{
+		return false;
+	}
+
+	TestEqual(TEXT("Dialogue path"), Loaded.DialoguePath, Recording.DialoguePath);
+	TestEqual(TEXT("Entry point"), Loaded.EntryPoint, Recording.EntryPoint);
+	TestEqual(TEXT("Entry node"), Loaded.EntryNodeId, Recording.EntryNodeId);
+
+	if (TestEqual(TEXT("Participants"), Loaded.Participants.Num(), 1))
+	{
+		TestEqual(TEXT("Participant name"), Loaded.Participants[0].Name, Participant.Name);
+		TestEqual(TEXT("Participant object"), Loaded.Participants[0].ObjectPath, Participant.ObjectPath);
+		TestEqual(TEXT("Participant class"), Loaded.Participants[0].ClassPath, Participant.ClassPath);
+	}
+
+	TestTrue(TEXT("Choices"), Loaded.Choices == Recording.Choices);
+	TestTrue(TEXT("Choice condition num"), Loaded.ChoiceConditionNum == Recording.ChoiceConditionNum);
+	TestTrue(TEXT("Node sequence"), Loaded.NodeSequence == Recording.NodeSequence);
+	if (TestEqual(TEXT("Conditions"), Loaded.Conditions.Num(), 2))
+	{
+		TestEqual(TEXT("Condition node"), Loaded.Conditions[1].NodeId, 6);
+		TestFalse(TEXT("Condition result"), Loaded.Conditions[1].bResult);
+	}
+
+	TestTrue(TEXT("Choice query num"), Loaded.ChoiceQueryNum == Recording.ChoiceQueryNum);
+	if (TestEqual(TEXT("Queries"), Loaded.Queries.Num(), 2))
+	{
+		TestEqual(TEXT("Query node"), Loaded.Queries[1].NodeId, 5);
+		TestTrue(TEXT("Query type"), Loaded.Queries[1].Type == EDialogueRecordedQuery::FirstChild);
+	}
+
+	if (TestEqual(TEXT("Switches"), Loaded.DialogueSwitches.Num(), 1))
+	{
+		TestEqual(TEXT("Switch entry"), Loaded.DialogueSwitches[0].EntryPoint, Switch.EntryPoint);
+		TestEqual(TEXT("Switch dialogue"), Loaded.DialogueSwitches[0].DialoguePath, Switch.DialoguePath);
+		TestEqual(TEXT("Switch choice"), Loaded.DialogueSwitches[0].ChoiceIndex, Switch.ChoiceIndex);
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dialogue.h"
+#include "UObject/Package.h"
+#include "Commandlets/DialogueBenchmarkCommandlet.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace DialogueTests
+{
+	/**
+	 * Small transient dialogue:
+	 * 0 (Alice) -> 1 (Bob), 2 (Alice)
+	 * 1 -> 3 (Bob)
+	 * Entries: None -> 0, Side -> 2
+	 * Node 2 has condition with FailedChildResult, when set to false node 2 is unavailable from 0
+	 */
+	inline UDialogue* MakeDialogue(bool bSecondChildAvailable = true)
+	{
+		UDialogue* Dialogue = NewObject<UDialogue>(GetTransientPackage(), NAME_None, RF_Transient);
+
+		TMap<int32, FDialogueNode> Nodes;
+		for (int32 NodeId = 0; NodeId < 4; NodeId++)
+		{
+			FDialogueNode& Node = Nodes.Add(NodeId);
+			Node.NodeID = NodeId;
+			Node.Text = FText::AsCultureInvariant(FString::Printf(TEXT("Line %d"), NodeId));
+			Node.Participant = FDialogueParticipant((NodeId % 2) == 0 ? TEXT("Alice") : TEXT("Bob"));
+		}
+		Nodes[0].Children = { 1, 2 };
+		Nodes[1].Children = { 3 };
+
+		UDialogueBenchmarkCondition* Condition = NewObject<UDialogueBenchmarkCondition>(Dialogue);
+		Condition->bResult = bSecondChildAvailable;
+		Nodes[2].Condition = Condition;
+
+		TMap<FName, int32> Entries;
+		Entries.Add(NAME_None, 0);
+		Entries.Add(TEXT("Side"), 2);
+
+		FDialogueEditorStruct(Dialogue).SetNodes(Nodes, Entries);
+		return Dialogue;
+	}
+
+	inline UDialogueBenchmarkParticipant* MakeParticipant(FName Key)
+	{
+		UDialogueBenchmarkParticipant* Participant = NewObject<UDialogueBenchmarkParticipant>(GetTransientPackage(), NAME_None, RF_Transient);
+		Participant->Key = Key;
+		return Participant;
+	}
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS